@@ -0,0 +1,96 @@
+#ifndef ASTROMETRY_H
+#define ASTROMETRY_H
+#include <tuple>
+#include "define.h"
+#include "utils.h"
+
+// Topocentric astrometry context built on the SOFA iauApco13 / iauAtioq split.
+// The slow-varying, star-independent terms (precession-nutation, Earth
+// position and velocity, polar motion) are computed by refresh() and reused
+// until they are older than the refresh interval. Between refreshes, only the
+// Earth rotation angle is updated, propagated from the refresh at its
+// constant rate (exact : ERA is linear in UT1), before the CIRS -> observed
+// rotation, an iauAtioq port (without refraction) whose per-target
+// trigonometry runs in the chosen precision policy (see Precision.h).
+
+// Accuracy tiers of the slow-varying terms, measured against FULL over
+// 2020-2035 (test/test_tiers). Errors come on top of the DUT1 = 0 and
+// no-refraction approximations shared by all tiers. TDB is taken as TT in
+// all tiers (iauDtdb < 2 ms, i.e. < 0.03 arcsec of Earth rotation).
+//
+//   Tier      | Models                                | Max error | Refresh (host)
+//   ----------|---------------------------------------|-----------|---------------
+//   FULL      | IAU 2006/2000A (iauPnm06a), iauEpv00  | reference | ~120 us
+//   TRUNCATED | IAU 2000B (iauPnm00b), iauEpv00       | < 1 mas   | ~50 us
+//   LOW       | IAU 2006 precession only,             | < 10 as   | ~1 us
+//             | Astronomical Almanac Sun for the Earth |           |
+//
+// tierMaxError() returns these bounds with a 50 % margin. FULL can be
+// compiled out with ASTROM_FULL_TIER 0 (drops the IAU 2000A nutation series
+// from the image) ; it then falls back to TRUNCATED.
+enum class AccuracyTier
+{
+    FULL,
+    TRUNCATED,
+    LOW
+};
+
+const char *tierToString(AccuracyTier tier);
+
+// Documented max error of a tier, in degrees
+double tierMaxError(AccuracyTier tier);
+
+// Cheapest tier whose max error fits in budget (degrees)
+AccuracyTier cheapestTier(double budget);
+
+class AstrometryContext
+{
+public:
+    AstrometryContext(double refreshInterval = ASTROM_REFRESH_INTERVAL,
+                      AccuracyTier tier = ASTROM_TIER);
+
+    // Changing the tier forces a refresh
+    void setTier(AccuracyTier newTier);
+    AccuracyTier getTier() const { return tier; }
+
+    void setRefreshInterval(double seconds);
+    double getRefreshInterval() const { return refreshInterval; }
+
+    // True if the slow-varying terms must be recomputed for unixTime
+    bool isStale(double unixTime) const;
+
+    // Full recomputation of the star-independent terms (expensive)
+    bool refresh(double unixTime);
+
+    // Forces a refresh on the next conversion (e.g. after a clock change)
+    void invalidate() { valid = false; }
+
+    // ICRS RA/Dec (degrees) to Az/El (degrees). Refreshes if stale.
+    // Instantiated for DoublePrecision and SinglePrecision.
+    template <class Policy = DoublePrecision>
+    std::tuple<double, double> raDecToAltAz(double ra, double dec, double unixTime = -1.);
+    std::tuple<double, double> raDecToAltAz(double ra, double dec, double unixTime,
+                                            PrecisionMode precision);
+
+private:
+    iauASTROM astrom;
+    AccuracyTier tier;
+    double refreshInterval; // In seconds
+    double lastRefresh;     // Unix time of the last refresh
+    double refreshEra;      // Earth rotation angle at lastRefresh, in radians
+    bool valid;
+
+    // Polar motion rotation terms, constant between refreshes
+    double sxpl, cxpl, sypl, cypl;
+
+    // Cache of the star-dependent ICRS -> CIRS step, valid for one refresh
+    unsigned long generation;
+    unsigned long cachedGeneration;
+    double cachedRa, cachedDec;
+    double cachedRi, cachedDi;
+
+    template <class Policy>
+    void cirsToObserved(double ri, double di, double &az, double &el) const;
+};
+
+#endif
@@ -0,0 +1,77 @@
+#ifndef CLOCK_H
+#define CLOCK_H
+#include <stdint.h>
+#include "Seqlock.h"
+#include "define.h"
+
+// Device time : Unix time (UTC seconds) derived from the monotonic
+// microsecond counter, disciplined to the host by NTP-style exchanges over
+// the serial link. Each exchange gives four timestamps,
+//   t1 host send, t2 device receive, t3 device send, t4 host receive,
+// hence the offset ((t1 - t2) + (t4 - t3)) / 2 of the host clock over the
+// device's and the round-trip delay (t4 - t1) - (t3 - t2). Offsets below
+// CLOCK_STEP_THRESHOLD are slewed in at CLOCK_MAX_SLEW at most, so that
+// time never jumps nor runs backwards, and feed a frequency loop that
+// cancels the oscillator drift between exchanges. Larger ones (first sync)
+// step the clock. Exchanges with a delay well above the recent minimum are
+// rejected : their path asymmetry is unknown.
+class DisciplinedClock
+{
+public:
+    struct Status
+    {
+        bool synced;
+        double offset;      // Last measured offset, in seconds
+        double delay;       // Its round-trip delay, in seconds
+        double uncertainty; // Bound on the time error now, in seconds
+        double frequency;   // Drift correction, in s/s
+        double age;         // Since the last accepted exchange, in seconds
+        uint32_t accepted, rejected;
+    };
+
+    DisciplinedClock();
+
+    // Unix time at the local counter value (microseconds). Any task.
+    double at(int64_t local) const;
+
+    // Steps to unixTime at local, e.g. a one-way sync_time
+    void set(double unixTime, int64_t local);
+
+    // One exchange, applied at local. Returns false if rejected.
+    bool update(double t1, double t2, double t3, double t4, int64_t local);
+
+    Status getStatus(int64_t local) const;
+
+private:
+    // Read by any task, written by the one handling the clock commands
+    struct State
+    {
+        int64_t refLocal;
+        double refTime;   // Unix time at refLocal
+        double frequency; // Rate correction
+        double phase;     // Correction still to slew in from refLocal
+        int64_t lastUpdate;
+        double offset, delay, dispersion; // Last accepted exchange
+        uint32_t accepted, rejected;
+        bool synced;
+    };
+    Seqlock<State> state;
+
+    // Recent round-trip delays, updater only
+    double delays[CLOCK_FILTER_SIZE];
+    uint32_t delayCount;
+
+    static double timeAt(const State &s, int64_t local, double &remaining);
+};
+
+// Monotonic counter since boot, in microseconds
+int64_t clockMicros();
+
+// The device clock, read by getCurrentTime()
+DisciplinedClock &deviceClock();
+
+// Counter value when the command being handled was received, for t2
+void clockMarkReceive();
+int64_t clockLastReceive();
+
+#endif
@@ -0,0 +1,119 @@
+#ifndef COMMAND_H
+#define COMMAND_H
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+// Zero-allocation command parsing : the line is split in place (separators
+// overwritten with '\0'), the command looked up by binary search in a sorted
+// table and its arguments checked and parsed once, against the command's
+// signature, before the handler runs. No Arduino dependency, so that it can be
+// benchmarked on the host.
+
+#ifndef COMMAND_MAX_TOKENS
+#define COMMAND_MAX_TOKENS 66 // Name + arguments, ra2azalt_batch needs 1 + 2 * BATCH_MAX
+#endif
+
+class CommandArgs;
+struct CommandSpec;
+typedef void (*CommandHandler)(const CommandArgs &args);
+
+// Signature characters, one per argument :
+//   'n' number, parsed as a double
+//   's' word
+//   '+' one or more further arguments of the previous type (last)
+//   '*' rest of the line, spaces included (last)
+struct CommandSpec
+{
+    const char *name;      // One or two words, e.g. "ping" or "track radec"
+    const char *signature; // "" for no argument
+    CommandHandler handler;
+    const char *usage; // Printed on argument errors
+};
+
+// Arguments following the command name, valid during the handler call
+class CommandArgs
+{
+public:
+    size_t count() const { return n; }
+    char *word(size_t i) const { return tokens[i]; } // In the line buffer, may be modified
+    double number(size_t i) const { return numbers[i]; } // 'n' arguments only
+    const CommandSpec &command() const { return *spec; }
+
+private:
+    friend class CommandDispatcher;
+    const CommandSpec *spec;
+    char *const *tokens;
+    const double *numbers;
+    size_t n;
+};
+
+enum class DispatchStatus
+{
+    OK,
+    EMPTY,        // Blank line
+    UNKNOWN,      // No such command
+    BAD_ARGUMENTS // Count or type mismatch with the signature
+};
+
+class CommandDispatcher
+{
+public:
+    // table must be sorted by name (see isSorted)
+    template <size_t N>
+    constexpr CommandDispatcher(const CommandSpec (&table)[N]) : table(table), size(N) {}
+
+    // Tokenizes line in place and runs the matching handler. A two-word
+    // command takes precedence over a one-word one ("track radec" over
+    // "track"). spec is set to the matched command, or nullptr.
+    DispatchStatus dispatch(char *line, const CommandSpec *&spec) const;
+
+    // Name order used by the lookup, to be checked at compile time
+    template <size_t N>
+    static constexpr bool isSorted(const CommandSpec (&table)[N])
+    {
+        for (size_t i = 1; i < N; i++)
+        {
+            if (compareNames(table[i - 1].name, table[i].name) >= 0)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    const CommandSpec *table;
+    size_t size;
+
+    static constexpr int compareNames(const char *a, const char *b)
+    {
+        while (*a != '\0' && *a == *b)
+        {
+            a++;
+            b++;
+        }
+        return (unsigned char)*a - (unsigned char)*b;
+    }
+
+    // Binary search for "w0 w1" (or "w0" if w1 is null), without joining
+    const CommandSpec *find(const char *w0, const char *w1) const;
+};
+
+// Splits line in place on spaces, skipping empty tokens. Stops after
+// maxTokens ; the last token then holds the rest of the line.
+size_t tokenize(char *line, char **tokens, size_t maxTokens);
+
+// Optional request ID prefix, "#<id> command ..." with id in 1..2^32-1.
+// On success, line is moved past it and id set, 0 if there is no prefix. Returns false if the prefix is malformed.
+bool parseRequestId(char *&line, uint32_t &id);
+
+// Whole-string numeric parse ("" and trailing characters are rejected)
+inline bool parseNumber(const char *str, double &value)
+{
+    char *end;
+    value = strtod(str, &end);
+    return end != str && *end == '\0';
+}
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef EPHEMERIS_H
+#define EPHEMERIS_H
+#include "define.h"
+
+// Solar system bodies from the SOFA ephemerides : iauEpv00 (Sun),
+// iauMoon98 (Moon, ~10 arcsec) and iauPlan94 (planets, ~1 arcsec for the
+// inner planets, a few arcsec for the outer ones over 1900-2100).
+enum class Body
+{
+    SUN,
+    MOON,
+    MERCURY,
+    VENUS,
+    MARS,
+    JUPITER,
+    SATURN,
+    URANUS,
+    NEPTUNE
+};
+
+const char *bodyToString(Body body);
+bool bodyFromString(const char *name, Body &body);
+
+// Geocentric astrometric position of body (ICRS, light-time corrected, au).
+// Annual aberration and light deflection are left to the astrometry context.
+bool bodyPosition(Body body, double unixTime, double p[3]);
+
+// Cartesian to RA/Dec (degrees) and distance (au)
+void positionToRaDec(const double p[3], double &ra, double &dec, double &distance);
+
+// Elevation (degrees) corrected for the diurnal parallax of a body at
+// distance (au) ; up to ~1 deg for the Moon, 9 arcsec for the Sun.
+double topocentricElevation(double el, double distance);
+
+// Ephemeris evaluated on a coarse grid of EPHEM_INTERVAL seconds and
+// interpolated (quadratic, on three nodes) in between. Moving forward in
+// time costs one ephemeris evaluation per interval.
+class EphemerisCache
+{
+public:
+    EphemerisCache(Body body = Body::SUN, double interval = EPHEM_INTERVAL)
+        : body(body), interval(interval), t0(0), valid(false) {}
+
+    void setBody(Body newBody);
+    Body getBody() const { return body; }
+    void invalidate() { valid = false; }
+
+    // Interpolated geocentric position at unixTime (au)
+    bool position(double unixTime, double p[3]);
+
+    // Interpolated RA/Dec (degrees) and distance (au)
+    bool raDec(double unixTime, double &ra, double &dec, double &distance);
+
+private:
+    Body body;
+    double interval; // Seconds between nodes
+    double t0;       // Time of the first node
+    double nodes[3][3];
+    bool valid;
+};
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef JSONWRITER_H
+#define JSONWRITER_H
+#include <stddef.h>
+#include <stdint.h>
+
+// Strict JSON into a caller-provided buffer, without heap allocation. Numbers
+// are written in fixed point with integer arithmetic (no printf). The last
+// string value may be truncated to fit (see string()) ; any other overflow
+// marks the output invalid.
+class JsonWriter
+{
+public:
+    JsonWriter(char *buffer, size_t size);
+
+    JsonWriter &beginObject();
+    JsonWriter &endObject();
+    JsonWriter &key(const char *name);
+
+    // Escaped string value. With truncate, cut to the space left minus the
+    // closing characters still owed, instead of overflowing.
+    JsonWriter &string(const char *value, bool truncate = false);
+
+    // value rounded to decimals (at most 9) ; NaN and infinities as null
+    JsonWriter &number(double value, unsigned decimals);
+    JsonWriter &integer(int64_t value);
+
+    // Output length, '\0' excluded ; 0 if it overflowed
+    size_t length() const { return overflow ? 0 : used; }
+    bool truncated() const { return cut; }
+    const char *c_str() const { return buffer; }
+
+private:
+    char *buffer;
+    size_t size;
+    size_t used;
+    unsigned depth;  // Open objects, each owing a '}'
+    bool first;      // No member written yet in the current object
+    bool overflow;
+    bool cut;
+
+    void put(char c);
+    void put(const char *str, size_t length);
+    void separator();
+};
+
+// Writes value rounded to decimals into out (at least 32 bytes), returns
+// the length. Values beyond 2^63 / 10^decimals fall back to exponent form.
+size_t formatFixed(char *out, double value, unsigned decimals);
+
+#endif
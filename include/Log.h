@@ -0,0 +1,69 @@
+#ifndef LOG_H
+#define LOG_H
+#include <atomic>
+#include "define.h"
+#include "Message.h"
+#include "Topics.h"
+
+// Leveled logging. Call sites below LOG_LEVEL (define.h) sit behind a
+// constant false condition : the compiler removes them, arguments included,
+// so no text is built at run time. The others are skipped as cheaply when
+// their topic (see Topics.h) has no subscriber. Protocol messages
+// (acknowledgements, positions, timestamps) are not logs.
+#define LOG_DEBUG(msg) LOG_AT_(LOG_LEVEL_DEBUG, print_debug, msg)
+#define LOG_INFO(msg) LOG_AT_(LOG_LEVEL_INFO, print_info, msg)
+#define LOG_WARNING(msg) LOG_AT_(LOG_LEVEL_WARNING, print_warning, msg)
+#define LOG_ERROR(msg) LOG_AT_(LOG_LEVEL_ERROR, print_error, msg)
+
+// Rate-limited variants for call sites that may repeat at loop or timer
+// rate : at most one message per intervalMs from this call site, the
+// repeats in between summarized as "(suppressed N times)" on the next one.
+#define LOG_DEBUG_EVERY(intervalMs, msg) LOG_EVERY_(LOG_LEVEL_DEBUG, print_debug, intervalMs, msg)
+#define LOG_INFO_EVERY(intervalMs, msg) LOG_EVERY_(LOG_LEVEL_INFO, print_info, intervalMs, msg)
+#define LOG_WARNING_EVERY(intervalMs, msg) LOG_EVERY_(LOG_LEVEL_WARNING, print_warning, intervalMs, msg)
+#define LOG_ERROR_EVERY(intervalMs, msg) LOG_EVERY_(LOG_LEVEL_ERROR, print_error, intervalMs, msg)
+
+#define LOG_AT_(level, print, msg)                          \
+    do                                                      \
+    {                                                       \
+        if (LOG_LEVEL <= (level) && isLogSubscribed(level)) \
+        {                                                   \
+            print(msg);                                     \
+        }                                                   \
+    } while (0)
+
+#define LOG_EVERY_(level, print, intervalMs, msg)                     \
+    do                                                                \
+    {                                                                 \
+        if (LOG_LEVEL <= (level) && isLogSubscribed(level))           \
+        {                                                             \
+            static LogRateLimiter logLimiter_(intervalMs);            \
+            uint32_t logSuppressed_;                                  \
+            if (logLimiter_.allow(millis(), logSuppressed_))          \
+            {                                                         \
+                print(withSuppressedCount(msg, logSuppressed_));      \
+            }                                                         \
+        }                                                             \
+    } while (0)
+
+// Per call site limiter, safe to share between tasks (at worst one extra
+// message on a race)
+class LogRateLimiter
+{
+public:
+    explicit LogRateLimiter(uint32_t intervalMs) : interval(intervalMs), next(0), suppressed(0) {}
+
+    // True if a message may go out at now (ms). suppressed is then set to
+    // the number of messages dropped since the last one.
+    bool allow(uint32_t now, uint32_t &suppressedCount);
+
+private:
+    uint32_t interval;
+    std::atomic<uint32_t> next; // Earliest time of the next message, 0 before the first
+    std::atomic<uint32_t> suppressed;
+};
+
+// msg, followed by " (suppressed N times)" if count > 0
+String withSuppressedCount(const String &msg, uint32_t count);
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef LOGRING_H
+#define LOGRING_H
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+
+// Multi-producer, single-consumer ring of variable-length records, lock-free
+// on the producer side : a producer reserves its space with one
+// compare-and-swap on the head, copies its bytes, then publishes the record
+// by writing its header. The consumer takes records in reservation order and
+// copies as many as fit into one output chunk. When full, push() fails at
+// once and the record is counted as dropped : producers never block.
+//
+// Record : 4-byte length header (0 while not yet published), then the
+// payload, padded to 4 bytes so that headers never straddle the wrap.
+class LogRing
+{
+public:
+    // capacity : power of 2, buffer 4-byte aligned and zeroed
+    LogRing(uint8_t *buffer, size_t capacity);
+
+    // Any task. Appends "\r\n" if endLine. Returns false if dropped.
+    bool push(const char *data, size_t length, bool endLine = false);
+
+    // Single consumer. Copies published bytes into out, records possibly
+    // split across calls. Returns the byte count, 0 if nothing is ready.
+    size_t pop(uint8_t *out, size_t size);
+
+    // Single consumer. True unless a record was only partly popped : other
+    // bytes may then be sent without splitting it.
+    bool atRecordStart() const { return readOffset == 0; }
+
+    struct Stats
+    {
+        uint32_t written;      // Records pushed
+        uint32_t dropped;      // Records dropped on overflow
+        uint32_t droppedBytes; // Their payload bytes
+        uint32_t highWater;    // Max bytes in use, headers included
+    };
+    Stats getStats() const;
+
+private:
+    uint8_t *buffer;
+    uint32_t mask;
+
+    std::atomic<uint32_t> head; // Next free byte, free-running
+    std::atomic<uint32_t> tail; // Oldest record not yet consumed
+    uint32_t readOffset;        // Bytes of the tail record already popped
+
+    std::atomic<uint32_t> written, dropped, droppedBytes, highWater;
+
+    void copyIn(uint32_t position, const void *data, size_t length);
+    void copyOut(uint32_t position, void *out, size_t length) const;
+    uint32_t *header(uint32_t position) const;
+};
+
+#endif
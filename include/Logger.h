@@ -0,0 +1,30 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+#include "LogRing.h"
+#include "Transport.h"
+
+// Asynchronous output : every message goes into a lock-free ring (see
+// LogRing.h) and a single low-priority task writes it to the transport,
+// coalescing small messages into one write. Callers never wait on the UART
+// and messages from different tasks never interleave.
+
+// Creates the TX task. Messages logged before are kept and sent then.
+void startLogger(SerialTransport &transport);
+
+// Queues one line ("\r\n" appended). Returns false if dropped (ring full).
+bool logLine(const char *data, size_t length);
+
+// Queues raw bytes, e.g. a binary frame. Returns false if dropped.
+bool logWrite(const uint8_t *data, size_t length);
+
+// Message composed by the TX task just before its write, e.g. to carry its
+// transmission time : fills up to size bytes of out, returns the length.
+typedef size_t (*LogComposer)(uint8_t *out, size_t size);
+
+// Sends the composed message between two records, ahead of those still
+// queued. One at a time : returns false if one is already pending.
+bool logComposed(LogComposer compose);
+
+LogRing::Stats getLogStats();
+
+#endif
@@ -1,8 +1,5 @@
 #ifndef MESSAGE_H
 #define MESSAGE_H
-#include <sstream>
-#include <iomanip>
-#include <string>
 #include "Error.h"
 #include "define.h"
 #include "utils.h"
@@ -12,45 +9,90 @@ enum class MsgType
     POSITION,
     GENERIC,
     ACKNOWLEDGEMENT,
-    TIMESTAMP
+    TIMESTAMP,
+    EVENT // Completion of a long-running command
 };
 
+#define REQUEST_ID_NONE 0
+
+// Request ID of the command being handled by the calling task (see
+// parseRequestId), echoed in its acknowledgements ; REQUEST_ID_NONE between
+// commands. Per task.
+void setRequestId(uint32_t id);
+uint32_t getRequestId();
+
+// One output line : strict JSON, e.g.
+// {"type":"POSITION","status":"success","timestamp":1700000000.123456,"payload":{"azimuth":45.00,"elevation":45.00}}
+// The timestamp is the Unix time of the event, captured by the caller.
+// Replies to a command sent with a request ID carry it : "id":42 after the
+// type.
 class Message
 {
 private:
     MsgType type;
-    String payload;
-    String status;
+    ErrorType status;
+    double timestamp;
+    const char *text; // Text payload, not owned ; nullptr for a position or time payload
+    float az, elev;
+    uint32_t requestId;
 
 public:
-    Message(MsgType _type, String _payload, String _status)
-        : type(_type), payload(_payload), status(_status) {}
+    Message(MsgType _type, ErrorType _status, const char *_text, double _timestamp, uint32_t _requestId = REQUEST_ID_NONE)
+        : type(_type), status(_status), timestamp(_timestamp), text(_text), az(0), elev(0), requestId(_requestId) {}
+
+    // Position payload
+    Message(float _az, float _elev, ErrorType _status, double _timestamp)
+        : type(MsgType::POSITION), status(_status), timestamp(_timestamp), text(nullptr), az(_az), elev(_elev),
+          requestId(REQUEST_ID_NONE) {}
+
+    const char *typeToString() const;
 
-    String typeToString() const;
+    // Writes the line into buffer, a text payload being truncated to fit.
+    // Returns its length, '\0' excluded.
+    size_t format(char *buffer, size_t size) const;
 
-    String format() const;
+    // Binary frame payload (see Protocol.h), text truncated to fit.
+    // Returns its length.
+    size_t encode(uint8_t *buffer, size_t size) const;
 };
 
 // Utility to convert ErrorType to string
-String errorTypeToString(ErrorType type);
+const char *errorTypeToString(ErrorType type);
 
 // print functions
 void print_msg(const ErrorStatus &err, const MsgType &type = MsgType::GENERIC);
 
+void print_debug(const String &debug, const MsgType &type = MsgType::GENERIC);
+
 void print_info(const String &info, const MsgType &type = MsgType::GENERIC);
 
 void print_acknowledgement(const String &msg, const ErrorType &status = ErrorType::NONE);
 
 void print_acknowledgement_error(const String &msg);
 
+// Acknowledgement completed by the logger task as it is sent : text followed
+// by the device time of transmission, also passed to stamped (from that
+// task). For time exchanges (clock sync). Returns false if the previous one
+// is not sent yet.
+bool print_acknowledgement_stamped(const char *text, void (*stamped)(double time));
+
+// Completion of a long-running command, e.g. "completed" or "failed :
+// preempted", whatever the topics. timestamp : time of the event.
+void print_event(const char *event, uint32_t requestId, const ErrorType &status = ErrorType::NONE,
+                 double timestamp = getCurrentTime());
+
 void print_warning(const String &warning, const MsgType &type = MsgType::GENERIC);
 
 void print_error(const String &error, const MsgType &type = MsgType::GENERIC);
 
-void print_position(float az, float elev, const ErrorStatus &err = ErrorStatus());
+// timestamp : time of the position reading
+void print_position(float az, float elev, const ErrorStatus &err = ErrorStatus(), double timestamp = getCurrentTime());
 
 void print_msg_filtered(const ErrorStatus &err, const MsgType &type = MsgType::GENERIC);
 
-void print_timestamp(String timestamp = getCurrentTimestamp());
+void print_timestamp(double timestamp = getCurrentTime());
+
+// Timing topic statistics, sent whatever the log topics
+void print_timing(const String &stats);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,140 @@
+#ifndef PRECISION_H
+#define PRECISION_H
+#include <math.h>
+
+// Precision policies for the per-target trigonometry of the coordinate
+// transforms. Time, ERA and sidereal time always stay in double ; only the
+// target-dependent part runs in Policy::real. Angles are reduced in double
+// before being narrowed, so float only ever sees arguments in [-pi, pi].
+//
+// The ESP32 FPU is single precision only : every double sin/cos/atan2 is
+// emulated in software.
+//
+// Max error of SinglePrecision against DoublePrecision over the mount range
+// (see test/test_precision) :
+//
+//   Transform                             | az / ra error | el / dec error
+//   --------------------------------------|---------------|---------------
+//   hourAngleToAltAz                      | 0.4 arcsec    | 0.04 arcsec
+//   galacticToEquatorial                  | 0.06 arcsec   | 0.05 arcsec
+//   AstrometryContext (CIRS -> observed)  | 0.6 arcsec    | 0.04 arcsec
+//
+// All far below MOTION_MIN (360 arcsec). In double, AstrometryContext stays
+// within 2 mas of iauAtco13 over its refresh interval. Costs are printed by
+// the same test ; on the host both policies run in hardware, on the ESP32
+// only float does.
+struct DoublePrecision
+{
+    typedef double real;
+    static inline real sin(real x) { return ::sin(x); }
+    static inline real cos(real x) { return ::cos(x); }
+    static inline real atan2(real y, real x) { return ::atan2(y, x); }
+    static inline real sqrt(real x) { return ::sqrt(x); }
+};
+
+struct SinglePrecision
+{
+    typedef float real;
+    static inline real sin(real x) { return ::sinf(x); }
+    static inline real cos(real x) { return ::cosf(x); }
+    static inline real atan2(real y, real x) { return ::atan2f(y, x); }
+    static inline real sqrt(real x) { return ::sqrtf(x); }
+};
+
+// Runtime selector, e.g. per tracking mode
+enum class PrecisionMode
+{
+    DOUBLE,
+    SINGLE
+};
+
+// Reduce an angle in radians to [-pi, pi], in double. floor rather than
+// remainder or fmod, which are library calls : batch loops vectorize.
+inline double reduceAngle(double a)
+{
+    return a - 2 * M_PI * floor(a / (2 * M_PI) + 0.5);
+}
+
+// Wrap an angle in radians to [0, 2pi), in double, branch-free as above
+inline double wrapAngle(double a)
+{
+    return a - 2 * M_PI * floor(a / (2 * M_PI));
+}
+
+// Cosine of an angle in radians, as the sine of its complement taken in
+// double. The compiler merges sin and cos of one argument into sincos,
+// which has no vector version : batch loops calling both would not
+// vectorize.
+template <class Policy>
+inline typename Policy::real cosAsSine(double a)
+{
+    return Policy::sin((typename Policy::real)(M_PI_2 - a));
+}
+
+// Hour angle and declination (radians) to Az/El (radians, az in [0, 2pi))
+// for an observer at latitude phi given as (sin phi, cos phi).
+// Taken from SOFA hd2ae.c ; branch-free so that batch loops vectorize.
+template <class Policy>
+inline void hourAngleToAltAz(double hourAngle, double dec, double sp, double cp,
+                             double &az, double &alt)
+{
+    typedef typename Policy::real real;
+    const double ha = reduceAngle(hourAngle);
+    const real sphi = (real)sp;
+    const real cphi = (real)cp;
+
+    /* Useful trig functions. */
+    real sh = Policy::sin((real)ha);
+    real ch = cosAsSine<Policy>(ha);
+    real sd = Policy::sin((real)dec);
+    real cd = cosAsSine<Policy>(dec);
+
+    /* Az,Alt unit vector. */
+    real x = -ch * cd * sphi + sd * cphi;
+    real y = -sh * cd;
+    real z = ch * cd * cphi + sd * sphi;
+
+    /* To spherical. */
+    real r = Policy::sqrt(x * x + y * y);
+    real a = Policy::atan2(y, x);
+    az = wrapAngle(r != (real)0 ? a : (real)0); // A select, not a branch
+    alt = Policy::atan2(z, r);
+}
+
+// Derivative of hourAngleToAltAz with respect to the hour angle, written in
+// terms of its result : d(az)/dh and d(alt)/dh at (az, alt) (radians), for
+// an observer at latitude phi given as (sin phi, cos phi). Multiplied by the
+// sidereal rate, these are the Az/El rates of a target fixed on the sky.
+// d(az)/dh grows as tan(alt) towards the zenith.
+inline void altAzHourAngleRates(double az, double alt, double sp, double cp,
+                                double &azRate, double &altRate)
+{
+    azRate = sp - cp * cos(az) * tan(alt);
+    altRate = cp * sin(az);
+}
+
+// Galactic (l, b) to equatorial (ra, dec), all in radians. The pole terms
+// are passed precomputed : sin/cos of the NGP declination, NGP RA and the
+// galactic longitude of the north celestial pole.
+template <class Policy>
+inline void galacticToEquatorial(double l, double b, double sinNgpDec, double cosNgpDec,
+                                 double ngpRa, double northLon, double &ra, double &dec)
+{
+    typedef typename Policy::real real;
+    const double dl = reduceAngle(l - northLon);
+    const real sdp = (real)sinNgpDec;
+    const real cdp = (real)cosNgpDec;
+
+    real sb = Policy::sin((real)b);
+    real cb = cosAsSine<Policy>(b);
+    real cdl = cosAsSine<Policy>(dl);
+
+    real y = cb * Policy::sin((real)dl);
+    real x = cb * cdl * sdp - sb * cdp;
+
+    // atan2 rather than asin : keeps float accurate near the poles
+    ra = wrapAngle((double)Policy::atan2(y, x) + ngpRa);
+    dec = Policy::atan2(sb * sdp + cb * cdp * cdl, Policy::sqrt(x * x + y * y));
+}
+
+#endif
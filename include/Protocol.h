@@ -0,0 +1,63 @@
+#ifndef PROTOCOL_H
+#define PROTOCOL_H
+#include <stddef.h>
+#include <stdint.h>
+
+// Link protocol, switched at run time by the proto command. TEXT : one JSON
+// message per line, commands as text lines (the default, for existing
+// clients). BINARY : COBS frames in both directions.
+//
+// Frame : COBS(payload | CRC-16/CCITT-FALSE of payload, little-endian) 0x00
+// Device -> host payload, little-endian (see Message::encode) :
+//   u8  type (MsgType, low nibble) | status (ErrorType, bits 4-5)
+//       | FRAME_FLAG_REQUEST_ID
+//   f64 timestamp (Unix time of the event)
+//   u32 request ID, only with FRAME_FLAG_REQUEST_ID
+//   POSITION : f32 azimuth, f32 elevation (degrees) ; else UTF-8 text,
+//   without terminator ; TIMESTAMP : nothing more
+// Host -> device payload :
+//   u8  FRAME_COMMAND, then a command line as in text mode
+#define PROTOCOL_VERSION 2
+
+enum class ProtocolMode
+{
+    TEXT,
+    BINARY
+};
+
+#define FRAME_COMMAND 0x10         // Host -> device frame type
+#define FRAME_FLAG_REQUEST_ID 0x80 // Device -> host : a request ID follows the timestamp
+
+ProtocolMode getProtocolMode();
+void setProtocolMode(ProtocolMode mode);
+const char *protocolModeToString(ProtocolMode mode);
+bool protocolModeFromString(const char *name, ProtocolMode &mode);
+
+#define FRAME_CRC_SIZE 2
+
+// Room kept before a payload of up to maxLength bytes, so that it can be
+// framed in place (see encodeFrame)
+constexpr size_t frameHeadroom(size_t maxLength)
+{
+    return 2 + (maxLength + FRAME_CRC_SIZE) / 254;
+}
+
+// Bytes needed around a payload of up to maxLength bytes : headroom, CRC,
+// delimiter
+constexpr size_t frameOverhead(size_t maxLength)
+{
+    return frameHeadroom(maxLength) + FRAME_CRC_SIZE + 1;
+}
+
+uint16_t crc16(const uint8_t *data, size_t length, uint16_t crc = 0xffff);
+
+// Frames the length-byte payload at buffer + frameHeadroom(maxLength), in
+// place : the frame, delimiter included, starts at buffer[0]. buffer must
+// hold frameOverhead(maxLength) + maxLength bytes. Returns the frame length.
+size_t encodeFrame(uint8_t *buffer, size_t length, size_t maxLength);
+
+// Decodes a received frame (delimiter excluded) in place and checks its
+// CRC. Returns the payload length, or -1 if the frame is corrupt.
+int decodeFrame(uint8_t *frame, size_t length);
+
+#endif
@@ -0,0 +1,108 @@
+#ifndef SATELLITE_H
+#define SATELLITE_H
+#include <stdint.h>
+#include <tuple>
+#include "define.h"
+
+// Two-line element set, fixed size. Angles in radians, mean motion in
+// radians per minute (Kozai convention, as given in the TLE).
+struct TLE
+{
+    char name[TLE_NAME_LENGTH + 1];
+    uint32_t satnum;
+    double epoch; // Unix time (UTC)
+    double bstar; // Drag term, in 1 / Earth radii
+    double inclo, nodeo, ecco, argpo, mo;
+    double no_kozai;
+};
+
+// Parses the two element lines (checksums included) of a TLE, name optional.
+// Returns false on malformed lines or mismatched satellite numbers.
+bool parseTLE(const char *line1, const char *line2, TLE &tle, const char *name = nullptr);
+
+// SGP4 propagator (Vallado et al. 2006 revision, WGS-72 constants).
+// Everything depending only on the element set is derived once by init() ;
+// propagate() is then a fixed sequence of a few dozen trigonometric calls.
+// Deep-space orbits (period >= 225 min : GNSS, Molniya, geostationary) add
+// the SDP4 lunar-solar terms, and for 12 h and 24 h orbits the geopotential
+// resonance, integrated from the epoch in 720 min steps on every call.
+class Sgp4
+{
+public:
+    enum Status
+    {
+        OK = 0,
+        ECCENTRICITY = 1,           // Mean eccentricity out of [0, 1)
+        MEAN_MOTION = 2,            // Negative mean motion
+        PERTURBED_ECCENTRICITY = 3, // Deep space : out of [0, 1] with the lunar-solar terms
+        SEMI_LATUS = 4,             // Negative semi-latus rectum
+        DECAYED = 6,                // Orbit has decayed below the Earth's surface
+        NOT_INITIALIZED = 8
+    };
+
+    Sgp4() : status(NOT_INITIALIZED), deepSpace(false) {}
+
+    // Derives the orbital constants of tle. Returns false (see getStatus())
+    // for invalid element sets.
+    bool init(const TLE &tle);
+
+    // TEME position (km) and velocity (km/s) tsince minutes after the epoch
+    Status propagate(double tsince, double r[3], double v[3]) const;
+
+    // Same at a Unix time
+    Status propagateAt(double unixTime, double r[3], double v[3]) const;
+
+    bool isValid() const { return status == OK; }
+    bool isDeepSpace() const { return deepSpace; }
+    Status getStatus() const { return status; }
+    const TLE &getTLE() const { return elements; }
+
+private:
+    TLE elements;
+    Status status;
+
+    // Derived at init
+    bool isimp;
+    double no_unkozai, con41, x1mth2, x7thm1;
+    double cc1, cc4, cc5, d2, d3, d4;
+    double delmo, eta, sinmao, omgcof, xmcof, xlcof, aycof, nodecf;
+    double t2cof, t3cof, t4cof, t5cof;
+    double mdot, argpdot, nodedot;
+
+    // Deep space (dscom / dsinit), derived at init
+    bool deepSpace;
+    struct DeepSpace
+    {
+        // Lunar-solar periodics (dpper)
+        double e3, ee2, se2, se3, sgh2, sgh3, sgh4, sh2, sh3, si2, si3, sl2, sl3, sl4;
+        double xgh2, xgh3, xgh4, xh2, xh3, xi2, xi3, xl2, xl3, xl4;
+        double zmol, zmos;
+
+        // Lunar-solar secular rates (dspace)
+        double dedt, didt, dmdt, dnodt, domdt;
+
+        // Resonance : 0 none, 1 synchronous (24 h), 2 half-day (12 h)
+        int irez;
+        double gsto, xfact, xlamo;
+        double del1, del2, del3;
+        double d2201, d2211, d3210, d3222, d4410, d4422, d5220, d5232, d5421, d5433;
+    } deep;
+
+    void initDeepSpace(double eccsq, double xpidot);
+    void deepSecular(double t, double &em, double &argpm, double &inclm, double &mm, double &nodem,
+                     double &nm) const;
+    void deepPeriodics(double t, double &ep, double &inclp, double &nodep, double &argpp, double &mp) const;
+};
+
+const char *sgp4StatusToString(Sgp4::Status status);
+
+// TEME position (km) at unixTime to topocentric Az/El (degrees) at the
+// observatory. Polar motion is neglected (< 0.3 arcsec seen from the ground).
+std::tuple<double, double> temeToAltAz(const double r[3], double unixTime);
+
+// Same, with the Az/El rates (degrees per second) from the TEME velocity v
+// (km/s) ; v may be null.
+void temeToAltAz(const double r[3], const double v[3], double unixTime,
+                 double &az, double &el, double &azRate, double &elRate);
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+#include <stdint.h>
+#include <atomic>
+#include <type_traits>
+
+// Snapshot of a small struct shared between tasks : readers never block nor
+// see a torn value, the writer never waits on readers. Two copies under a
+// sequence counter : the writer updates one copy while readers take the
+// other, and a reader retries only if the counter moved during its copy.
+// A reader preempting the writer (e.g. a higher priority task) therefore
+// still finds a complete copy and does not spin.
+//
+// Single writer : concurrent writers must be serialized by the caller.
+template <class T>
+class Seqlock
+{
+    static_assert(std::is_trivially_copyable<T>::value, "Seqlock needs a plain struct");
+
+public:
+    Seqlock() : sequence(0), copies() {}
+    explicit Seqlock(const T &value) : sequence(0), copies{value, value} {}
+
+    // Any task
+    T load() const
+    {
+        T copy;
+        uint32_t before;
+        do
+        {
+            before = sequence.load(std::memory_order_acquire);
+            copy = copies[before & 1];
+            std::atomic_thread_fence(std::memory_order_acquire);
+        } while (sequence.load(std::memory_order_relaxed) != before);
+        return copy;
+    }
+
+    void store(const T &value)
+    {
+        uint32_t s = sequence.load(std::memory_order_relaxed);
+        sequence.store(s + 1, std::memory_order_relaxed); // Readers on copies[1]
+        std::atomic_thread_fence(std::memory_order_release);
+        copies[0] = value;
+        sequence.store(s + 2, std::memory_order_release); // Readers on copies[0]
+        std::atomic_thread_fence(std::memory_order_release);
+        copies[1] = value;
+    }
+
+private:
+    std::atomic<uint32_t> sequence;
+    T copies[2];
+};
+
+#endif
@@ -4,7 +4,9 @@
 class Tasker
 {
 public:
-    virtual void task() = 0;
+    // Run by the motion executor ; must return once motionPreempted().
+    // Returns false if the motion could not run, reported as failed.
+    virtual bool task() = 0;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,57 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+#include <stdint.h>
+#include <atomic>
+#include "Error.h"
+
+// Sampling rate of a periodic producer, set from another task
+class StreamRate
+{
+public:
+    // defaultPeriodMs : period at rate 0
+    explicit StreamRate(uint32_t defaultPeriodMs) : rate(0), defaultPeriod(defaultPeriodMs) {}
+
+    // rateHz in ]0, STREAM_MAX_RATE], 0 for the default period. Returns
+    // false if out of range.
+    bool setRate(float rateHz);
+    float getRate() const;
+    uint32_t getPeriodMs() const;
+
+private:
+    std::atomic<float> rate;
+    uint32_t defaultPeriod;
+};
+
+// Position telemetry stream, configured at run time by the stream command.
+// The broadcast task samples the position at the stream rate and sends a
+// sample only if it moved by more than the deadband on either axis, or if
+// its status changed, or if nothing was sent for POSITION_BROADCAST_DELAY
+// (keepalive). A stationary mount thus costs one sample per keepalive
+// whatever the rate. At rate 0, one sample per keepalive.
+class PositionStream : public StreamRate
+{
+public:
+    PositionStream();
+
+    // deadbandDeg >= 0, 0 sends every sample. Returns false if negative.
+    bool setDeadband(float deadbandDeg);
+    float getDeadband() const;
+
+    // Broadcast task only. True if the sample read at now (ms) must be sent.
+    bool accept(float az, float el, ErrorType status, uint32_t now);
+
+    uint32_t getSent() const { return sent.load(std::memory_order_relaxed); }
+    uint32_t getSuppressed() const { return suppressed.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<float> deadband;
+    std::atomic<uint32_t> sent, suppressed;
+
+    // Last sample sent
+    bool started;
+    float lastAz, lastEl;
+    ErrorType lastStatus;
+    uint32_t lastTime;
+};
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef TOPICS_H
+#define TOPICS_H
+#include <stdint.h>
+
+// Output topics, subscribed to by the client. Acknowledgements answer
+// commands and always go out ; all other output belongs to a topic :
+//   position : stream samples, at the stream rate (see Telemetry.h)
+//   tracking : motion and tracking state changes (info logs)
+//   errors   : warnings and errors
+//   debug    : debug logs, if built with LOG_LEVEL_DEBUG
+//   timing   : device time and output statistics, at the timing rate
+// Each topic has a verbosity, the lowest log level (LOG_LEVEL_*) it lets
+// through. Messages of unsubscribed topics are not even formatted, and
+// periodic producers sleep while nobody listens (woken by the subscribe
+// command).
+enum class Topic
+{
+    POSITION,
+    TRACKING,
+    ERRORS,
+    DEBUG,
+    TIMING,
+    COUNT
+};
+
+const char *topicToString(Topic topic);
+bool topicFromString(const char *name, Topic &topic);
+
+const char *logLevelToString(int level);
+bool logLevelFromString(const char *name, int &level);
+
+bool isSubscribed(Topic topic);
+int getTopicLevel(Topic topic);
+
+void subscribe(Topic topic);
+void unsubscribe(Topic topic);
+void setTopicLevel(Topic topic, int level);
+
+// Topic of a log message of the given level
+Topic logTopic(int level);
+
+// True if a log message of the given level would go out
+bool isLogSubscribed(int level);
+
+#endif
@@ -5,13 +5,23 @@
 #include "Message.h"
 #include "define.h"
 #include "motionTasks.h"
+#include "Astrometry.h"
+#include "Trajectory.h"
+#include "Satellite.h"
+#include "Ephemeris.h"
+#include "Seqlock.h"
+#include <atomic>
 
 enum TrackingMode
 {
     IDLE,
     TRACK_SATELLITE,
     TRACK_GALACTIC,
-    TRACK_EQUATORIAL
+    TRACK_EQUATORIAL,
+    TRACK_SUN,
+    TRACK_MOON,
+    TRACK_PLANET,
+    TRACK_TABLE // Trajectory uploaded by the host (see TrajectoryTable)
 };
 
 class Tracker : public Tasker
@@ -21,25 +31,79 @@ public:
 
     void start(TrackingMode mode);
     void stop();
-    virtual void task();
+    virtual bool task();
     bool setTrackingMode(TrackingMode mode);
 
     // Public methods for setting targets
-    void setTLE(const String &newTLE);         // Set TLE for satellite tracking
+    Sgp4::Status setTLE(const TLE &newTLE);    // Set TLE for satellite tracking
     void setEquatorial(double ra, double dec); // Set equatorial coords
     void setGalactic(double l, double b);      // Set galactic coords
+    void setPlanet(Body body);                 // Set body for TRACK_PLANET
+
+    // Uploaded trajectory for TRACK_TABLE, appended while tracking it too.
+    // The track fails once past the end.
+    TableStatus addTablePoints(const TrackPoint *points, size_t count);
+    TableStatus addTableSegment(const ChebyshevSegment &segment);
+    void clearTable();
+    TrajectoryTable::Info getTableInfo();
+
+    // Precision policy of the per-target trigonometry, per tracking mode
+    bool setPrecision(TrackingMode mode, PrecisionMode precision);
 
     void updateTargetCoordinates();
 
+    // Target position and rates extrapolated to time. False until the
+    // first valid update, when the target is older than
+    // TRACK_STALE_INTERVAL or out of range. Never blocks : safe from the
+    // tracking loop and timer callbacks.
+    bool getSetpoint(double time, MotionSetpoint &setpoint);
+
+    // Accuracy tier of the astrometry terms, either fixed or the cheapest one
+    // meeting a pointing budget in degrees
+    void setAccuracyTier(AccuracyTier tier);
+    AccuracyTier setPointingBudget(double budget);
+
+    // Forces the astrometry terms and trajectory to be recomputed,
+    // e.g. after a leap second table update
+    void invalidateAstrometry();
+
+    // Max deviation of the current trajectory segment, in degrees, NAN if
+    // none. To be compared to MOTION_MIN.
+    double getTrajectoryError();
+
 private:
     SemaphoreHandle_t positionMutex;
     TimerHandle_t trackingTimer;
-    double targetAz, targetEl;
 
-    TrackingMode currentMode;
+    // Last computed target
+    struct Target
+    {
+        double az, el;
+        double azRate, elRate; // Degrees per second
+        double time;           // Unix time of the target, 0 if none
+    };
+    Seqlock<Target> target; // Written under positionMutex, read without
+    AstrometryContext astrometry;
+    PrecisionMode precisionEquatorial, precisionGalactic;
+    // Segments are fitted by the tracker task, outside of the lock, and
+    // only evaluated by the timer callback : the current one, and the next
+    // one fitted TRAJ_FIT_LEAD ahead, swapped in when the current expires.
+    ChebyshevSegment trajectory, nextTrajectory;
+    uint32_t trajectoryGeneration; // Bumped on every target change
+    // Solar system ephemeris grid, sampled by the fits : tracker task only,
+    // no lock. Recomputed when the generation it was built for is stale.
+    EphemerisCache ephemeris;
+    uint32_t ephemerisGeneration;
+    Body planet;
+    TrajectoryTable table;
+
+    // Written by the receive task (retarget) and the tracker task (start,
+    // exit), read by the timer callback
+    std::atomic<TrackingMode> currentMode;
+    std::atomic<TrackingMode> requestedMode; // Of the last start()
     bool target_change_flag;
     double ra, dec, l, b;
-    String tle;
+    Sgp4 satellite;
 
     // Constructors (singleton)
     Tracker();                                    // Private constructor
@@ -47,17 +111,41 @@ private:
     Tracker &operator=(const Tracker &) = delete; // Delete assignment operator
 
     // Method to update target coordinates based on current mode
-    void updateFromTLE(double &az, double &el);
+    bool updateFromTLE(double &az, double &el, double &azRate, double &elRate);
     void updateFromGalactic(double &az, double &el);
+    bool updateFromTrajectory(double &az, double &el);
+    bool updateFromTable(double &az, double &el, double &azRate, double &elRate);
+    bool tableEnded(double time);
+
+    // What a segment is fitted from, copied under the lock
+    struct FitTarget
+    {
+        TrackingMode mode;
+        double ra, dec; // Degrees, galactic targets converted
+        PrecisionMode precision;
+        Body body;
+    };
+
+    // Fits the current or next segment if due. Tracker task only.
+    void prepareTrajectory();
+    bool fitTrajectory(const FitTarget &fitTarget, uint32_t generation, AstrometryContext context, double start,
+                       ChebyshevSegment &segment);
+
+    // Drops both segments. Called with positionMutex held.
+    void invalidateTrajectory();
+
+    // Recomputes the slow astrometry terms outside of the timer callback
+    void refreshAstrometry();
 
     // Method to check if position is valid
     bool isValidPosition(double az, double el);
 
-    // Method to check if movement is needed
-    bool needsMovement(double az, double el);
+    // True if the mount, at its last setpoint, is too far from the target
+    // to catch up through the setpoint stream
+    bool needsSlew(MotionSetpoint const &mount, MotionSetpoint const &target);
 
     // Timer to periodically update coordinates
-    void setupTrackingTimer();
+    bool setupTrackingTimer();
     void stopTrackingTimer();
 };
 
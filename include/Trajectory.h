@@ -0,0 +1,209 @@
+#ifndef TRAJECTORY_H
+#define TRAJECTORY_H
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "define.h"
+
+// Chebyshev approximation of a target's Az/El track over a short window.
+// Fitting samples the full transform chain on TRAJ_ORDER + 1 Chebyshev
+// nodes ; evaluating costs a handful of multiply-adds. The fit is checked
+// against the true track between the nodes, and the worst deviation is kept
+// in maxError so callers can compare it to MOTION_MIN.
+class ChebyshevSegment
+{
+public:
+    ChebyshevSegment() : t0(0), t1(0), order(0), maxError(0), valid(false) {}
+
+    // Fits the track given by sample(t, az, el) (degrees) over
+    // [start, start + duration]. Returns false if a sample is invalid.
+    template <class Sampler>
+    bool fit(double start, double duration, int order, Sampler sample);
+
+    // Same, halving the duration up to maxRefits - 1 times until maxError
+    // (degrees) is met, where the track bends fast (close to the zenith).
+    // The last fit is kept even if above maxError.
+    template <class Sampler>
+    bool fitWithin(double start, double duration, int order, double maxError, int maxRefits, Sampler sample);
+
+    // Sets the segment from coefficients computed elsewhere, e.g. uploaded
+    // by the host. Returns false if out of range.
+    bool set(double start, double end, int order, const double *az, const double *el);
+
+    // Az (in [0, 360)) and El at t, in degrees
+    void evaluate(double t, double &az, double &el) const;
+
+    // Az and El rates at t, in degrees per second, from the derivative series
+    void evaluateRates(double t, double &azRate, double &elRate) const;
+
+    bool contains(double t) const { return valid && t >= t0 && t <= t1; }
+    void invalidate() { valid = false; }
+    bool isValid() const { return valid; }
+
+    double getStart() const { return t0; }
+    double getEnd() const { return t1; }
+    double getMaxError() const { return maxError; } // Degrees
+
+private:
+    double t0, t1;
+    int order;
+    double azCoeffs[TRAJ_MAX_ORDER + 1];
+    double elCoeffs[TRAJ_MAX_ORDER + 1];
+    double maxError;
+    bool valid;
+
+    // Clenshaw evaluation of the series at x in [-1, 1]
+    static double clenshaw(const double *coeffs, int order, double x);
+};
+
+// Time-tagged position of an uploaded trajectory
+struct TrackPoint
+{
+    double time;  // Unix time
+    float az, el; // Degrees
+};
+
+enum class TableStatus
+{
+    OK,
+    FULL,         // Not enough room left : nothing added
+    NOT_IN_ORDER, // Times must increase, after the last entry
+    WRONG_KIND,   // Points and segments do not mix, clear first
+    INVALID       // Non-finite value or empty segment
+};
+
+const char *tableStatusToString(TableStatus status);
+
+// Trajectory uploaded by the host for targets the firmware cannot compute
+// (spacecraft, comets, JPL ephemerides) : az/el points or Chebyshev
+// segments, in time order, in a preallocated ring. The host appends ahead
+// of time ; the tracker samples it at the current time, which drops what is
+// behind. Points are interpolated by cubic Hermite splines, the slopes
+// taken from the neighbouring points, so that position and rate are
+// continuous. Not thread-safe : the tracker guards it with its mutex.
+class TrajectoryTable
+{
+public:
+    enum Kind
+    {
+        EMPTY,
+        POINTS,
+        SEGMENTS
+    };
+
+    struct Info
+    {
+        Kind kind;
+        size_t count, capacity;
+        double start, end; // Time span covered, 0 if empty
+    };
+
+    TrajectoryTable() : kind(EMPTY), head(0), tail(0) {}
+
+    void clear();
+
+    // All or nothing : every point is appended, or none
+    TableStatus addPoints(const TrackPoint *points, size_t count);
+    TableStatus addSegment(const ChebyshevSegment &segment);
+
+    // Position (az in [0, 360)) and rates at t, in degrees and degrees per
+    // second. False if t is not covered.
+    bool sample(double t, double &az, double &el, double &azRate, double &elRate);
+
+    Info getInfo() const;
+
+private:
+    Kind kind;
+    uint32_t head, tail; // Free-running indices
+    TrackPoint points[TRAJ_TABLE_POINTS];
+    ChebyshevSegment segments[TRAJ_TABLE_SEGMENTS];
+
+    const TrackPoint &point(uint32_t i) const { return points[i & (TRAJ_TABLE_POINTS - 1)]; }
+    const ChebyshevSegment &segment(uint32_t i) const { return segments[i & (TRAJ_TABLE_SEGMENTS - 1)]; }
+    size_t capacity() const { return kind == SEGMENTS ? TRAJ_TABLE_SEGMENTS : TRAJ_TABLE_POINTS; }
+
+    bool samplePoints(double t, double &az, double &el, double &azRate, double &elRate);
+    bool sampleSegments(double t, double &az, double &el, double &azRate, double &elRate);
+};
+
+template <class Sampler>
+bool ChebyshevSegment::fit(double start, double duration, int n, Sampler sample)
+{
+    valid = false;
+    if (n < 1 || n > TRAJ_MAX_ORDER || duration <= 0)
+    {
+        return false;
+    }
+
+    const int nodes = n + 1;
+    const double mid = start + duration / 2;
+    const double half = duration / 2;
+    double az[TRAJ_MAX_ORDER + 1], el[TRAJ_MAX_ORDER + 1];
+
+    // Samples on the Chebyshev nodes, azimuth unwrapped across 0/360
+    for (int k = 0; k < nodes; k++)
+    {
+        double x = cos(M_PI * (k + 0.5) / nodes);
+        sample(mid + half * x, az[k], el[k]);
+        if (isnan(az[k]) || isnan(el[k]))
+        {
+            return false;
+        }
+        if (k > 0)
+        {
+            az[k] = az[k - 1] + remainder(az[k] - az[k - 1], 360.0);
+        }
+    }
+
+    for (int j = 0; j < nodes; j++)
+    {
+        double sumAz = 0, sumEl = 0;
+        for (int k = 0; k < nodes; k++)
+        {
+            double c = cos(M_PI * j * (k + 0.5) / nodes);
+            sumAz += az[k] * c;
+            sumEl += el[k] * c;
+        }
+        azCoeffs[j] = 2.0 * sumAz / nodes;
+        elCoeffs[j] = 2.0 * sumEl / nodes;
+    }
+
+    t0 = start;
+    t1 = start + duration;
+    order = n;
+    valid = true;
+
+    // Error check halfway between consecutive nodes and at both ends
+    maxError = 0;
+    for (int k = 0; k <= nodes; k++)
+    {
+        double x = (k == 0) ? 1.0 : (k == nodes) ? -1.0
+                                                 : cos(M_PI * k / nodes);
+        double t = mid + half * x;
+        double trueAz, trueEl, fitAz, fitEl;
+        sample(t, trueAz, trueEl);
+        evaluate(t, fitAz, fitEl);
+        maxError = fmax(maxError, fabs(remainder(fitAz - trueAz, 360.0)));
+        maxError = fmax(maxError, fabs(fitEl - trueEl));
+    }
+    return true;
+}
+
+template <class Sampler>
+bool ChebyshevSegment::fitWithin(double start, double duration, int n, double target, int maxRefits, Sampler sample)
+{
+    for (int i = 0; i < maxRefits; i++, duration /= 2)
+    {
+        if (!fit(start, duration, n, sample))
+        {
+            return false;
+        }
+        if (maxError <= target)
+        {
+            break;
+        }
+    }
+    return valid;
+}
+
+#endif
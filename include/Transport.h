@@ -0,0 +1,64 @@
+#ifndef TRANSPORT_H
+#define TRANSPORT_H
+#include <stddef.h>
+#include <stdint.h>
+
+// Byte stream the command link runs on : the UART on the device (see
+// UartTransport.h), a pty or pipe on the host. No Arduino dependency.
+
+#ifndef TRANSPORT_RX_CHUNK
+#define TRANSPORT_RX_CHUNK 64 // Bytes moved from the transport per read
+#endif
+
+#define TRANSPORT_WAIT_FOREVER 0xffffffffUL
+
+class SerialTransport
+{
+public:
+    virtual ~SerialTransport() {}
+
+    // Non-blocking : copies up to size received bytes, returns the count
+    virtual size_t read(uint8_t *buffer, size_t size) = 0;
+
+    virtual size_t write(const uint8_t *data, size_t size) = 0;
+
+    // Blocks until bytes are available or timeoutMs elapsed
+    // (TRANSPORT_WAIT_FOREVER for no timeout). Returns true if readable.
+    virtual bool waitReadable(uint32_t timeoutMs) = 0;
+};
+
+// Assembles lines from a transport into a caller-owned buffer, without
+// blocking and without heap allocation. The delimiter is '\n' for text, or
+// 0 for binary frames (see Protocol.h), which never contain it.
+class LineReader
+{
+public:
+    enum Status
+    {
+        NONE,    // No complete line received yet
+        LINE,    // line points to a complete line, '\0' terminated ('\r' stripped in text)
+        TOO_LONG // A line did not fit the buffer and was dropped
+    };
+
+    LineReader(char *buffer, size_t size) : buffer(buffer), size(size), length(0), overflow(false), delimiter('\n'), rxHead(0), rxTail(0) {}
+
+    // Applies from the next byte consumed ; bytes already received are
+    // delimited the new way
+    void setDelimiter(char newDelimiter) { delimiter = newDelimiter; }
+
+    // Consumes received bytes up to the next end of line. line stays valid,
+    // and may be modified, until the next call.
+    Status next(SerialTransport &transport, char *&line);
+
+private:
+    char *buffer;
+    size_t size;
+    size_t length;
+    bool overflow;
+    char delimiter;
+
+    uint8_t rx[TRANSPORT_RX_CHUNK]; // Read but not yet consumed
+    size_t rxHead, rxTail;
+};
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef UARTTRANSPORT_H
+#define UARTTRANSPORT_H
+#include <Arduino.h>
+#include "Transport.h"
+
+// Event-driven UART : the driver fills its RX ring buffer from the interrupt
+// and raises a receive event on RX FIFO threshold or line idle, which
+// notifies the waiting task. No polling, so a command is handled as soon as
+// its last byte arrives.
+class UartTransport : public SerialTransport
+{
+public:
+    explicit UartTransport(HardwareSerial &serial) : serial(serial), waitingTask(nullptr) {}
+
+    // Opens the UART and registers the receive event
+    void begin(unsigned long baudrate);
+
+    size_t read(uint8_t *buffer, size_t size) override;
+    size_t write(const uint8_t *data, size_t size) override;
+
+    // To be called from a single task, which is notified on receive events
+    bool waitReadable(uint32_t timeoutMs) override;
+
+private:
+    HardwareSerial &serial;
+    TaskHandle_t volatile waitingTask;
+};
+
+#endif
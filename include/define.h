@@ -5,13 +5,50 @@
 
 #define HWSerial Serial
 #define SERIAL_BAUDRATE 921600
-#define POSITION_BROADCAST_DELAY 5000
+#define SERIAL_RX_BUFFER 1024 // UART driver receive ring buffer, in bytes
+#define SERIAL_RX_TIMEOUT 2   // Line idle time raising a receive event, in symbols
+#define POSITION_BROADCAST_DELAY 5000 // Default telemetry period and keepalive of the stream, in ms
+#define STREAM_MAX_RATE 100           // Max position stream rate, in Hz
+#define STREAM_DEFAULT_DEADBAND 0.001 // Position change below which samples are suppressed, in degrees
+#define TIMING_DEFAULT_PERIOD 10000   // Timing topic period at rate 0, in ms
 
-#define TASK_TIMEOUT 5000
+#define LOG_BUFFER_SIZE 4096 // Output ring, in bytes (power of 2) ; messages are dropped when full
+#define LOG_TX_CHUNK 256     // Max bytes per UART write, coalescing small messages
+#define LOG_TASK_STACK 3072  // Logger TX task stack, in bytes
+#define MESSAGE_MAX 640      // Formatted message, on the caller's stack ; text payloads are cut to fit
+#define STAMPED_TEXT_MAX 96  // Text of an acknowledgement stamped at transmission, see print_acknowledgement_stamped
 
-#define TRACK_DELAY 2000
+// Log levels (see Log.h) : call sites below LOG_LEVEL are compiled out
+#define LOG_LEVEL_DEBUG 0
+#define LOG_LEVEL_INFO 1
+#define LOG_LEVEL_WARNING 2
+#define LOG_LEVEL_ERROR 3
+#define LOG_LEVEL_NONE 4
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO // e.g. -DLOG_LEVEL=LOG_LEVEL_DEBUG in build_flags
+#endif
+#define LOG_RATE_INTERVAL 1000 // Min interval between repeated messages of a call site, in ms
+
+#define MOTION_QUEUE_LENGTH 8   // Pending motion commands
+#define MOTION_TASK_STACK 4096  // Motion executor stack, in bytes
+
+#define BATCH_MAX 32 // Max targets per batch conversion command
+#define COMMAND_LINE_MAX 768 // Command line buffer, longer lines are rejected
+
+#define TRACK_SLEW_THRESHOLD 1.0 // Tracking error in degrees above which the mount slews
+#define TRACK_UPDATE_INTERVAL 50 // Target coordinates update period, in ms
+#define TRACK_STALE_INTERVAL (4 * TRACK_UPDATE_INTERVAL) // Target age beyond which it is not extrapolated, in ms
 #define MOTION_MIN 0.1f
 
+#define TRAJ_SEGMENT_DURATION 300. // Chebyshev segment length, in seconds
+#define TRAJ_ORDER 7               // Chebyshev order of a tracking segment
+#define TRAJ_MAX_ORDER 15
+#define TRAJ_MAX_ERROR 0.01 // Target segment error in degrees, refit shorter above
+#define TRAJ_MAX_REFITS 4
+#define TRAJ_FIT_LEAD 60. // Next segment fitted by the tracker task this long before the current one ends, in s
+#define TRAJ_TABLE_POINTS 512  // Uploaded trajectory points (power of 2), 16 bytes each
+#define TRAJ_TABLE_SEGMENTS 16 // Uploaded Chebyshev segments (power of 2)
+
 #define AZ_MAX 360
 #define AZ_MIN 0
 #define EL_MAX 89
@@ -24,7 +61,30 @@
 #define OBS_LON 6.565
 #define OBS_HEIGHT 411.0
 
+#define CLOCK_STEP_THRESHOLD 0.128 // Offset above which the clock steps rather than slews, in s
+#define CLOCK_MAX_SLEW 500e-6      // Max slew rate of an offset correction, in s/s
+#define CLOCK_MAX_FREQ 500e-6      // Max drift correction, in s/s
+#define CLOCK_FREQ_GAIN 0.25       // Frequency loop gain
+#define CLOCK_MIN_INTERVAL 16.     // Frequency loop averaging floor, in s
+#define CLOCK_FILTER_SIZE 8        // Exchanges whose min delay gates the next ones
+#define CLOCK_DELAY_MARGIN 0.5e-3  // Delay accepted above twice that min, in s
+#define CLOCK_DRIFT_BOUND 15e-6    // Uncertainty growth between exchanges, in s/s
+
+#define DUT1 0.0                    // UT1 - UTC in seconds, |DUT1| < 0.9
+#define ASTROM_REFRESH_INTERVAL 60. // Slow astrometry terms refresh, in seconds
+#define SIDEREAL_ANCHOR_INTERVAL 60. // Full sidereal time evaluation, propagated in between, in seconds
+#define ASTROM_FULL_TIER 1            // 0 compiles out the IAU 2006/2000A models
+#define ASTROM_TIER AccuracyTier::FULL // Default accuracy tier (see Astrometry.h)
+#define POINTING_BUDGET MOTION_MIN     // Pointing budget in degrees, picks the tracker tier
+
+// Per-target trigonometry precision per tracking mode (see Precision.h)
+#define TRACK_PRECISION_EQUATORIAL PrecisionMode::DOUBLE
+#define TRACK_PRECISION_GALACTIC PrecisionMode::DOUBLE
+
+#define EPHEM_INTERVAL 3600. // Solar system ephemeris grid, in seconds (interpolated)
+
+#define TLE_NAME_LENGTH 24 // Max satellite name length (TLE title line)
+
 #define J2000 2451545.0 // Julian date for the J2000 epoch
 
-extern inline double start_time = 0; // In seconds
 #endif
\ No newline at end of file
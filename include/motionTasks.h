@@ -5,29 +5,96 @@
 #include "Tasker.h"
 #include <Arduino.h>
 
-typedef void (*TaskFunction_t)(void *);
+// Motion commands, executed one at a time by a single long-lived executor
+// task. Any new command preempts the one running ; the queue is bounded and
+// never blocks the sender. The acknowledgement of a queued command tells it
+// was accepted ; an EVENT message, with the request ID of the command if it
+// had one, tells when it completed or failed (preempted).
+enum MotionCommandType
+{
+    MOTION_POINT_TO,
+    MOTION_HOME,
+    MOTION_STANDBY,
+    MOTION_UNTANGLE,
+    MOTION_TRACK,
+    MOTION_STOP
+};
 
-inline unsigned long lastPointCommandTime(0);
+struct MotionCommand
+{
+    MotionCommandType type;
+    float az, el;       // MOTION_POINT_TO
+    Tasker *tasker;     // MOTION_TRACK
+    uint32_t submitted; // micros() at submission
+    bool preempting;    // A motion was running at submission
+    uint32_t requestId; // Of the submitting command, see setRequestId
+};
 
-extern SemaphoreHandle_t motionMutex; // Mutex de protection
+// Executor state machine
+enum MotionState
+{
+    MOTION_IDLE,
+    MOTION_POINTING,
+    MOTION_HOMING,
+    MOTION_STANDING_BY,
+    MOTION_UNTANGLING,
+    MOTION_TRACKING
+};
 
-extern TaskHandle_t motionTaskHandle;       // Tâche point active
-extern TaskHandle_t startPendingTaskHandle; // Handle for startPointTo task
+const char *motionStateToString(MotionState state);
+MotionState getMotionState();
 
+// Position + velocity setpoint for continuous tracking
+struct MotionSetpoint
+{
+    double time;           // Unix time the setpoint refers to
+    double az, el;         // Degrees
+    double azRate, elRate; // Degrees per second
+};
+
+// Motion primitives, run from the executor. They return false when
+// preempted by a new command.
 bool pointTo(float const &az, float const &el, bool *stop_flag = nullptr);
-void pointToTask(void *parameters);
-void homingTask(void *parameters);
-void untangleTask(void *parameters);
-void standbyTask(void *parameters);
-void untangleTask(void *parameters);
-void trackingTask(void *parameters);
-
-void startMotionTask(TaskFunction_t taskFunction, void *args, const char *taskName);
-void startPointTo(float az, float elev);
-void startHoming();
-void startStandby();
-void startUntangle();
-void stopMotionTask();
-void startTracking(Tasker *tracker);
-
-#endif
\ No newline at end of file
+bool streamSetpoint(MotionSetpoint const &setpoint);
+bool homing();
+bool standby();
+bool untangle();
+
+// True when a new command is waiting : the running motion must return
+bool motionPreempted();
+
+// Blocks the running motion up to timeout, waking at once on a new command
+// or a signalMotionEvent(). Returns true if woken by an event.
+bool waitMotionEvent(TickType_t timeout);
+
+// Wakes the running motion, e.g. on a tracking target change
+void signalMotionEvent();
+
+// Stop latency : from the submission of a command to the preempted motion
+// having returned to the executor, in milliseconds
+struct MotionLatency
+{
+    float last, max;
+    unsigned long count; // Measured preemptions
+};
+MotionLatency getMotionLatency();
+
+// Creates the command queue and the executor task, once at startup
+void startMotionExecutor();
+
+// Queue a command. Returns false if the queue is full, never for a stop,
+// which drops the pending commands (reported as preempted).
+bool submitMotionCommand(MotionCommand const &command);
+bool startPointTo(float az, float elev);
+bool startHoming();
+bool startStandby();
+bool startUntangle();
+bool stopMotionTask();
+bool startTracking(Tasker *tracker);
+
+// The running track now serves the submitting command, e.g. a new target :
+// the previous command is reported completed, the submitting one when the
+// track ends. Only while tracking with no command pending.
+void retargetTracking();
+
+#endif
@@ -5,11 +5,14 @@
 #include <string>
 #include <chrono>
 #include "define.h"
+#include "Precision.h"
+#include "Seqlock.h"
 
 extern "C"
 {
 #include <sofa.h> // Include the SOFA header
 #include <sofam.h>
+#include <leapsec.h> // Run-time leap second table (local iauDat)
 }
 
 std::vector<String> splitString(const String &str, char delimiter);
@@ -19,20 +22,114 @@ constexpr double UNIX_EPOCH_JD = 2440587.5;
 constexpr double GALACTIC_NGP_RA = 192.85948;  // degrees
 constexpr double GALACTIC_NGP_DEC = 27.12825;  // degrees
 constexpr double GALACTIC_NORTH_LON = 122.932; // degrees
+// Mean sidereal rate, in degrees of sidereal time per UT1 second
+constexpr double SIDEREAL_RATE_DEG = 360.985647366286 / SECONDS_IN_DAY;
 
 // Function to check if a string can be converted to float
 bool isFloat(const String &str);
 
+// Unix time, from the disciplined device clock (see Clock.h)
 double getCurrentTime();
 String getCurrentTimestamp();
 
-// Function to compute Earth Rotation Angle (ERA) from UNIX timestamp
-double unixTimeToJD(double const &unixTime);
-double computeGMST(double const &jd);
+// Two-part Julian date, as SOFA takes it : the day at 0h (ending in .5)
+// and the fraction of the day, in [0, 1). A single double near 2.46e6
+// only resolves 40 us ; the parts keep the resolution of the Unix time.
+struct JulianDate
+{
+    double day;
+    double fraction;
+
+    double daysSinceJ2000() const { return (day - J2000) + fraction; }
+};
+
+// Quasi-JD of a Unix timestamp (UTC, or UT1 given unixTime + DUT1) : split
+// once, then passed as is to SOFA
+JulianDate unixTimeToJD(double unixTime);
+// JD (TT) of a Unix timestamp. False if before the leap second table.
+bool unixTimeToTT(double unixTime, JulianDate &tt);
+// GMST in hours, [0, 24)
+double computeGMST(JulianDate const &ut);
 double computeEquationOfEquinoxes(double const &d);
 
 std::tuple<double, double> raDecToAltAz(
     double ra, double dec, double unixTime = -1.);
 std::tuple<double, double> galacticToEquatorial(double l, double b);
 std::tuple<double, double> galacticToAltAz(double l, double b, double unixTime = -1.);
+
+// Local apparent sidereal time in degrees, [0, 360)
+double localSiderealTime(double unixTime);
+
+// Local sidereal time advanced at SIDEREAL_RATE_DEG from a full
+// localSiderealTime() evaluation, the anchor : one multiply-add instead of
+// the time scales and the GMST polynomial. Re-anchored when the time is
+// more than the interval away from the anchor, either way (so after a clock
+// step), or after invalidate(). Off by < 1e-7 degree over 60 s.
+// Any task : the anchor is a Seqlock snapshot, replaced by one task at a
+// time, the others evaluating in full meanwhile.
+class SiderealPropagator
+{
+public:
+    explicit SiderealPropagator(double interval = SIDEREAL_ANCHOR_INTERVAL);
+
+    double at(double unixTime); // Degrees, [0, 360)
+
+    // Re-anchors on the next call, e.g. after a leap second table update
+    void invalidate() { generation++; }
+
+    uint32_t getAnchors() const { return anchors; } // Full evaluations
+
+private:
+    struct Anchor
+    {
+        double time, lst;
+        uint32_t generation; // Of the anchor, stale if not the current one
+    };
+    Seqlock<Anchor> anchor;
+    double interval;
+    std::atomic<uint32_t> generation, anchors;
+    std::atomic_flag updating = ATOMIC_FLAG_INIT;
+};
+
+// Propagator of the conversions below
+SiderealPropagator &siderealTime();
+
+// Az/El rates (degrees per second) of a target fixed on the sky, currently
+// at az/el (degrees), from the derivative of the hour angle -> Az/El
+// projection (see altAzHourAngleRates)
+std::tuple<double, double> siderealAltAzRates(double az, double el);
+
+// Batch (structure-of-arrays) versions of the conversions above. All angles
+// in degrees. Time-dependent terms are computed once per call ; with an
+// array of epochs, sidereal time is propagated from the first one.
+void raDecToAltAzBatch(const double *ra, const double *dec,
+                       double *az, double *alt, size_t n, double unixTime = -1.);
+void raDecToAltAzBatch(const double *ra, const double *dec, const double *unixTimes,
+                       double *az, double *alt, size_t n);
+void galacticToEquatorialBatch(const double *l, const double *b,
+                               double *ra, double *dec, size_t n);
+void galacticToAltAzBatch(const double *l, const double *b,
+                          double *az, double *alt, size_t n, double unixTime = -1.);
+
+// Same conversions with an explicit precision policy for the per-target
+// trigonometry (see Precision.h). Instantiated for DoublePrecision and
+// SinglePrecision ; the untemplated versions above use DoublePrecision.
+template <class Policy>
+std::tuple<double, double> raDecToAltAz(double ra, double dec, double unixTime = -1.);
+template <class Policy>
+std::tuple<double, double> galacticToEquatorial(double l, double b);
+template <class Policy>
+std::tuple<double, double> galacticToAltAz(double l, double b, double unixTime = -1.);
+template <class Policy>
+void raDecToAltAzBatch(const double *ra, const double *dec,
+                       double *az, double *alt, size_t n, double unixTime = -1.);
+template <class Policy>
+void raDecToAltAzBatch(const double *ra, const double *dec, const double *unixTimes,
+                       double *az, double *alt, size_t n);
+template <class Policy>
+void galacticToEquatorialBatch(const double *l, const double *b,
+                               double *ra, double *dec, size_t n);
+template <class Policy>
+void galacticToAltAzBatch(const double *l, const double *b,
+                          double *az, double *alt, size_t n, double unixTime = -1.);
 #endif
\ No newline at end of file
@@ -1,4 +1,104 @@
 #include "sofa.h"
+#include "leapsec.h"
+#include <limits.h>
+#include <stdatomic.h>
+
+/*
+**  Local modification: the tables and constants below are moved out of
+**  iauDat, unchanged, so that the run-time additions at the end of this
+**  file can extend them.
+*/
+
+/* Release year for this version of iauDat */
+enum { IYV = 2023};
+
+/* Reference dates (MJD) and drift rates (s/day), pre leap seconds */
+static const double drift[][2] = {
+   { 37300.0, 0.0012960 },
+   { 37300.0, 0.0012960 },
+   { 37300.0, 0.0012960 },
+   { 37665.0, 0.0011232 },
+   { 37665.0, 0.0011232 },
+   { 38761.0, 0.0012960 },
+   { 38761.0, 0.0012960 },
+   { 38761.0, 0.0012960 },
+   { 38761.0, 0.0012960 },
+   { 38761.0, 0.0012960 },
+   { 38761.0, 0.0012960 },
+   { 38761.0, 0.0012960 },
+   { 39126.0, 0.0025920 },
+   { 39126.0, 0.0025920 }
+};
+
+/* Number of Delta(AT) expressions before leap seconds were introduced */
+enum { NERA1 = (int) (sizeof drift / sizeof (double) / 2) };
+
+/* Dates and Delta(AT)s */
+static const struct {
+   int iyear, month;
+   double delat;
+} changes[] = {
+   { 1960,  1,  1.4178180 },
+   { 1961,  1,  1.4228180 },
+   { 1961,  8,  1.3728180 },
+   { 1962,  1,  1.8458580 },
+   { 1963, 11,  1.9458580 },
+   { 1964,  1,  3.2401300 },
+   { 1964,  4,  3.3401300 },
+   { 1964,  9,  3.4401300 },
+   { 1965,  1,  3.5401300 },
+   { 1965,  3,  3.6401300 },
+   { 1965,  7,  3.7401300 },
+   { 1965,  9,  3.8401300 },
+   { 1966,  1,  4.3131700 },
+   { 1968,  2,  4.2131700 },
+   { 1972,  1, 10.0       },
+   { 1972,  7, 11.0       },
+   { 1973,  1, 12.0       },
+   { 1974,  1, 13.0       },
+   { 1975,  1, 14.0       },
+   { 1976,  1, 15.0       },
+   { 1977,  1, 16.0       },
+   { 1978,  1, 17.0       },
+   { 1979,  1, 18.0       },
+   { 1980,  1, 19.0       },
+   { 1981,  7, 20.0       },
+   { 1982,  7, 21.0       },
+   { 1983,  7, 22.0       },
+   { 1985,  7, 23.0       },
+   { 1988,  1, 24.0       },
+   { 1990,  1, 25.0       },
+   { 1991,  1, 26.0       },
+   { 1992,  7, 27.0       },
+   { 1993,  7, 28.0       },
+   { 1994,  7, 29.0       },
+   { 1996,  1, 30.0       },
+   { 1997,  7, 31.0       },
+   { 1999,  1, 32.0       },
+   { 2006,  1, 33.0       },
+   { 2009,  1, 34.0       },
+   { 2012,  7, 35.0       },
+   { 2015,  7, 36.0       },
+   { 2017,  1, 37.0       }
+};
+
+/* Number of Delta(AT) changes */
+enum { NDAT = (int) (sizeof changes / sizeof changes[0]) };
+
+/*
+**  Local additions (not SOFA): state of the run-time leap second table
+**  and of the iauDat cache, see leapsec.h.
+*/
+static struct {
+   int iyear, month;
+   double delat;
+} datExtra[DAT_MAXEXTRA];
+static atomic_int datNextra = 0;
+static atomic_int datValidYear = 0;
+static atomic_uint datCacheSeq = 0;
+static int datCacheLo = INT_MAX, datCacheHi = INT_MIN;
+static double datCacheDelat = 0.0;
+
 
 int iauDat(int iy, int im, int id, double fd, double *deltat)
 /*
@@ -45,6 +145,23 @@ int iauDat(int iy, int im, int id, double fd, double *deltat)
 **
 **  Status:  user-replaceable support function.
 **
+**  Local modification:
+**     This is a replacement of the SOFA iauDat (SOFA license clause 3c),
+**     derived from and using computations of the SOFA version.  It is
+**     not itself SOFA software and is not endorsed by SOFA.  It differs
+**     from the original as follows:
+**
+**     a) Leap seconds announced after this release can be appended at
+**        run time (datAddLeapSecond, see leapsec.h).  They follow the
+**        built-in "changes" table.  The "dubious year" limit IYV + 5
+**        can be moved with datSetValidYear.
+**
+**     b) The Delta(AT) found for a date since 1972 is cached together
+**        with the range of months over which it holds.  A call in that
+**        range with a day from 1 to 28 returns the cached value without
+**        the calendar conversion or the table scan.  The cache is a
+**        sequence lock, so concurrent callers never read a torn entry.
+**
 **  Given:
 **     iy     int      UTC:  year (Notes 1 and 2)
 **     im     int            month (Note 2)
@@ -127,90 +244,36 @@ int iauDat(int iy, int im, int id, double fd, double *deltat)
 **  Copyright (C) 2023 IAU SOFA Board.  See notes at end.
 */
 {
-/* Release year for this version of iauDat */
-   enum { IYV = 2023};
-
-/* Reference dates (MJD) and drift rates (s/day), pre leap seconds */
-   static const double drift[][2] = {
-      { 37300.0, 0.0012960 },
-      { 37300.0, 0.0012960 },
-      { 37300.0, 0.0012960 },
-      { 37665.0, 0.0011232 },
-      { 37665.0, 0.0011232 },
-      { 38761.0, 0.0012960 },
-      { 38761.0, 0.0012960 },
-      { 38761.0, 0.0012960 },
-      { 38761.0, 0.0012960 },
-      { 38761.0, 0.0012960 },
-      { 38761.0, 0.0012960 },
-      { 38761.0, 0.0012960 },
-      { 39126.0, 0.0025920 },
-      { 39126.0, 0.0025920 }
-   };
-
-/* Number of Delta(AT) expressions before leap seconds were introduced */
-   enum { NERA1 = (int) (sizeof drift / sizeof (double) / 2) };
-
-/* Dates and Delta(AT)s */
-   static const struct {
-      int iyear, month;
-      double delat;
-   } changes[] = {
-      { 1960,  1,  1.4178180 },
-      { 1961,  1,  1.4228180 },
-      { 1961,  8,  1.3728180 },
-      { 1962,  1,  1.8458580 },
-      { 1963, 11,  1.9458580 },
-      { 1964,  1,  3.2401300 },
-      { 1964,  4,  3.3401300 },
-      { 1964,  9,  3.4401300 },
-      { 1965,  1,  3.5401300 },
-      { 1965,  3,  3.6401300 },
-      { 1965,  7,  3.7401300 },
-      { 1965,  9,  3.8401300 },
-      { 1966,  1,  4.3131700 },
-      { 1968,  2,  4.2131700 },
-      { 1972,  1, 10.0       },
-      { 1972,  7, 11.0       },
-      { 1973,  1, 12.0       },
-      { 1974,  1, 13.0       },
-      { 1975,  1, 14.0       },
-      { 1976,  1, 15.0       },
-      { 1977,  1, 16.0       },
-      { 1978,  1, 17.0       },
-      { 1979,  1, 18.0       },
-      { 1980,  1, 19.0       },
-      { 1981,  7, 20.0       },
-      { 1982,  7, 21.0       },
-      { 1983,  7, 22.0       },
-      { 1985,  7, 23.0       },
-      { 1988,  1, 24.0       },
-      { 1990,  1, 25.0       },
-      { 1991,  1, 26.0       },
-      { 1992,  7, 27.0       },
-      { 1993,  7, 28.0       },
-      { 1994,  7, 29.0       },
-      { 1996,  1, 30.0       },
-      { 1997,  7, 31.0       },
-      { 1999,  1, 32.0       },
-      { 2006,  1, 33.0       },
-      { 2009,  1, 34.0       },
-      { 2012,  7, 35.0       },
-      { 2015,  7, 36.0       },
-      { 2017,  1, 37.0       }
-   };
-
-/* Number of Delta(AT) changes */
-   enum { NDAT = (int) (sizeof changes / sizeof changes[0]) };
-
 /* Miscellaneous local variables */
-   int j, i, m;
+   int j, i, m, n, limit, first, next;
+   unsigned seq;
    double da, djm0, djm;
 
 
 /* Initialize the result to zero. */
    *deltat = da = 0.0;
 
+/* Year beyond which the result is dubious. */
+   limit = atomic_load_explicit(&datValidYear, memory_order_relaxed);
+   if (limit == 0) limit = IYV + 5;
+
+/* Fast path: cached Delta(AT) for the surrounding range of months. */
+   m = 12*iy + im;
+   seq = atomic_load_explicit(&datCacheSeq, memory_order_acquire);
+   if (fd >= 0.0 && fd <= 1.0 && im >= 1 && im <= 12 &&
+       id >= 1 && id <= 28 && !(seq & 1u)) {
+      int lo = datCacheLo;
+      int hi = datCacheHi;
+      da = datCacheDelat;
+      atomic_thread_fence(memory_order_acquire);
+      if (atomic_load_explicit(&datCacheSeq, memory_order_relaxed) == seq &&
+          m >= lo && m < hi) {
+         *deltat = da;
+         return (iy > limit) ? 1 : 0;
+      }
+      da = 0.0;
+   }
+
 /* If invalid fraction of a day, set error status and give up. */
    if (fd < 0.0 || fd > 1.0) return -4;
 
@@ -224,24 +287,51 @@ int iauDat(int iy, int im, int id, double fd, double *deltat)
    if (iy < changes[0].iyear) return 1;
 
 /* If suspiciously late year, set warning status but proceed. */
-   if (iy > IYV + 5) j = 1;
-
-/* Combine year and month to form a date-ordered integer... */
-   m = 12*iy + im;
+   if (iy > limit) j = 1;
 
-/* ...and use it to find the preceding table entry. */
-   for (i = NDAT-1; i >=0; i--) {
-      if (m >= (12 * changes[i].iyear + changes[i].month)) break;
+/* Run-time entries follow the built-in ones. */
+   n = atomic_load_explicit(&datNextra, memory_order_acquire);
+   for (i = n-1; i >= 0; i--) {
+      if (m >= (12 * datExtra[i].iyear + datExtra[i].month)) break;
    }
+   if (i >= 0) {
+      da = datExtra[i].delat;
+      first = 12 * datExtra[i].iyear + datExtra[i].month;
+      next = (i + 1 < n) ?
+             12 * datExtra[i+1].iyear + datExtra[i+1].month : INT_MAX;
+   } else {
+
+   /* Use the date-ordered integer to find the preceding table entry. */
+      for (i = NDAT-1; i >=0; i--) {
+         if (m >= (12 * changes[i].iyear + changes[i].month)) break;
+      }
 
-/* Prevent underflow warnings. */
-   if (i < 0) return -5;
+   /* Prevent underflow warnings. */
+      if (i < 0) return -5;
 
-/* Get the Delta(AT). */
-   da = changes[i].delat;
+   /* Get the Delta(AT). */
+      da = changes[i].delat;
 
-/* If pre-1972, adjust for drift. */
-   if (i < NERA1) da += (djm + fd - drift[i][0]) * drift[i][1];
+   /* If pre-1972, adjust for drift, and do not cache. */
+      if (i < NERA1) {
+         *deltat = da + (djm + fd - drift[i][0]) * drift[i][1];
+         return j;
+      }
+      next = (i + 1 < NDAT) ?
+             12 * changes[i+1].iyear + changes[i+1].month :
+             (n > 0) ? 12 * datExtra[0].iyear + datExtra[0].month : INT_MAX;
+      first = 12 * changes[i].iyear + changes[i].month;
+   }
+
+/* Cache the result for months [first, next), unless the table */
+/* changed or another call is filling the cache. */
+   if (!(seq & 1u) &&
+       atomic_compare_exchange_strong(&datCacheSeq, &seq, seq + 1u)) {
+      datCacheLo = first;
+      datCacheHi = next;
+      datCacheDelat = da;
+      atomic_store_explicit(&datCacheSeq, seq + 2u, memory_order_release);
+   }
 
 /* Return the Delta(AT) value. */
    *deltat = da;
@@ -351,3 +441,61 @@ int iauDat(int iy, int im, int id, double fd, double *deltat)
 **
 **--------------------------------------------------------------------*/
 }
+
+/* Take the cache for writing, and empty it. */
+static void datInvalidate(void)
+{
+   unsigned seq;
+
+   do {
+      seq = atomic_load(&datCacheSeq) & ~1u;
+   } while (!atomic_compare_exchange_weak(&datCacheSeq, &seq, seq + 1u));
+   datCacheLo = INT_MAX;
+   datCacheHi = INT_MIN;
+   atomic_store_explicit(&datCacheSeq, seq + 2u, memory_order_release);
+}
+
+int datAddLeapSecond(int iy, int im, double delat)
+{
+   int n, last;
+   double lastDelat, djm0, djm;
+
+   if (im < 1 || im > 12 || iauCal2jd(iy, im, 1, &djm0, &djm) < 0) return -2;
+
+   n = atomic_load(&datNextra);
+   if (n >= DAT_MAXEXTRA) return -3;
+
+/* Must follow the last known change, built-in or not. */
+   if (n > 0) {
+      last = 12 * datExtra[n-1].iyear + datExtra[n-1].month;
+      lastDelat = datExtra[n-1].delat;
+   } else {
+      last = 12 * changes[NDAT-1].iyear + changes[NDAT-1].month;
+      lastDelat = changes[NDAT-1].delat;
+   }
+   if (12 * iy + im <= last || delat == lastDelat) return -1;
+
+   datExtra[n].iyear = iy;
+   datExtra[n].month = im;
+   datExtra[n].delat = delat;
+   atomic_store_explicit(&datNextra, n + 1, memory_order_release);
+   datInvalidate();
+   return 0;
+}
+
+void datResetLeapSeconds(void)
+{
+   atomic_store(&datNextra, 0);
+   atomic_store(&datValidYear, 0);
+   datInvalidate();
+}
+
+void datSetValidYear(int iy)
+{
+   atomic_store(&datValidYear, iy);
+}
+
+int datLeapSecondCount(void)
+{
+   return atomic_load(&datNextra);
+}
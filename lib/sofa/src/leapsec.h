@@ -0,0 +1,35 @@
+#ifndef LEAPSECHDEF
+#define LEAPSECHDEF
+
+/*
+**  Local additions (not SOFA) to the user-replaceable iauDat, see the
+**  "Local modification" notes in dat.c.
+*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Capacity of the run-time leap second table */
+#define DAT_MAXEXTRA 16
+
+/* Append a Delta(AT) change starting on iy-im-01 (UTC).  Returns 0 if */
+/* accepted, -1 if not after the last known change or same Delta(AT), */
+/* -2 for a bad year or month, -3 if the table is full. */
+int datAddLeapSecond(int iy, int im, double delat);
+
+/* Drop the run-time entries and restore the default validity year. */
+void datResetLeapSeconds(void);
+
+/* Last year for which iauDat results are trusted (status 0); beyond it */
+/* the status is +1.  Zero restores the built-in IYV + 5. */
+void datSetValidYear(int iy);
+
+/* Number of run-time entries */
+int datLeapSecondCount(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
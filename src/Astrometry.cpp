@@ -0,0 +1,250 @@
+#include "Astrometry.h"
+
+// Earth rotation angle rate, in radians per UT1 second (IERS 2003)
+static constexpr double ERA_RATE = D2PI * 1.00273781191135448 / DAYSEC;
+
+// Geocentric Sun from the Astronomical Almanac low-precision formulae
+// (~0.01 deg), referred to J2000, in au. d is TT days from J2000.
+static void lowPrecisionSun(double d, double p[3])
+{
+    double g = (357.528 + 0.9856003 * d) * DD2R;
+    double L = 280.460 + 0.9856474 * d;
+    double lambda = (L + 1.915 * sin(g) + 0.020 * sin(2 * g) - 3.82e-5 * d) * DD2R; // Precession removed
+    double R = 1.00014 - 0.01671 * cos(g) - 0.00014 * cos(2 * g);
+    double eps = 23.4393 * DD2R; // J2000 mean obliquity
+
+    p[0] = R * cos(lambda);
+    p[1] = R * cos(eps) * sin(lambda);
+    p[2] = R * sin(eps) * sin(lambda);
+}
+
+// Heliocentric Earth position/velocity (au, au/day), barycentre taken as the
+// Sun (< 0.01 au, only affects light deflection).
+static void lowPrecisionEarth(double tt1, double tt2, double pv[2][3])
+{
+    double d = (tt1 - DJ00) + tt2;
+    double p0[3], p1[3], p2[3];
+    lowPrecisionSun(d, p0);
+    lowPrecisionSun(d - 0.5, p1);
+    lowPrecisionSun(d + 0.5, p2);
+    for (int i = 0; i < 3; i++)
+    {
+        pv[0][i] = -p0[i];
+        pv[1][i] = -(p2[i] - p1[i]);
+    }
+}
+
+const char *tierToString(AccuracyTier tier)
+{
+    switch (tier)
+    {
+    case AccuracyTier::FULL:
+        return "full";
+    case AccuracyTier::TRUNCATED:
+        return "truncated";
+    default:
+        return "low";
+    }
+}
+
+double tierMaxError(AccuracyTier tier)
+{
+    switch (tier)
+    {
+    case AccuracyTier::FULL:
+        return 1e-3 / 3600; // IAU 2006/2000A model, ~1 mas
+    case AccuracyTier::TRUNCATED:
+        return 1.5e-3 / 3600;
+    default:
+        return 15. / 3600;
+    }
+}
+
+AccuracyTier cheapestTier(double budget)
+{
+    if (tierMaxError(AccuracyTier::LOW) <= budget)
+    {
+        return AccuracyTier::LOW;
+    }
+    if (tierMaxError(AccuracyTier::TRUNCATED) <= budget)
+    {
+        return AccuracyTier::TRUNCATED;
+    }
+    return AccuracyTier::FULL;
+}
+
+AstrometryContext::AstrometryContext(double refreshInterval, AccuracyTier tier)
+    : tier(tier), refreshInterval(refreshInterval), lastRefresh(0), refreshEra(0), valid(false),
+      sxpl(0), cxpl(1), sypl(0), cypl(1), generation(0), cachedGeneration(0), cachedRa(0), cachedDec(0),
+      cachedRi(0), cachedDi(0)
+{
+}
+
+void AstrometryContext::setRefreshInterval(double seconds)
+{
+    refreshInterval = seconds;
+}
+
+void AstrometryContext::setTier(AccuracyTier newTier)
+{
+    tier = newTier;
+    valid = false;
+}
+
+bool AstrometryContext::isStale(double unixTime) const
+{
+    return !valid || fabs(unixTime - lastRefresh) > refreshInterval;
+}
+
+bool AstrometryContext::refresh(double unixTime)
+{
+    JulianDate utc = unixTimeToJD(unixTime);
+
+    // No refraction (phpa = 0) : radio frequencies, and the current mount
+    // budget is well above the refraction correction at EL_MIN.
+#if ASTROM_FULL_TIER
+    if (tier == AccuracyTier::FULL)
+    {
+        double eo;
+        if (iauApco13(utc.day, utc.fraction, DUT1,
+                      OBS_LON * DD2R, OBS_LAT * DD2R, OBS_HEIGHT,
+                      0.0, 0.0, 0.0, 0.0, 0.0, 0.0,
+                      &astrom, &eo) < 0)
+        {
+            valid = false;
+            return false;
+        }
+    }
+    else
+#endif
+    {
+        // Same steps as iauApco13, with cheaper models
+        double tai1, tai2, tt1, tt2, ut11, ut12, ehpv[2][3], ebpv[2][3], r[3][3], x, y, s;
+        if (iauUtctai(utc.day, utc.fraction, &tai1, &tai2) < 0 ||
+            iauUtcut1(utc.day, utc.fraction, DUT1, &ut11, &ut12) < 0)
+        {
+            valid = false;
+            return false;
+        }
+        iauTaitt(tai1, tai2, &tt1, &tt2);
+
+        if (tier == AccuracyTier::LOW)
+        {
+            lowPrecisionEarth(tt1, tt2, ehpv);
+            iauCpv(ehpv, ebpv);
+            iauPmat06(tt1, tt2, r); // Precession-bias, no nutation
+            iauBpn2xy(r, &x, &y);
+            s = -x * y / 2; // Leading term of the CIO locator
+        }
+        else
+        {
+            iauEpv00(tt1, tt2, ehpv, ebpv);
+            iauPnm00b(tt1, tt2, r);
+            iauBpn2xy(r, &x, &y);
+            s = iauS00(tt1, tt2, x, y);
+        }
+
+        iauApco(tt1, tt2, ebpv, ehpv[0], x, y, s, iauEra00(ut11, ut12),
+                OBS_LON * DD2R, OBS_LAT * DD2R, OBS_HEIGHT,
+                0.0, 0.0, iauSp00(tt1, tt2), 0.0, 0.0, &astrom);
+    }
+
+    sxpl = sin(astrom.xpl);
+    cxpl = cos(astrom.xpl);
+    sypl = sin(astrom.ypl);
+    cypl = cos(astrom.ypl);
+
+    JulianDate ut1 = unixTimeToJD(unixTime + DUT1);
+    refreshEra = iauEra00(ut1.day, ut1.fraction);
+    lastRefresh = unixTime;
+    valid = true;
+    generation++; // Invalidates the ICRS -> CIRS cache
+    return true;
+}
+
+// CIRS RA/Dec (radians) to observed Az/El (radians), adapted from SOFA
+// atioq.c without the refraction step. The local hour angle is formed and
+// reduced in double ; the rest runs in Policy::real.
+template <class Policy>
+void AstrometryContext::cirsToObserved(double ri, double di, double &az, double &el) const
+{
+    typedef typename Policy::real real;
+    const real mha = (real)reduceAngle(ri - astrom.eral);
+    const real dec = (real)di;
+
+    /* CIRS RA,Dec to Cartesian -HA,Dec. */
+    real cd = Policy::cos(dec);
+    real x = Policy::cos(mha) * cd;
+    real y = Policy::sin(mha) * cd;
+    real z = Policy::sin(dec);
+
+    /* Polar motion. */
+    const real sx = (real)sxpl, cx = (real)cxpl, sy = (real)sypl, cy = (real)cypl;
+    real xhd = cx * x + sx * z;
+    real yhd = sx * sy * x + cy * y - cx * sy * z;
+    real zhd = -sx * cy * x + sy * y + cx * cy * z;
+
+    /* Diurnal aberration. */
+    const real diurab = (real)astrom.diurab;
+    real f = ((real)1 - diurab * yhd);
+    real xhdt = f * xhd;
+    real yhdt = f * (yhd + diurab);
+    real zhdt = f * zhd;
+
+    /* Cartesian -HA,Dec to Cartesian Az,El (S=0,E=90). */
+    const real sphi = (real)astrom.sphi, cphi = (real)astrom.cphi;
+    real xaet = sphi * xhdt - cphi * zhdt;
+    real yaet = yhdt;
+    real zaet = cphi * xhdt + sphi * zhdt;
+
+    /* Azimuth (N=0,E=90) and elevation. */
+    double a = (xaet != (real)0 || yaet != (real)0) ? (double)Policy::atan2(yaet, -xaet) : 0.0;
+    az = (a < 0.0) ? a + 2 * M_PI : a;
+    el = Policy::atan2(zaet, Policy::sqrt(xaet * xaet + yaet * yaet));
+}
+
+template <class Policy>
+std::tuple<double, double> AstrometryContext::raDecToAltAz(double ra, double dec, double unixTime)
+{
+    if (unixTime + 1 < 1e6f)
+    {
+        unixTime = getCurrentTime();
+    }
+
+    if (isStale(unixTime) && !refresh(unixTime))
+    {
+        return std::make_tuple(NAN, NAN);
+    }
+
+    // Star-dependent part only changes with the target or the slow terms
+    if (cachedGeneration != generation || ra != cachedRa || dec != cachedDec)
+    {
+        iauAtciq(ra * DD2R, dec * DD2R, 0.0, 0.0, 0.0, 0.0, &astrom, &cachedRi, &cachedDi);
+        cachedRa = ra;
+        cachedDec = dec;
+        cachedGeneration = generation;
+    }
+
+    // Fast path : Earth rotation angle, then CIRS -> observed
+    iauAper(refreshEra + ERA_RATE * (unixTime - lastRefresh), &astrom);
+
+    double az, el;
+    cirsToObserved<Policy>(cachedRi, cachedDi, az, el);
+
+    return std::make_tuple(az * DR2D, el * DR2D);
+}
+
+std::tuple<double, double> AstrometryContext::raDecToAltAz(double ra, double dec, double unixTime,
+                                                           PrecisionMode precision)
+{
+    switch (precision)
+    {
+    case PrecisionMode::SINGLE:
+        return raDecToAltAz<SinglePrecision>(ra, dec, unixTime);
+    default:
+        return raDecToAltAz<DoublePrecision>(ra, dec, unixTime);
+    }
+}
+
+template std::tuple<double, double> AstrometryContext::raDecToAltAz<DoublePrecision>(double, double, double);
+template std::tuple<double, double> AstrometryContext::raDecToAltAz<SinglePrecision>(double, double, double);
@@ -0,0 +1,121 @@
+#include "Clock.h"
+#include <math.h>
+#include <chrono>
+#ifdef ESP_PLATFORM
+#include <esp_timer.h>
+#endif
+
+DisciplinedClock::DisciplinedClock() : state(), delayCount(0)
+{
+}
+
+double DisciplinedClock::timeAt(const State &s, int64_t local, double &remaining)
+{
+    double elapsed = (local - s.refLocal) * 1e-6;
+    double slew = fmin(fabs(s.phase), CLOCK_MAX_SLEW * fmax(elapsed, 0));
+    slew = copysign(slew, s.phase);
+    remaining = s.phase - slew;
+    return s.refTime + elapsed * (1 + s.frequency) + slew;
+}
+
+double DisciplinedClock::at(int64_t local) const
+{
+    double remaining;
+    return timeAt(state.load(), local, remaining);
+}
+
+void DisciplinedClock::set(double unixTime, int64_t local)
+{
+    State next = state.load();
+    next.refLocal = local;
+    next.refTime = unixTime;
+    next.phase = 0;
+    state.store(next);
+}
+
+bool DisciplinedClock::update(double t1, double t2, double t3, double t4, int64_t local)
+{
+    double offset = ((t1 - t2) + (t4 - t3)) / 2; // Host minus device
+    double delay = (t4 - t1) - (t3 - t2);
+    State next = state.load();
+
+    // Outlier filter against the minimum delay of the recent exchanges
+    delays[delayCount++ % CLOCK_FILTER_SIZE] = delay;
+    double minDelay = delay;
+    for (uint32_t i = 0; i < CLOCK_FILTER_SIZE && i < delayCount; i++)
+    {
+        minDelay = fmin(minDelay, delays[i]);
+    }
+    if (!isfinite(offset) || delay < 0 || delay > 2 * minDelay + CLOCK_DELAY_MARGIN)
+    {
+        next.rejected++;
+        state.store(next);
+        return false;
+    }
+
+    double remaining;
+    double now = timeAt(next, local, remaining);
+    if (!next.synced || fabs(offset) > CLOCK_STEP_THRESHOLD)
+    {
+        next.refTime = now + offset;
+        next.phase = 0;
+    }
+    else
+    {
+        // Frequency loop on the part of the offset that is not the pending
+        // correction : the drift since the last exchange, averaged over at
+        // least CLOCK_MIN_INTERVAL against the delay noise
+        double interval = (local - next.lastUpdate) * 1e-6;
+        next.frequency += CLOCK_FREQ_GAIN * (offset - remaining) / fmax(interval, CLOCK_MIN_INTERVAL);
+        next.frequency = fmax(-CLOCK_MAX_FREQ, fmin(CLOCK_MAX_FREQ, next.frequency));
+        next.refTime = now;
+        next.phase = offset; // Supersedes what was left to slew
+    }
+    next.refLocal = local;
+    next.lastUpdate = local;
+    next.offset = offset;
+    next.delay = delay;
+    next.dispersion = delay / 2; // Worst path asymmetry
+    next.accepted++;
+    next.synced = true;
+    state.store(next);
+    return true;
+}
+
+DisciplinedClock::Status DisciplinedClock::getStatus(int64_t local) const
+{
+    State s = state.load();
+    double remaining;
+    timeAt(s, local, remaining);
+    double age = s.synced ? (local - s.lastUpdate) * 1e-6 : INFINITY;
+    return {s.synced, s.offset, s.delay, s.dispersion + fabs(remaining) + CLOCK_DRIFT_BOUND * age,
+            s.frequency, age, s.accepted, s.rejected};
+}
+
+int64_t clockMicros()
+{
+#ifdef ESP_PLATFORM
+    return esp_timer_get_time(); // 64-bit, never wraps
+#else
+    using namespace std::chrono;
+    return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+DisciplinedClock &deviceClock()
+{
+    static DisciplinedClock clock;
+    return clock;
+}
+
+static std::atomic<int64_t> lastReceive(0);
+
+void clockMarkReceive()
+{
+    lastReceive.store(clockMicros(), std::memory_order_relaxed);
+}
+
+int64_t clockLastReceive()
+{
+    return lastReceive.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,199 @@
+#include "Command.h"
+
+namespace
+{
+    // Virtual key "w0 w1" (or "w0") against name, in compareNames order
+    int compareKey(const char *w0, const char *w1, const char *name)
+    {
+        const char *parts[3] = {w0, w1 != nullptr ? " " : "", w1 != nullptr ? w1 : ""};
+        for (const char *part : parts)
+        {
+            for (; *part != '\0'; part++, name++)
+            {
+                if (*part != *name)
+                {
+                    return (unsigned char)*part - (unsigned char)*name;
+                }
+            }
+        }
+        return -(unsigned char)*name;
+    }
+
+    bool matchesType(char type, const char *token, double &number)
+    {
+        return type == 's' || (type == 'n' && parseNumber(token, number));
+    }
+}
+
+bool parseRequestId(char *&line, uint32_t &id)
+{
+    id = 0;
+    char *p = line;
+    while (*p == ' ')
+    {
+        p++;
+    }
+    if (*p != '#')
+    {
+        return true;
+    }
+    char *end;
+    unsigned long long value = strtoull(p + 1, &end, 10);
+    if (end == p + 1 || p[1] < '0' || p[1] > '9' || (*end != ' ' && *end != '\0') || value == 0 || value > UINT32_MAX)
+    {
+        return false;
+    }
+    id = (uint32_t)value;
+    line = end;
+    return true;
+}
+
+size_t tokenize(char *line, char **tokens, size_t maxTokens)
+{
+    size_t n = 0;
+    char *p = line;
+    while (n < maxTokens)
+    {
+        while (*p == ' ')
+        {
+            p++;
+        }
+        if (*p == '\0')
+        {
+            break;
+        }
+        tokens[n++] = p;
+        if (n == maxTokens)
+        {
+            break; // Rest of the line left in the last token
+        }
+        while (*p != ' ' && *p != '\0')
+        {
+            p++;
+        }
+        if (*p == '\0')
+        {
+            break;
+        }
+        *p++ = '\0';
+    }
+    return n;
+}
+
+const CommandSpec *CommandDispatcher::find(const char *w0, const char *w1) const
+{
+    size_t low = 0, high = size;
+    while (low < high)
+    {
+        size_t mid = (low + high) / 2;
+        int cmp = compareKey(w0, w1, table[mid].name);
+        if (cmp == 0)
+        {
+            return &table[mid];
+        }
+        if (cmp < 0)
+        {
+            high = mid;
+        }
+        else
+        {
+            low = mid + 1;
+        }
+    }
+    return nullptr;
+}
+
+DispatchStatus CommandDispatcher::dispatch(char *line, const CommandSpec *&spec) const
+{
+    char *lineEnd = line;
+    while (*lineEnd != '\0')
+    {
+        lineEnd++;
+    }
+
+    // One extra slot to detect too many arguments
+    char *tokens[COMMAND_MAX_TOKENS + 1];
+    double numbers[COMMAND_MAX_TOKENS];
+    size_t count = tokenize(line, tokens, COMMAND_MAX_TOKENS + 1);
+    bool overflow = count > COMMAND_MAX_TOKENS;
+    spec = nullptr;
+    if (count == 0)
+    {
+        return DispatchStatus::EMPTY;
+    }
+
+    size_t first = 1;
+    if (count > 1)
+    {
+        spec = find(tokens[0], tokens[1]);
+        first = 2;
+    }
+    if (spec == nullptr)
+    {
+        spec = find(tokens[0], nullptr);
+        first = 1;
+    }
+    if (spec == nullptr)
+    {
+        return DispatchStatus::UNKNOWN;
+    }
+
+    // Check the arguments against the signature, parsing numbers once
+    char **args = tokens + first;
+    size_t n = count - first;
+    size_t i = 0;
+    char previous = '\0';
+    for (const char *type = spec->signature; *type != '\0'; type++)
+    {
+        if (*type == '*')
+        {
+            if (i >= n)
+            {
+                return DispatchStatus::BAD_ARGUMENTS;
+            }
+            for (char *p = args[i]; p < lineEnd; p++)
+            {
+                if (*p == '\0')
+                {
+                    *p = ' '; // Separators restored
+                }
+            }
+            n = ++i;
+            overflow = false;
+            break;
+        }
+        if (*type == '+')
+        {
+            if (i >= n)
+            {
+                return DispatchStatus::BAD_ARGUMENTS;
+            }
+            for (; i < n; i++)
+            {
+                if (!matchesType(previous, args[i], numbers[i]))
+                {
+                    return DispatchStatus::BAD_ARGUMENTS;
+                }
+            }
+            break;
+        }
+        if (i >= n || !matchesType(*type, args[i], numbers[i]))
+        {
+            return DispatchStatus::BAD_ARGUMENTS;
+        }
+        previous = *type;
+        i++;
+    }
+    if (i != n || overflow)
+    {
+        return DispatchStatus::BAD_ARGUMENTS;
+    }
+
+    CommandArgs commandArgs;
+    commandArgs.spec = spec;
+    commandArgs.tokens = args;
+    commandArgs.numbers = numbers;
+    commandArgs.n = n;
+    spec->handler(commandArgs);
+    return DispatchStatus::OK;
+}
@@ -0,0 +1,162 @@
+#include "Ephemeris.h"
+#include "utils.h"
+
+namespace
+{
+    constexpr double EARTH_EQUATORIAL_RADIUS = 6378137.0; // m, WGS84
+
+    struct BodyName
+    {
+        Body body;
+        const char *name;
+        int planet; // iauPlan94 number, 0 if not a planet
+    };
+
+    const BodyName BODIES[] = {
+        {Body::SUN, "sun", 0},
+        {Body::MOON, "moon", 0},
+        {Body::MERCURY, "mercury", 1},
+        {Body::VENUS, "venus", 2},
+        {Body::MARS, "mars", 4},
+        {Body::JUPITER, "jupiter", 5},
+        {Body::SATURN, "saturn", 6},
+        {Body::URANUS, "uranus", 7},
+        {Body::NEPTUNE, "neptune", 8},
+    };
+}
+
+const char *bodyToString(Body body)
+{
+    return BODIES[(int)body].name;
+}
+
+bool bodyFromString(const char *name, Body &body)
+{
+    for (const BodyName &entry : BODIES)
+    {
+        if (strcmp(entry.name, name) == 0)
+        {
+            body = entry.body;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool bodyPosition(Body body, double unixTime, double p[3])
+{
+    // TDB taken as TT (< 2 ms)
+    JulianDate tt;
+    if (!unixTimeToTT(unixTime, tt))
+    {
+        return false;
+    }
+
+    if (body == Body::MOON)
+    {
+        double pv[2][3];
+        iauMoon98(tt.day, tt.fraction, pv); // Light time ~1.3 s, neglected
+        iauCp(pv[0], p);
+        return true;
+    }
+
+    double ehpv[2][3], ebpv[2][3];
+    iauEpv00(tt.day, tt.fraction, ehpv, ebpv);
+    if (body == Body::SUN)
+    {
+        // The Sun moves < 10 km wrt the barycentre during the light time
+        iauSxp(-1.0, ehpv[0], p);
+        return true;
+    }
+
+    // Heliocentric planet, iauPlan94 frame is J2000 equatorial (ICRS within 0.1 arcsec)
+    double pv[2][3];
+    int status = iauPlan94(tt.day, tt.fraction, BODIES[(int)body].planet, pv);
+    if (status < 0 || status == 2)
+    {
+        return false;
+    }
+
+    // Light time : planet taken back by the geocentric distance / c
+    double geocentric[3];
+    iauPmp(pv[0], ehpv[0], geocentric);
+    double tau = iauPm(geocentric) / DC;
+    for (int i = 0; i < 3; i++)
+    {
+        p[i] = pv[0][i] - tau * pv[1][i] - ehpv[0][i];
+    }
+    return true;
+}
+
+void positionToRaDec(const double p[3], double &ra, double &dec, double &distance)
+{
+    double theta, phi;
+    iauC2s((double *)p, &theta, &phi);
+    ra = iauAnp(theta) * DR2D;
+    dec = phi * DR2D;
+    distance = iauPm((double *)p);
+}
+
+double topocentricElevation(double el, double distance)
+{
+    double sinParallax = EARTH_EQUATORIAL_RADIUS / (distance * DAU);
+    return el - asin(sinParallax * cos(el * DD2R)) * DR2D;
+}
+
+void EphemerisCache::setBody(Body newBody)
+{
+    body = newBody;
+    valid = false;
+}
+
+bool EphemerisCache::position(double unixTime, double p[3])
+{
+    if (valid && unixTime > t0 + 2 * interval && unixTime <= t0 + 3 * interval)
+    {
+        // Slides the window by one node
+        double next[3];
+        if (!bodyPosition(body, t0 + 3 * interval, next))
+        {
+            return false;
+        }
+        iauCp(nodes[1], nodes[0]);
+        iauCp(nodes[2], nodes[1]);
+        iauCp(next, nodes[2]);
+        t0 += interval;
+    }
+    else if (!valid || unixTime < t0 || unixTime > t0 + 2 * interval)
+    {
+        valid = false;
+        t0 = floor(unixTime / interval) * interval;
+        for (int k = 0; k < 3; k++)
+        {
+            if (!bodyPosition(body, t0 + k * interval, nodes[k]))
+            {
+                return false;
+            }
+        }
+        valid = true;
+    }
+
+    // Lagrange quadratic through the three nodes
+    double u = (unixTime - t0) / interval;
+    double l0 = (u - 1) * (u - 2) / 2;
+    double l1 = -u * (u - 2);
+    double l2 = u * (u - 1) / 2;
+    for (int i = 0; i < 3; i++)
+    {
+        p[i] = l0 * nodes[0][i] + l1 * nodes[1][i] + l2 * nodes[2][i];
+    }
+    return true;
+}
+
+bool EphemerisCache::raDec(double unixTime, double &ra, double &dec, double &distance)
+{
+    double p[3];
+    if (!position(unixTime, p))
+    {
+        return false;
+    }
+    positionToRaDec(p, ra, dec, distance);
+    return true;
+}
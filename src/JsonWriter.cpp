@@ -0,0 +1,212 @@
+#include "JsonWriter.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+namespace
+{
+    const uint64_t POW10[] = {1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL,
+                              1000000ULL, 10000000ULL, 100000000ULL, 1000000000ULL};
+    constexpr unsigned MAX_DECIMALS = 9;
+
+    // Digits of value into out, returns the count
+    size_t writeUnsigned(char *out, uint64_t value)
+    {
+        char digits[20];
+        size_t n = 0;
+        do
+        {
+            digits[n++] = (char)('0' + value % 10);
+            value /= 10;
+        } while (value != 0);
+        for (size_t i = 0; i < n; i++)
+        {
+            out[i] = digits[n - 1 - i];
+        }
+        return n;
+    }
+
+    // JSON escape of c into out (up to 6 bytes), returns the length
+    size_t escape(char c, char *out)
+    {
+        static const char HEX[] = "0123456789abcdef";
+        switch (c)
+        {
+        case '"':
+        case '\\':
+            out[0] = '\\';
+            out[1] = c;
+            return 2;
+        case '\n':
+            out[0] = '\\';
+            out[1] = 'n';
+            return 2;
+        case '\r':
+            out[0] = '\\';
+            out[1] = 'r';
+            return 2;
+        case '\t':
+            out[0] = '\\';
+            out[1] = 't';
+            return 2;
+        default:
+            if ((unsigned char)c < 0x20)
+            {
+                memcpy(out, "\\u00", 4);
+                out[4] = HEX[(c >> 4) & 0xf];
+                out[5] = HEX[c & 0xf];
+                return 6;
+            }
+            out[0] = c; // UTF-8 bytes pass through
+            return 1;
+        }
+    }
+}
+
+size_t formatFixed(char *out, double value, unsigned decimals)
+{
+    if (decimals > MAX_DECIMALS)
+    {
+        decimals = MAX_DECIMALS;
+    }
+    bool negative = value < 0;
+    double scaled = fabs(value) * POW10[decimals] + 0.5;
+    if (!(scaled < 9.2e18))
+    {
+        return snprintf(out, 32, "%.17g", value); // Out of fixed-point range
+    }
+
+    uint64_t units = (uint64_t)scaled;
+    char *p = out;
+    if (negative && units != 0)
+    {
+        *p++ = '-';
+    }
+    p += writeUnsigned(p, units / POW10[decimals]);
+    if (decimals > 0)
+    {
+        uint64_t fraction = units % POW10[decimals];
+        *p++ = '.';
+        for (unsigned i = decimals; i-- > 0;)
+        {
+            p[i] = (char)('0' + fraction % 10);
+            fraction /= 10;
+        }
+        p += decimals;
+    }
+    *p = '\0';
+    return p - out;
+}
+
+JsonWriter::JsonWriter(char *buffer, size_t size)
+    : buffer(buffer), size(size), used(0), depth(0), first(true), overflow(size == 0), cut(false)
+{
+    if (size > 0)
+    {
+        buffer[0] = '\0';
+    }
+}
+
+void JsonWriter::put(char c)
+{
+    put(&c, 1);
+}
+
+void JsonWriter::put(const char *str, size_t length)
+{
+    if (overflow || used + length >= size)
+    {
+        overflow = true;
+        return;
+    }
+    memcpy(buffer + used, str, length);
+    used += length;
+    buffer[used] = '\0';
+}
+
+void JsonWriter::separator()
+{
+    if (!first)
+    {
+        put(',');
+    }
+    first = false;
+}
+
+JsonWriter &JsonWriter::beginObject()
+{
+    put('{');
+    depth++;
+    first = true;
+    return *this;
+}
+
+JsonWriter &JsonWriter::endObject()
+{
+    put('}');
+    depth--;
+    first = false;
+    return *this;
+}
+
+JsonWriter &JsonWriter::key(const char *name)
+{
+    separator();
+    put('"');
+    put(name, strlen(name));
+    put("\":", 2);
+    return *this;
+}
+
+JsonWriter &JsonWriter::string(const char *value, bool truncate)
+{
+    put('"');
+    // Room kept for the closing quote, the '}' owed and '\0'
+    size_t reserve = 2 + depth;
+    size_t limit = size > reserve ? size - reserve : 0;
+    char sequence[6];
+    for (const char *c = value; *c != '\0' && !overflow; c++)
+    {
+        size_t n = escape(*c, sequence);
+        unsigned char lead = (unsigned char)*c;
+        size_t whole = lead >= 0xf0 ? 4 : lead >= 0xe0 ? 3 : lead >= 0xc0 ? 2 : n; // Never cut a UTF-8 sequence
+        if (used + whole > limit)
+        {
+            if (truncate)
+            {
+                cut = true;
+                break;
+            }
+            overflow = true;
+            return *this;
+        }
+        put(sequence, n);
+    }
+    put('"');
+    return *this;
+}
+
+JsonWriter &JsonWriter::number(double value, unsigned decimals)
+{
+    if (!isfinite(value))
+    {
+        put("null", 4);
+        return *this;
+    }
+    char digits[32];
+    put(digits, formatFixed(digits, value, decimals));
+    return *this;
+}
+
+JsonWriter &JsonWriter::integer(int64_t value)
+{
+    char digits[24];
+    size_t n = 0;
+    if (value < 0)
+    {
+        digits[n++] = '-';
+    }
+    n += writeUnsigned(digits + n, value < 0 ? 0 - (uint64_t)value : (uint64_t)value);
+    put(digits, n);
+    return *this;
+}
@@ -0,0 +1,24 @@
+#include "Log.h"
+
+bool LogRateLimiter::allow(uint32_t now, uint32_t &suppressedCount)
+{
+    uint32_t deadline = next.load(std::memory_order_relaxed);
+    uint32_t following = (now + interval) | 1; // Never 0, at most 1 ms late
+    if ((deadline != 0 && (int32_t)(now - deadline) < 0) ||
+        !next.compare_exchange_strong(deadline, following, std::memory_order_relaxed))
+    {
+        suppressed.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    suppressedCount = suppressed.exchange(0, std::memory_order_relaxed);
+    return true;
+}
+
+String withSuppressedCount(const String &msg, uint32_t count)
+{
+    if (count == 0)
+    {
+        return msg;
+    }
+    return msg + " (suppressed " + String(count) + " times)";
+}
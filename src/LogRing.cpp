@@ -0,0 +1,119 @@
+#include "LogRing.h"
+#include <string.h>
+
+namespace
+{
+    constexpr uint32_t HEADER_SIZE = 4;
+
+    uint32_t recordSize(uint32_t length)
+    {
+        return HEADER_SIZE + ((length + 3) & ~3u);
+    }
+}
+
+LogRing::LogRing(uint8_t *buffer, size_t capacity)
+    : buffer(buffer), mask(capacity - 1), head(0), tail(0), readOffset(0),
+      written(0), dropped(0), droppedBytes(0), highWater(0)
+{
+}
+
+uint32_t *LogRing::header(uint32_t position) const
+{
+    return reinterpret_cast<uint32_t *>(buffer + (position & mask));
+}
+
+void LogRing::copyIn(uint32_t position, const void *data, size_t length)
+{
+    uint32_t index = position & mask;
+    size_t first = length < mask + 1 - index ? length : mask + 1 - index;
+    memcpy(buffer + index, data, first);
+    memcpy(buffer, static_cast<const uint8_t *>(data) + first, length - first);
+}
+
+void LogRing::copyOut(uint32_t position, void *out, size_t length) const
+{
+    uint32_t index = position & mask;
+    size_t first = length < mask + 1 - index ? length : mask + 1 - index;
+    memcpy(out, buffer + index, first);
+    memcpy(static_cast<uint8_t *>(out) + first, buffer, length - first);
+}
+
+bool LogRing::push(const char *data, size_t length, bool endLine)
+{
+    uint32_t total = length + (endLine ? 2 : 0);
+    uint32_t size = recordSize(total);
+    if (total == 0)
+    {
+        return true;
+    }
+
+    uint32_t position = head.load(std::memory_order_relaxed);
+    uint32_t used;
+    do
+    {
+        used = position + size - tail.load(std::memory_order_acquire);
+        if (used > mask + 1)
+        {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            droppedBytes.fetch_add(total, std::memory_order_relaxed);
+            return false;
+        }
+    } while (!head.compare_exchange_weak(position, position + size,
+                                         std::memory_order_acq_rel, std::memory_order_relaxed));
+
+    // The reserved span is ours alone until published
+    copyIn(position + HEADER_SIZE, data, length);
+    if (endLine)
+    {
+        copyIn(position + HEADER_SIZE + length, "\r\n", 2);
+    }
+    __atomic_store_n(header(position), total, __ATOMIC_RELEASE);
+
+    written.fetch_add(1, std::memory_order_relaxed);
+    uint32_t high = highWater.load(std::memory_order_relaxed);
+    while (used > high && !highWater.compare_exchange_weak(high, used, std::memory_order_relaxed))
+    {
+    }
+    return true;
+}
+
+size_t LogRing::pop(uint8_t *out, size_t size)
+{
+    size_t n = 0;
+    uint32_t position = tail.load(std::memory_order_relaxed);
+    while (n < size)
+    {
+        uint32_t length = __atomic_load_n(header(position), __ATOMIC_ACQUIRE);
+        if (length == 0)
+        {
+            break; // Empty, or the next record is not yet published
+        }
+
+        uint32_t chunk = length - readOffset;
+        chunk = chunk < size - n ? chunk : size - n;
+        copyOut(position + HEADER_SIZE + readOffset, out + n, chunk);
+        n += chunk;
+        readOffset += chunk;
+        if (readOffset < length)
+        {
+            break; // out is full
+        }
+
+        // Zeroed before release, so that any later header reads as unpublished
+        uint32_t recordLength = recordSize(length);
+        uint32_t index = position & mask;
+        size_t first = recordLength < mask + 1 - index ? recordLength : mask + 1 - index;
+        memset(buffer + index, 0, first);
+        memset(buffer, 0, recordLength - first);
+        readOffset = 0;
+        position += recordLength;
+        tail.store(position, std::memory_order_release);
+    }
+    return n;
+}
+
+LogRing::Stats LogRing::getStats() const
+{
+    return {written.load(std::memory_order_relaxed), dropped.load(std::memory_order_relaxed),
+            droppedBytes.load(std::memory_order_relaxed), highWater.load(std::memory_order_relaxed)};
+}
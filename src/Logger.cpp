@@ -0,0 +1,91 @@
+#include "Logger.h"
+#include "define.h"
+
+alignas(4) static uint8_t logBuffer[LOG_BUFFER_SIZE];
+static LogRing logRing(logBuffer, sizeof(logBuffer));
+static SerialTransport *logTransport = nullptr;
+static TaskHandle_t logTaskHandle = nullptr;
+static std::atomic<LogComposer> logComposer(nullptr); // Pending, see logComposed
+
+static_assert((LOG_BUFFER_SIZE & (LOG_BUFFER_SIZE - 1)) == 0, "LOG_BUFFER_SIZE must be a power of 2");
+
+static void logTask(void *parameters)
+{
+    uint8_t chunk[LOG_TX_CHUNK];
+    while (true)
+    {
+        // A composed message goes out first, as late as possible
+        LogComposer compose = logComposer.load(std::memory_order_acquire);
+        if (compose != nullptr && logRing.atRecordStart())
+        {
+            size_t n = compose(chunk, sizeof(chunk));
+            logComposer.store(nullptr, std::memory_order_release);
+            if (n > 0)
+            {
+                logTransport->write(chunk, n);
+            }
+            continue;
+        }
+
+        // Everything published so far, in chunks : messages queued while
+        // the previous write was in progress go out together
+        size_t n = logRing.pop(chunk, sizeof(chunk));
+        if (n > 0)
+        {
+            logTransport->write(chunk, n);
+            continue;
+        }
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+}
+
+void startLogger(SerialTransport &transport)
+{
+    if (logTaskHandle != nullptr)
+    {
+        return;
+    }
+    logTransport = &transport;
+    xTaskCreate(logTask, "Logger", LOG_TASK_STACK, nullptr, 0, &logTaskHandle);
+}
+
+static bool logPush(const char *data, size_t length, bool endLine)
+{
+    bool queued = logRing.push(data, length, endLine);
+    TaskHandle_t task = logTaskHandle;
+    if (queued && task != nullptr)
+    {
+        xTaskNotifyGive(task);
+    }
+    return queued;
+}
+
+bool logLine(const char *data, size_t length)
+{
+    return logPush(data, length, true);
+}
+
+bool logWrite(const uint8_t *data, size_t length)
+{
+    return logPush(reinterpret_cast<const char *>(data), length, false);
+}
+
+bool logComposed(LogComposer compose)
+{
+    LogComposer none = nullptr;
+    if (!logComposer.compare_exchange_strong(none, compose))
+    {
+        return false;
+    }
+    TaskHandle_t task = logTaskHandle;
+    if (task != nullptr)
+    {
+        xTaskNotifyGive(task);
+    }
+    return true;
+}
+
+LogRing::Stats getLogStats()
+{
+    return logRing.getStats();
+}
@@ -1,6 +1,23 @@
 #include "Message.h"
+#include "Logger.h"
+#include "JsonWriter.h"
+#include "Protocol.h"
+#include "Topics.h"
+#include <atomic>
 
-String Message::typeToString() const
+static thread_local uint32_t currentRequestId = REQUEST_ID_NONE;
+
+void setRequestId(uint32_t id)
+{
+    currentRequestId = id;
+}
+
+uint32_t getRequestId()
+{
+    return currentRequestId;
+}
+
+const char *Message::typeToString() const
 {
     switch (type)
     {
@@ -12,21 +29,83 @@ String Message::typeToString() const
         return "ACKNOWLEDGEMENT";
     case MsgType::TIMESTAMP:
         return "TIMESTAMP";
+    case MsgType::EVENT:
+        return "EVENT";
     default:
         return "UNKNOWN";
     }
 }
 
-String Message::format() const
+size_t Message::format(char *buffer, size_t size) const
 {
-    return "{type: \"" + typeToString() +
-           "\", status: \"" + status +
-           "\", payload: \"" + payload +
-           "\", timestamp: \"" + getCurrentTimestamp() + "\"}";
+    // Fixed-size members first : only the text payload, last, can be cut
+    JsonWriter json(buffer, size);
+    json.beginObject().key("type").string(typeToString());
+    if (requestId != REQUEST_ID_NONE)
+    {
+        json.key("id").integer(requestId);
+    }
+    json.key("status")
+        .string(errorTypeToString(status))
+        .key("timestamp")
+        .number(timestamp, 6)
+        .key("payload");
+    if (text != nullptr)
+    {
+        json.string(text, true);
+    }
+    else if (type == MsgType::POSITION)
+    {
+        json.beginObject().key("azimuth").number(az, 2).key("elevation").number(elev, 2).endObject();
+    }
+    else
+    {
+        json.number(timestamp, 6);
+    }
+    json.endObject();
+    return json.length();
+}
+
+size_t Message::encode(uint8_t *buffer, size_t size) const
+{
+    size_t header = 1 + sizeof(double);
+    if (size < header + sizeof(uint32_t) + 2 * sizeof(float))
+    {
+        return 0;
+    }
+    buffer[0] = (uint8_t)type | (uint8_t)status << 4;
+    memcpy(buffer + 1, &timestamp, sizeof(double)); // Little-endian target
+    if (requestId != REQUEST_ID_NONE)
+    {
+        buffer[0] |= FRAME_FLAG_REQUEST_ID;
+        memcpy(buffer + header, &requestId, sizeof(uint32_t));
+        header += sizeof(uint32_t);
+    }
+    if (text != nullptr)
+    {
+        size_t length = strlen(text);
+        if (length > size - header)
+        {
+            length = size - header;
+            while (length > 0 && ((uint8_t)text[length] & 0xc0) == 0x80)
+            {
+                length--; // Never cut a UTF-8 sequence
+            }
+        }
+        memcpy(buffer + header, text, length);
+        return header + length;
+    }
+    if (type == MsgType::POSITION)
+    {
+        memcpy(buffer + header, &az, sizeof(float));
+        memcpy(buffer + header + sizeof(float), &elev, sizeof(float));
+        return header + 2 * sizeof(float);
+    }
+    return header;
 }
 
 // Utility to convert ErrorType to string
-String errorTypeToString(ErrorType type)
+const char *errorTypeToString(ErrorType type)
 {
     switch (type)
     {
@@ -41,22 +120,60 @@ String errorTypeToString(ErrorType type)
     }
 }
 
+// Formats on the stack, then queues for the logger task
+static void emit(const Message &msg)
+{
+    if (getProtocolMode() == ProtocolMode::BINARY)
+    {
+        uint8_t frame[frameOverhead(MESSAGE_MAX) + MESSAGE_MAX];
+        size_t length = msg.encode(frame + frameHeadroom(MESSAGE_MAX), MESSAGE_MAX);
+        logWrite(frame, encodeFrame(frame, length, MESSAGE_MAX));
+        return;
+    }
+
+    char line[MESSAGE_MAX];
+    size_t length = msg.format(line, sizeof(line));
+    if (length > 0)
+    {
+        logLine(line, length);
+    }
+}
+
+// Log messages, dropped unless their topic is subscribed (see Topics.h)
+static int logLevel(ErrorType status)
+{
+    return status == ErrorType::ERROR ? LOG_LEVEL_ERROR : status == ErrorType::WARNING ? LOG_LEVEL_WARNING
+                                                                                       : LOG_LEVEL_INFO;
+}
+
 // Example print functions
 void print_msg(const ErrorStatus &err, const MsgType &type)
 {
-    Message msg(type, err.msg, errorTypeToString(err.type));
-    HWSerial.println(msg.format());
+    if (isLogSubscribed(logLevel(err.type)))
+    {
+        emit(Message(type, err.type, err.msg.c_str(), getCurrentTime()));
+    }
+}
+
+void print_debug(const String &debug, const MsgType &type)
+{
+    if (isLogSubscribed(LOG_LEVEL_DEBUG))
+    {
+        emit(Message(type, ErrorType::NONE, ("DEBUG : " + debug).c_str(), getCurrentTime()));
+    }
 }
 
 void print_info(const String &info, const MsgType &type)
 {
-    ErrorStatus status(ErrorType::NONE, info);
-    print_msg(status, type);
+    if (isLogSubscribed(LOG_LEVEL_INFO))
+    {
+        emit(Message(type, ErrorType::NONE, info.c_str(), getCurrentTime()));
+    }
 }
 
 void print_acknowledgement(const String &msg, const ErrorType &status)
 {
-    print_msg(ErrorStatus(status, msg), MsgType::ACKNOWLEDGEMENT);
+    emit(Message(MsgType::ACKNOWLEDGEMENT, status, msg.c_str(), getCurrentTime(), currentRequestId));
 }
 
 void print_acknowledgement_error(const String &msg)
@@ -64,36 +181,102 @@ void print_acknowledgement_error(const String &msg)
     print_acknowledgement(msg, ErrorType::ERROR);
 }
 
+// Pending stamped acknowledgement, read by the logger task
+static std::atomic<bool> stampedPending(false);
+static char stampedText[STAMPED_TEXT_MAX];
+static uint32_t stampedRequestId;
+static void (*stampedCallback)(double time);
+
+// Run by the logger task right before the write : a frame in binary mode,
+// a line otherwise
+static size_t composeStamped(uint8_t *out, size_t size)
+{
+    double now = getCurrentTime();
+    char text[STAMPED_TEXT_MAX + 32];
+    size_t length = strlen(stampedText);
+    memcpy(text, stampedText, length);
+    formatFixed(text + length, now, 6);
+    Message msg(MsgType::ACKNOWLEDGEMENT, ErrorType::NONE, text, now, stampedRequestId);
+    stampedCallback(now);
+
+    if (getProtocolMode() == ProtocolMode::BINARY)
+    {
+        size_t max = size - frameOverhead(size);
+        length = msg.encode(out + frameHeadroom(max), max);
+        length = length > 0 ? encodeFrame(out, length, max) : 0;
+    }
+    else
+    {
+        length = msg.format(reinterpret_cast<char *>(out), size - 2);
+        if (length > 0)
+        {
+            memcpy(out + length, "\r\n", 2);
+            length += 2;
+        }
+    }
+    stampedPending.store(false, std::memory_order_release);
+    return length;
+}
+
+bool print_acknowledgement_stamped(const char *text, void (*stamped)(double time))
+{
+    if (stampedPending.exchange(true, std::memory_order_acquire))
+    {
+        return false;
+    }
+    strncpy(stampedText, text, sizeof(stampedText) - 1);
+    stampedText[sizeof(stampedText) - 1] = '\0';
+    stampedRequestId = currentRequestId;
+    stampedCallback = stamped;
+    if (!logComposed(composeStamped))
+    {
+        stampedPending = false;
+        return false;
+    }
+    return true;
+}
+
+void print_event(const char *event, uint32_t requestId, const ErrorType &status, double timestamp)
+{
+    emit(Message(MsgType::EVENT, status, event, timestamp, requestId));
+}
+
 void print_warning(const String &warning, const MsgType &type)
 {
-    ErrorStatus status(ErrorType::WARNING, warning);
-    print_msg(status, type);
+    if (isLogSubscribed(LOG_LEVEL_WARNING))
+    {
+        emit(Message(type, ErrorType::WARNING, warning.c_str(), getCurrentTime()));
+    }
 }
 
 void print_error(const String &error, const MsgType &type)
 {
-    ErrorStatus status(ErrorType::ERROR, error);
-    print_msg(status, type);
+    if (isLogSubscribed(LOG_LEVEL_ERROR))
+    {
+        emit(Message(type, ErrorType::ERROR, error.c_str(), getCurrentTime()));
+    }
 }
 
-void print_position(float az, float elev, const ErrorStatus &err)
+void print_position(float az, float elev, const ErrorStatus &err, double timestamp)
 {
-    String payload = (err.type != ErrorType::ERROR)
-                         ? "{azimuth: " + String(az) + ", elevation: " + String(elev) + "}"
-                         : err.msg;
-    ErrorStatus status(err);
     if (err.type != ErrorType::ERROR)
     {
-        status.msg = payload;
+        emit(Message(az, elev, err.type, timestamp));
+    }
+    else
+    {
+        emit(Message(MsgType::POSITION, err.type, err.msg.c_str(), timestamp));
     }
-    print_msg(status, MsgType::POSITION);
 }
 
-void print_timestamp(String timestamp)
+void print_timestamp(double timestamp)
 {
-    ErrorStatus status;
-    status.msg = timestamp;
-    print_msg(status, MsgType::TIMESTAMP);
+    emit(Message(MsgType::TIMESTAMP, ErrorType::NONE, nullptr, timestamp));
+}
+
+void print_timing(const String &stats)
+{
+    emit(Message(MsgType::GENERIC, ErrorType::NONE, stats.c_str(), getCurrentTime()));
 }
 
 void print_msg_filtered(const ErrorStatus &err, const MsgType &type)
@@ -103,4 +286,4 @@ void print_msg_filtered(const ErrorStatus &err, const MsgType &type)
     {
         print_msg(err, type);
     }
-}
\ No newline at end of file
+}
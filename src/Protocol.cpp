@@ -0,0 +1,113 @@
+#include "Protocol.h"
+#include <atomic>
+#include <string.h>
+
+static std::atomic<ProtocolMode> protocolMode(ProtocolMode::TEXT);
+
+ProtocolMode getProtocolMode()
+{
+    return protocolMode.load(std::memory_order_relaxed);
+}
+
+void setProtocolMode(ProtocolMode mode)
+{
+    protocolMode.store(mode, std::memory_order_relaxed);
+}
+
+const char *protocolModeToString(ProtocolMode mode)
+{
+    return mode == ProtocolMode::BINARY ? "binary" : "text";
+}
+
+bool protocolModeFromString(const char *name, ProtocolMode &mode)
+{
+    if (strcmp(name, "text") == 0)
+    {
+        mode = ProtocolMode::TEXT;
+        return true;
+    }
+    if (strcmp(name, "binary") == 0)
+    {
+        mode = ProtocolMode::BINARY;
+        return true;
+    }
+    return false;
+}
+
+// CRC-16/CCITT-FALSE : polynomial 0x1021, initial value 0xffff
+uint16_t crc16(const uint8_t *data, size_t length, uint16_t crc)
+{
+    for (size_t i = 0; i < length; i++)
+    {
+        crc ^= (uint16_t)data[i] << 8;
+        for (int bit = 0; bit < 8; bit++)
+        {
+            crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+size_t encodeFrame(uint8_t *buffer, size_t length, size_t maxLength)
+{
+    uint8_t *in = buffer + frameHeadroom(maxLength);
+    uint16_t crc = crc16(in, length);
+    in[length] = crc & 0xff;
+    in[length + 1] = crc >> 8;
+    length += FRAME_CRC_SIZE;
+
+    // COBS : each block starts with the offset to the next zero. Writes stay
+    // behind reads thanks to the headroom, so it runs in place.
+    size_t write = 1, codeIndex = 0;
+    uint8_t code = 1;
+    for (size_t read = 0; read < length; read++)
+    {
+        uint8_t byte = in[read];
+        if (byte == 0)
+        {
+            buffer[codeIndex] = code;
+            code = 1;
+            codeIndex = write++;
+            continue;
+        }
+        buffer[write++] = byte;
+        if (++code == 0xff)
+        {
+            buffer[codeIndex] = code; // Full block, no zero implied
+            code = 1;
+            codeIndex = write++;
+        }
+    }
+    buffer[codeIndex] = code;
+    buffer[write++] = 0; // Delimiter
+    return write;
+}
+
+int decodeFrame(uint8_t *frame, size_t length)
+{
+    size_t read = 0, write = 0;
+    while (read < length)
+    {
+        uint8_t code = frame[read++];
+        if (code == 0 || read + code - 1 > length)
+        {
+            return -1;
+        }
+        for (uint8_t i = 1; i < code; i++)
+        {
+            frame[write++] = frame[read++];
+        }
+        if (code != 0xff && read < length)
+        {
+            frame[write++] = 0;
+        }
+    }
+
+    if (write < FRAME_CRC_SIZE)
+    {
+        return -1;
+    }
+    size_t payload = write - FRAME_CRC_SIZE;
+    uint16_t crc = frame[payload] | frame[payload + 1] << 8;
+    return crc == crc16(frame, payload) ? (int)payload : -1;
+}
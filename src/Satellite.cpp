@@ -0,0 +1,937 @@
+#include "Satellite.h"
+#include "utils.h"
+
+// WGS-72 constants, as used to generate the TLEs
+namespace
+{
+    constexpr double EARTH_RADIUS = 6378.135; // km
+    constexpr double EARTH_MU = 398600.8;     // km3 / s2
+    constexpr double J2 = 0.001082616;
+    constexpr double J3 = -0.00000253881;
+    constexpr double J4 = -0.00000165597;
+    constexpr double J3OJ2 = J3 / J2;
+    constexpr double X2O3 = 2.0 / 3.0;
+    constexpr double TEMP4 = 1.5e-12;
+    constexpr double DEEP_SPACE_PERIOD = 225.0;      // Minutes
+    constexpr double ZNS = 1.19459e-5;               // Solar mean motion, rad/min
+    constexpr double ZES = 0.01675;                  // Solar eccentricity
+    constexpr double ZNL = 1.5835218e-4;             // Lunar mean motion, rad/min
+    constexpr double ZEL = 0.05490;                  // Lunar eccentricity
+    constexpr double RPTIM = 4.37526908801129966e-3; // Earth rotation, rad/min
+    constexpr double EARTH_ROTATION_RATE = 7.292115146706979e-5; // rad/s, GMST rate
+    const double XKE = 60.0 / sqrt(EARTH_RADIUS * EARTH_RADIUS * EARTH_RADIUS / EARTH_MU);
+    const double VKMPERSEC = EARTH_RADIUS * XKE / 60.0;
+
+    // Copies the 1-based columns [first, last] of line into buffer
+    const char *field(const char *line, int first, int last, char *buffer)
+    {
+        int length = last - first + 1;
+        memcpy(buffer, line + first - 1, length);
+        buffer[length] = '\0';
+        return buffer;
+    }
+
+    // Fixed-point field with an assumed leading decimal point and a signed
+    // exponent, e.g. " 28098-4" = 0.28098e-4
+    double assumedDecimal(const char *line, int first, int last)
+    {
+        char mantissa[16], exponent[4];
+        field(line, first + 1, last - 2, mantissa);
+        field(line, last - 1, last, exponent);
+        double value = atof(mantissa) * pow(10.0, -(double)strlen(mantissa)) * pow(10.0, atoi(exponent));
+        return line[first - 1] == '-' ? -value : value;
+    }
+
+    // Earth-fixed position (km) and local frame of the observatory
+    struct ObserverFrame
+    {
+        double position[3];
+        double sinLat, cosLat, sinLon, cosLon;
+
+        ObserverFrame()
+        {
+            iauGd2gc(WGS84, OBS_LON * DD2R, OBS_LAT * DD2R, OBS_HEIGHT, position);
+            iauSxp(1e-3, position, position);
+            sinLat = sin(OBS_LAT * DD2R);
+            cosLat = cos(OBS_LAT * DD2R);
+            sinLon = sin(OBS_LON * DD2R);
+            cosLon = cos(OBS_LON * DD2R);
+        }
+
+        // Earth-fixed vector to East / North / Up
+        void toLocal(const double p[3], double local[3]) const
+        {
+            local[0] = -sinLon * p[0] + cosLon * p[1];
+            local[1] = -sinLat * cosLon * p[0] - sinLat * sinLon * p[1] + cosLat * p[2];
+            local[2] = cosLat * cosLon * p[0] + cosLat * sinLon * p[1] + sinLat * p[2];
+        }
+    };
+
+    // Modulo 10 checksum : digits count for their value, minus signs for 1
+    bool validChecksum(const char *line)
+    {
+        int sum = 0;
+        for (int i = 0; i < 68; i++)
+        {
+            if (line[i] >= '0' && line[i] <= '9')
+            {
+                sum += line[i] - '0';
+            }
+            else if (line[i] == '-')
+            {
+                sum += 1;
+            }
+        }
+        return line[68] - '0' == sum % 10;
+    }
+}
+
+bool parseTLE(const char *line1, const char *line2, TLE &tle, const char *name)
+{
+    if (strlen(line1) < 69 || strlen(line2) < 69 || line1[0] != '1' || line2[0] != '2')
+    {
+        return false;
+    }
+    if (!validChecksum(line1) || !validChecksum(line2))
+    {
+        return false;
+    }
+
+    char buffer[16];
+    tle.satnum = atol(field(line1, 3, 7, buffer));
+    if (tle.satnum != (uint32_t)atol(field(line2, 3, 7, buffer)))
+    {
+        return false;
+    }
+
+    // Epoch : two-digit year (57-99 -> 19xx) and fractional day of year
+    int year = atoi(field(line1, 19, 20, buffer));
+    year += year < 57 ? 2000 : 1900;
+    double day = atof(field(line1, 21, 32, buffer));
+    double djm0, djm;
+    if (iauCal2jd(year, 1, 1, &djm0, &djm) != 0)
+    {
+        return false;
+    }
+    tle.epoch = (djm0 + djm - UNIX_EPOCH_JD + day - 1) * SECONDS_IN_DAY;
+
+    tle.bstar = assumedDecimal(line1, 54, 61);
+    tle.inclo = atof(field(line2, 9, 16, buffer)) * DD2R;
+    tle.nodeo = atof(field(line2, 18, 25, buffer)) * DD2R;
+    tle.ecco = atof(field(line2, 27, 33, buffer)) * 1e-7;
+    tle.argpo = atof(field(line2, 35, 42, buffer)) * DD2R;
+    tle.mo = atof(field(line2, 44, 51, buffer)) * DD2R;
+    tle.no_kozai = atof(field(line2, 53, 63, buffer)) * D2PI / 1440.0; // rev/day -> rad/min
+
+    tle.name[0] = '\0';
+    if (name != nullptr)
+    {
+        strncpy(tle.name, name, TLE_NAME_LENGTH);
+        tle.name[TLE_NAME_LENGTH] = '\0';
+    }
+    return true;
+}
+
+bool Sgp4::init(const TLE &tle)
+{
+    elements = tle;
+    status = NOT_INITIALIZED;
+
+    const double ecco = tle.ecco, inclo = tle.inclo, argpo = tle.argpo, bstar = tle.bstar;
+    if (ecco < 0 || ecco >= 1)
+    {
+        status = ECCENTRICITY;
+        return false;
+    }
+    if (tle.no_kozai <= 0)
+    {
+        status = MEAN_MOTION;
+        return false;
+    }
+
+    // Un-Kozai the mean motion (initl)
+    double eccsq = ecco * ecco;
+    double omeosq = 1.0 - eccsq;
+    double rteosq = sqrt(omeosq);
+    double cosio = cos(inclo);
+    double cosio2 = cosio * cosio;
+    double ak = pow(XKE / tle.no_kozai, X2O3);
+    double d1 = 0.75 * J2 * (3.0 * cosio2 - 1.0) / (rteosq * omeosq);
+    double del = d1 / (ak * ak);
+    double adel = ak * (1.0 - del * del - del * (1.0 / 3.0 + 134.0 * del * del / 81.0));
+    del = d1 / (adel * adel);
+    no_unkozai = tle.no_kozai / (1.0 + del);
+
+    deepSpace = D2PI / no_unkozai >= DEEP_SPACE_PERIOD;
+
+    double ao = pow(XKE / no_unkozai, X2O3);
+    double sinio = sin(inclo);
+    double po = ao * omeosq;
+    double con42 = 1.0 - 5.0 * cosio2;
+    con41 = -con42 - cosio2 - cosio2;
+    double posq = po * po;
+    double rp = ao * (1.0 - ecco);
+
+    // Perigees below 220 km, and deep space, use a truncated drag model
+    isimp = deepSpace || rp < 220.0 / EARTH_RADIUS + 1.0;
+
+    // Atmospheric density parameter, adjusted for perigees below 156 km
+    double sfour = 78.0 / EARTH_RADIUS + 1.0;
+    double qzms24 = pow((120.0 - 78.0) / EARTH_RADIUS, 4);
+    double perige = (rp - 1.0) * EARTH_RADIUS;
+    if (perige < 156.0)
+    {
+        sfour = perige < 98.0 ? 20.0 : perige - 78.0;
+        qzms24 = pow((120.0 - sfour) / EARTH_RADIUS, 4);
+        sfour = sfour / EARTH_RADIUS + 1.0;
+    }
+
+    double pinvsq = 1.0 / posq;
+    double tsi = 1.0 / (ao - sfour);
+    eta = ao * ecco * tsi;
+    double etasq = eta * eta;
+    double eeta = ecco * eta;
+    double psisq = fabs(1.0 - etasq);
+    double coef = qzms24 * pow(tsi, 4);
+    double coef1 = coef / pow(psisq, 3.5);
+    double cc2 = coef1 * no_unkozai *
+                 (ao * (1.0 + 1.5 * etasq + eeta * (4.0 + etasq)) +
+                  0.375 * J2 * tsi / psisq * con41 * (8.0 + 3.0 * etasq * (8.0 + etasq)));
+    cc1 = bstar * cc2;
+    double cc3 = ecco > 1.0e-4 ? -2.0 * coef * tsi * J3OJ2 * no_unkozai * sinio / ecco : 0.0;
+    x1mth2 = 1.0 - cosio2;
+    cc4 = 2.0 * no_unkozai * coef1 * ao * omeosq *
+          (eta * (2.0 + 0.5 * etasq) + ecco * (0.5 + 2.0 * etasq) -
+           J2 * tsi / (ao * psisq) *
+               (-3.0 * con41 * (1.0 - 2.0 * eeta + etasq * (1.5 - 0.5 * eeta)) +
+                0.75 * x1mth2 * (2.0 * etasq - eeta * (1.0 + etasq)) * cos(2.0 * argpo)));
+    cc5 = 2.0 * coef1 * ao * omeosq * (1.0 + 2.75 * (etasq + eeta) + eeta * etasq);
+
+    // Secular rates of the mean elements
+    double cosio4 = cosio2 * cosio2;
+    double temp1 = 1.5 * J2 * pinvsq * no_unkozai;
+    double temp2 = 0.5 * temp1 * J2 * pinvsq;
+    double temp3 = -0.46875 * J4 * pinvsq * pinvsq * no_unkozai;
+    mdot = no_unkozai + 0.5 * temp1 * rteosq * con41 +
+           0.0625 * temp2 * rteosq * (13.0 - 78.0 * cosio2 + 137.0 * cosio4);
+    argpdot = -0.5 * temp1 * con42 + 0.0625 * temp2 * (7.0 - 114.0 * cosio2 + 395.0 * cosio4) +
+              temp3 * (3.0 - 36.0 * cosio2 + 49.0 * cosio4);
+    double xhdot1 = -temp1 * cosio;
+    nodedot = xhdot1 + (0.5 * temp2 * (4.0 - 19.0 * cosio2) + 2.0 * temp3 * (3.0 - 7.0 * cosio2)) * cosio;
+
+    omgcof = bstar * cc3 * cos(argpo);
+    xmcof = ecco > 1.0e-4 ? -X2O3 * coef * bstar / eeta : 0.0;
+    nodecf = 3.5 * omeosq * xhdot1 * cc1;
+    t2cof = 1.5 * cc1;
+    // Avoids a division by zero for 180 deg inclinations
+    xlcof = -0.25 * J3OJ2 * sinio * (3.0 + 5.0 * cosio) /
+            (fabs(cosio + 1.0) > TEMP4 ? 1.0 + cosio : TEMP4);
+    aycof = -0.5 * J3OJ2 * sinio;
+    delmo = pow(1.0 + eta * cos(tle.mo), 3);
+    sinmao = sin(tle.mo);
+    x7thm1 = 7.0 * cosio2 - 1.0;
+
+    if (deepSpace)
+    {
+        initDeepSpace(eccsq, argpdot + nodedot);
+    }
+
+    d2 = d3 = d4 = t3cof = t4cof = t5cof = 0.0;
+    if (!isimp)
+    {
+        double cc1sq = cc1 * cc1;
+        d2 = 4.0 * ao * tsi * cc1sq;
+        double temp = d2 * tsi * cc1 / 3.0;
+        d3 = (17.0 * ao + sfour) * temp;
+        d4 = 0.5 * temp * ao * tsi * (221.0 * ao + 31.0 * sfour) * cc1;
+        t3cof = d2 + 2.0 * cc1sq;
+        t4cof = 0.25 * (3.0 * d3 + cc1 * (12.0 * d2 + 10.0 * cc1sq));
+        t5cof = 0.2 * (3.0 * d4 + 12.0 * cc1 * d3 + 6.0 * d2 * d2 + 15.0 * cc1sq * (2.0 * d2 + cc1sq));
+    }
+
+    // Validates the element set at its epoch
+    status = OK;
+    double r[3], v[3];
+    status = propagate(0.0, r, v);
+    return status == OK;
+}
+
+// Lunar-solar coefficients and resonance terms at the epoch (dscom and
+// dsinit of the Vallado et al. 2006 code, with tc = 0)
+void Sgp4::initDeepSpace(double eccsq, double xpidot)
+{
+    const double C1SS = 2.9864797e-6, C1L = 4.7968065e-7;
+    const double ZSINIS = 0.39785416, ZCOSIS = 0.91744867, ZCOSGS = 0.1945905, ZSINGS = -0.98088458;
+    const double em = elements.ecco, nm = no_unkozai;
+    DeepSpace &d = deep;
+
+    // dscom
+    double snodm = sin(elements.nodeo), cnodm = cos(elements.nodeo);
+    double sinomm = sin(elements.argpo), cosomm = cos(elements.argpo);
+    double sinim = sin(elements.inclo), cosim = cos(elements.inclo);
+    double emsq = em * em;
+    double betasq = 1.0 - emsq;
+    double rtemsq = sqrt(betasq);
+
+    double day = elements.epoch / SECONDS_IN_DAY + (UNIX_EPOCH_JD - 2433281.5) + 18261.5; // Days from 1900 Jan 0.5
+    double xnodce = fmod(4.5236020 - 9.2422029e-4 * day, D2PI);
+    double stem = sin(xnodce), ctem = cos(xnodce);
+    double zcosil = 0.91375164 - 0.03568096 * ctem;
+    double zsinil = sqrt(1.0 - zcosil * zcosil);
+    double zsinhl = 0.089683511 * stem / zsinil;
+    double zcoshl = sqrt(1.0 - zsinhl * zsinhl);
+    double gam = 5.8351514 + 0.0019443680 * day;
+    double zx = 0.39785416 * stem / zsinil;
+    double zy = zcoshl * ctem + 0.91744867 * zsinhl * stem;
+    zx = gam + atan2(zx, zy) - xnodce;
+    double zcosgl = cos(zx), zsingl = sin(zx);
+
+    // Solar terms first (ss, sz), then lunar ones (s, z)
+    double zcosg = ZCOSGS, zsing = ZSINGS, zcosi = ZCOSIS, zsini = ZSINIS;
+    double zcosh = cnodm, zsinh = snodm;
+    double cc = C1SS;
+    double xnoi = 1.0 / nm;
+    double s1, s2, s3, s4, s5, s6, s7, ss1 = 0, ss2 = 0, ss3 = 0, ss4 = 0, ss5 = 0, ss6 = 0, ss7 = 0;
+    double z1, z2, z3, z11, z12, z13, z21, z22, z23, z31, z32, z33;
+    double sz1 = 0, sz2 = 0, sz3 = 0, sz11 = 0, sz12 = 0, sz13 = 0, sz21 = 0, sz22 = 0, sz23 = 0;
+    double sz31 = 0, sz32 = 0, sz33 = 0;
+    for (int lsflg = 1; lsflg <= 2; lsflg++)
+    {
+        double a1 = zcosg * zcosh + zsing * zcosi * zsinh;
+        double a3 = -zsing * zcosh + zcosg * zcosi * zsinh;
+        double a7 = -zcosg * zsinh + zsing * zcosi * zcosh;
+        double a8 = zsing * zsini;
+        double a9 = zsing * zsinh + zcosg * zcosi * zcosh;
+        double a10 = zcosg * zsini;
+        double a2 = cosim * a7 + sinim * a8;
+        double a4 = cosim * a9 + sinim * a10;
+        double a5 = -sinim * a7 + cosim * a8;
+        double a6 = -sinim * a9 + cosim * a10;
+
+        double x1 = a1 * cosomm + a2 * sinomm;
+        double x2 = a3 * cosomm + a4 * sinomm;
+        double x3 = -a1 * sinomm + a2 * cosomm;
+        double x4 = -a3 * sinomm + a4 * cosomm;
+        double x5 = a5 * sinomm;
+        double x6 = a6 * sinomm;
+        double x7 = a5 * cosomm;
+        double x8 = a6 * cosomm;
+
+        z31 = 12.0 * x1 * x1 - 3.0 * x3 * x3;
+        z32 = 24.0 * x1 * x2 - 6.0 * x3 * x4;
+        z33 = 12.0 * x2 * x2 - 3.0 * x4 * x4;
+        z1 = 3.0 * (a1 * a1 + a2 * a2) + z31 * emsq;
+        z2 = 6.0 * (a1 * a3 + a2 * a4) + z32 * emsq;
+        z3 = 3.0 * (a3 * a3 + a4 * a4) + z33 * emsq;
+        z11 = -6.0 * a1 * a5 + emsq * (-24.0 * x1 * x7 - 6.0 * x3 * x5);
+        z12 = -6.0 * (a1 * a6 + a3 * a5) + emsq * (-24.0 * (x2 * x7 + x1 * x8) - 6.0 * (x3 * x6 + x4 * x5));
+        z13 = -6.0 * a3 * a6 + emsq * (-24.0 * x2 * x8 - 6.0 * x4 * x6);
+        z21 = 6.0 * a2 * a5 + emsq * (24.0 * x1 * x5 - 6.0 * x3 * x7);
+        z22 = 6.0 * (a4 * a5 + a2 * a6) + emsq * (24.0 * (x2 * x5 + x1 * x6) - 6.0 * (x4 * x7 + x3 * x8));
+        z23 = 6.0 * a4 * a6 + emsq * (24.0 * x2 * x6 - 6.0 * x4 * x8);
+        z1 = z1 + z1 + betasq * z31;
+        z2 = z2 + z2 + betasq * z32;
+        z3 = z3 + z3 + betasq * z33;
+        s3 = cc * xnoi;
+        s2 = -0.5 * s3 / rtemsq;
+        s4 = s3 * rtemsq;
+        s1 = -15.0 * em * s4;
+        s5 = x1 * x3 + x2 * x4;
+        s6 = x2 * x3 + x1 * x4;
+        s7 = x2 * x4 - x1 * x3;
+
+        if (lsflg == 1)
+        {
+            ss1 = s1, ss2 = s2, ss3 = s3, ss4 = s4, ss5 = s5, ss6 = s6, ss7 = s7;
+            sz1 = z1, sz2 = z2, sz3 = z3;
+            sz11 = z11, sz12 = z12, sz13 = z13;
+            sz21 = z21, sz22 = z22, sz23 = z23;
+            sz31 = z31, sz32 = z32, sz33 = z33;
+            zcosg = zcosgl;
+            zsing = zsingl;
+            zcosi = zcosil;
+            zsini = zsinil;
+            zcosh = zcoshl * cnodm + zsinhl * snodm;
+            zsinh = snodm * zcoshl - cnodm * zsinhl;
+            cc = C1L;
+        }
+    }
+
+    d.zmol = fmod(4.7199672 + 0.22997150 * day - gam, D2PI);
+    d.zmos = fmod(6.2565837 + 0.017201977 * day, D2PI);
+
+    d.se2 = 2.0 * ss1 * ss6;
+    d.se3 = 2.0 * ss1 * ss7;
+    d.si2 = 2.0 * ss2 * sz12;
+    d.si3 = 2.0 * ss2 * (sz13 - sz11);
+    d.sl2 = -2.0 * ss3 * sz2;
+    d.sl3 = -2.0 * ss3 * (sz3 - sz1);
+    d.sl4 = -2.0 * ss3 * (-21.0 - 9.0 * emsq) * ZES;
+    d.sgh2 = 2.0 * ss4 * sz32;
+    d.sgh3 = 2.0 * ss4 * (sz33 - sz31);
+    d.sgh4 = -18.0 * ss4 * ZES;
+    d.sh2 = -2.0 * ss2 * sz22;
+    d.sh3 = -2.0 * ss2 * (sz23 - sz21);
+
+    d.ee2 = 2.0 * s1 * s6;
+    d.e3 = 2.0 * s1 * s7;
+    d.xi2 = 2.0 * s2 * z12;
+    d.xi3 = 2.0 * s2 * (z13 - z11);
+    d.xl2 = -2.0 * s3 * z2;
+    d.xl3 = -2.0 * s3 * (z3 - z1);
+    d.xl4 = -2.0 * s3 * (-21.0 - 9.0 * emsq) * ZEL;
+    d.xgh2 = 2.0 * s4 * z32;
+    d.xgh3 = 2.0 * s4 * (z33 - z31);
+    d.xgh4 = -18.0 * s4 * ZEL;
+    d.xh2 = -2.0 * s2 * z22;
+    d.xh3 = -2.0 * s2 * (z23 - z21);
+
+    // dsinit : secular rates
+    d.irez = 0;
+    if (nm < 0.0052359877 && nm > 0.0034906585)
+    {
+        d.irez = 1;
+    }
+    if (nm >= 8.26e-3 && nm <= 9.24e-3 && em >= 0.5)
+    {
+        d.irez = 2;
+    }
+
+    double ses = ss1 * ZNS * ss5;
+    double sis = ss2 * ZNS * (sz11 + sz13);
+    double sls = -ZNS * ss3 * (sz1 + sz3 - 14.0 - 6.0 * emsq);
+    double sghs = ss4 * ZNS * (sz31 + sz33 - 6.0);
+    double shs = -ZNS * ss2 * (sz21 + sz23);
+    const bool equatorial = elements.inclo < 5.2359877e-2 || elements.inclo > M_PI - 5.2359877e-2; // Within 3 deg
+    if (equatorial)
+    {
+        shs = 0.0;
+    }
+    if (sinim != 0.0)
+    {
+        shs = shs / sinim;
+    }
+    double sgs = sghs - cosim * shs;
+
+    d.dedt = ses + s1 * ZNL * s5;
+    d.didt = sis + s2 * ZNL * (z11 + z13);
+    d.dmdt = sls - ZNL * s3 * (z1 + z3 - 14.0 - 6.0 * emsq);
+    double sghl = s4 * ZNL * (z31 + z33 - 6.0);
+    double shll = -ZNL * s2 * (z21 + z23);
+    if (equatorial)
+    {
+        shll = 0.0;
+    }
+    d.domdt = sgs + sghl;
+    d.dnodt = shs;
+    if (sinim != 0.0)
+    {
+        d.domdt = d.domdt - cosim / sinim * shll;
+        d.dnodt = d.dnodt + shll / sinim;
+    }
+
+    // dsinit : resonance terms
+    JulianDate jd = unixTimeToJD(elements.epoch);
+    d.gsto = iauGmst82(jd.day, jd.fraction); // UT1 taken as UTC, as in the reference code
+    d.xfact = d.xlamo = 0;
+    d.del1 = d.del2 = d.del3 = 0;
+    d.d2201 = d.d2211 = d.d3210 = d.d3222 = d.d4410 = d.d4422 = d.d5220 = d.d5232 = d.d5421 = d.d5433 = 0;
+    if (d.irez == 0)
+    {
+        return;
+    }
+    const double theta = d.gsto;
+    double aonv = pow(nm / XKE, X2O3);
+    if (d.irez == 2)
+    {
+        // Geopotential resonance for 12 hour orbits
+        const double ROOT22 = 1.7891679e-6, ROOT32 = 3.7393792e-7, ROOT44 = 7.3636953e-9;
+        const double ROOT52 = 1.1428639e-7, ROOT54 = 2.1765803e-9;
+        double cosisq = cosim * cosim;
+        double e = elements.ecco, esq = eccsq, eoc = e * esq;
+        double g201 = -0.306 - (e - 0.64) * 0.440;
+        double g211, g310, g322, g410, g422, g520, g521, g532, g533;
+        if (e <= 0.65)
+        {
+            g211 = 3.616 - 13.2470 * e + 16.2900 * esq;
+            g310 = -19.302 + 117.3900 * e - 228.4190 * esq + 156.5910 * eoc;
+            g322 = -18.9068 + 109.7927 * e - 214.6334 * esq + 146.5816 * eoc;
+            g410 = -41.122 + 242.6940 * e - 471.0940 * esq + 313.9530 * eoc;
+            g422 = -146.407 + 841.8800 * e - 1629.014 * esq + 1083.4350 * eoc;
+            g520 = -532.114 + 3017.977 * e - 5740.032 * esq + 3708.2760 * eoc;
+        }
+        else
+        {
+            g211 = -72.099 + 331.819 * e - 508.738 * esq + 266.724 * eoc;
+            g310 = -346.844 + 1582.851 * e - 2415.925 * esq + 1246.113 * eoc;
+            g322 = -342.585 + 1554.908 * e - 2366.899 * esq + 1215.972 * eoc;
+            g410 = -1052.797 + 4758.686 * e - 7193.992 * esq + 3651.957 * eoc;
+            g422 = -3581.690 + 16178.110 * e - 24462.770 * esq + 12422.520 * eoc;
+            g520 = e > 0.715 ? -5149.66 + 29936.92 * e - 54087.36 * esq + 31324.56 * eoc
+                             : 1464.74 - 4664.75 * e + 3763.64 * esq;
+        }
+        if (e < 0.7)
+        {
+            g533 = -919.22770 + 4988.6100 * e - 9064.7700 * esq + 5542.21 * eoc;
+            g521 = -822.71072 + 4568.6173 * e - 8491.4146 * esq + 5337.524 * eoc;
+            g532 = -853.66600 + 4690.2500 * e - 8624.7700 * esq + 5341.4 * eoc;
+        }
+        else
+        {
+            g533 = -37995.780 + 161616.52 * e - 229838.20 * esq + 109377.94 * eoc;
+            g521 = -51752.104 + 218913.95 * e - 309468.16 * esq + 146349.42 * eoc;
+            g532 = -40023.880 + 170470.89 * e - 242699.48 * esq + 115605.82 * eoc;
+        }
+
+        double sini2 = sinim * sinim;
+        double f220 = 0.75 * (1.0 + 2.0 * cosim + cosisq);
+        double f221 = 1.5 * sini2;
+        double f321 = 1.875 * sinim * (1.0 - 2.0 * cosim - 3.0 * cosisq);
+        double f322 = -1.875 * sinim * (1.0 + 2.0 * cosim - 3.0 * cosisq);
+        double f441 = 35.0 * sini2 * f220;
+        double f442 = 39.3750 * sini2 * sini2;
+        double f522 = 9.84375 * sinim *
+                      (sini2 * (1.0 - 2.0 * cosim - 5.0 * cosisq) + 0.33333333 * (-2.0 + 4.0 * cosim + 6.0 * cosisq));
+        double f523 = sinim * (4.92187512 * sini2 * (-2.0 - 4.0 * cosim + 10.0 * cosisq) +
+                               6.56250012 * (1.0 + 2.0 * cosim - 3.0 * cosisq));
+        double f542 = 29.53125 * sinim * (2.0 - 8.0 * cosim + cosisq * (-12.0 + 8.0 * cosim + 10.0 * cosisq));
+        double f543 = 29.53125 * sinim * (-2.0 - 8.0 * cosim + cosisq * (12.0 + 8.0 * cosim - 10.0 * cosisq));
+        double xno2 = nm * nm;
+        double ainv2 = aonv * aonv;
+        double temp1 = 3.0 * xno2 * ainv2;
+        double temp = temp1 * ROOT22;
+        d.d2201 = temp * f220 * g201;
+        d.d2211 = temp * f221 * g211;
+        temp1 = temp1 * aonv;
+        temp = temp1 * ROOT32;
+        d.d3210 = temp * f321 * g310;
+        d.d3222 = temp * f322 * g322;
+        temp1 = temp1 * aonv;
+        temp = 2.0 * temp1 * ROOT44;
+        d.d4410 = temp * f441 * g410;
+        d.d4422 = temp * f442 * g422;
+        temp1 = temp1 * aonv;
+        temp = temp1 * ROOT52;
+        d.d5220 = temp * f522 * g520;
+        d.d5232 = temp * f523 * g532;
+        temp = 2.0 * temp1 * ROOT54;
+        d.d5421 = temp * f542 * g521;
+        d.d5433 = temp * f543 * g533;
+        d.xlamo = fmod(elements.mo + elements.nodeo + elements.nodeo - theta - theta, D2PI);
+        d.xfact = mdot + d.dmdt + 2.0 * (nodedot + d.dnodt - RPTIM) - no_unkozai;
+    }
+    else
+    {
+        // Synchronous resonance
+        const double Q22 = 1.7891679e-6, Q31 = 2.1460748e-6, Q33 = 2.2123015e-7;
+        double g200 = 1.0 + emsq * (-2.5 + 0.8125 * emsq);
+        double g310 = 1.0 + 2.0 * emsq;
+        double g300 = 1.0 + emsq * (-6.0 + 6.60937 * emsq);
+        double f220 = 0.75 * (1.0 + cosim) * (1.0 + cosim);
+        double f311 = 0.9375 * sinim * sinim * (1.0 + 3.0 * cosim) - 0.75 * (1.0 + cosim);
+        double f330 = 1.0 + cosim;
+        f330 = 1.875 * f330 * f330 * f330;
+        d.del1 = 3.0 * nm * nm * aonv * aonv;
+        d.del2 = 2.0 * d.del1 * f220 * g200 * Q22;
+        d.del3 = 3.0 * d.del1 * f330 * g300 * Q33 * aonv;
+        d.del1 = d.del1 * f311 * g310 * Q31 * aonv;
+        d.xlamo = fmod(elements.mo + elements.nodeo + elements.argpo - theta, D2PI);
+        d.xfact = mdot + xpidot - RPTIM + d.dmdt + d.domdt + d.dnodt - no_unkozai;
+    }
+}
+
+// Lunar-solar secular terms and resonance (dspace). The resonance is
+// integrated from the epoch on each call, so that propagate() keeps no
+// state : |t| / 720 Euler-Maclaurin steps.
+void Sgp4::deepSecular(double t, double &em, double &argpm, double &inclm, double &mm, double &nodem,
+                       double &nm) const
+{
+    const DeepSpace &d = deep;
+    em = em + d.dedt * t;
+    inclm = inclm + d.didt * t;
+    argpm = argpm + d.domdt * t;
+    nodem = nodem + d.dnodt * t;
+    mm = mm + d.dmdt * t;
+    if (d.irez == 0)
+    {
+        return;
+    }
+
+    const double FASX2 = 0.13130908, FASX4 = 2.8843198, FASX6 = 0.37448087;
+    const double G22 = 5.7686396, G32 = 0.95240898, G44 = 1.8014998, G52 = 1.0508330, G54 = 4.4108898;
+    const double STEP = 720.0, STEP2 = 259200.0;
+    double theta = fmod(d.gsto + t * RPTIM, D2PI);
+    double delt = t > 0.0 ? STEP : -STEP;
+    double atime = 0.0, xni = no_unkozai, xli = d.xlamo;
+    double xndt, xldot, xnddt, ft;
+    while (true)
+    {
+        if (d.irez != 2)
+        {
+            // Near-synchronous resonance
+            xndt = d.del1 * sin(xli - FASX2) + d.del2 * sin(2.0 * (xli - FASX4)) + d.del3 * sin(3.0 * (xli - FASX6));
+            xldot = xni + d.xfact;
+            xnddt = d.del1 * cos(xli - FASX2) + 2.0 * d.del2 * cos(2.0 * (xli - FASX4)) +
+                    3.0 * d.del3 * cos(3.0 * (xli - FASX6));
+            xnddt = xnddt * xldot;
+        }
+        else
+        {
+            // Near-half-day resonance
+            double xomi = elements.argpo + argpdot * atime;
+            double x2omi = xomi + xomi;
+            double x2li = xli + xli;
+            xndt = d.d2201 * sin(x2omi + xli - G22) + d.d2211 * sin(xli - G22) + d.d3210 * sin(xomi + xli - G32) +
+                   d.d3222 * sin(-xomi + xli - G32) + d.d4410 * sin(x2omi + x2li - G44) + d.d4422 * sin(x2li - G44) +
+                   d.d5220 * sin(xomi + xli - G52) + d.d5232 * sin(-xomi + xli - G52) +
+                   d.d5421 * sin(xomi + x2li - G54) + d.d5433 * sin(-xomi + x2li - G54);
+            xldot = xni + d.xfact;
+            xnddt = d.d2201 * cos(x2omi + xli - G22) + d.d2211 * cos(xli - G22) + d.d3210 * cos(xomi + xli - G32) +
+                    d.d3222 * cos(-xomi + xli - G32) + d.d5220 * cos(xomi + xli - G52) +
+                    d.d5232 * cos(-xomi + xli - G52) +
+                    2.0 * (d.d4410 * cos(x2omi + x2li - G44) + d.d4422 * cos(x2li - G44) +
+                           d.d5421 * cos(xomi + x2li - G54) + d.d5433 * cos(-xomi + x2li - G54));
+            xnddt = xnddt * xldot;
+        }
+
+        if (fabs(t - atime) < STEP)
+        {
+            ft = t - atime;
+            break;
+        }
+        xli = xli + xldot * delt + xndt * STEP2;
+        xni = xni + xndt * delt + xnddt * STEP2;
+        atime = atime + delt;
+    }
+
+    nm = xni + xndt * ft + xnddt * ft * ft * 0.5;
+    double xl = xli + xldot * ft + xndt * ft * ft * 0.5;
+    if (d.irez != 1)
+    {
+        mm = xl - 2.0 * nodem + 2.0 * theta;
+    }
+    else
+    {
+        mm = xl - nodem - argpm + theta;
+    }
+}
+
+// Lunar-solar periodics (dpper), applied to the mean elements at t
+void Sgp4::deepPeriodics(double t, double &ep, double &inclp, double &nodep, double &argpp, double &mp) const
+{
+    const DeepSpace &d = deep;
+    double zm = d.zmos + ZNS * t;
+    double zf = zm + 2.0 * ZES * sin(zm);
+    double sinzf = sin(zf);
+    double f2 = 0.5 * sinzf * sinzf - 0.25;
+    double f3 = -0.5 * sinzf * cos(zf);
+    double ses = d.se2 * f2 + d.se3 * f3;
+    double sis = d.si2 * f2 + d.si3 * f3;
+    double sls = d.sl2 * f2 + d.sl3 * f3 + d.sl4 * sinzf;
+    double sghs = d.sgh2 * f2 + d.sgh3 * f3 + d.sgh4 * sinzf;
+    double shs = d.sh2 * f2 + d.sh3 * f3;
+
+    zm = d.zmol + ZNL * t;
+    zf = zm + 2.0 * ZEL * sin(zm);
+    sinzf = sin(zf);
+    f2 = 0.5 * sinzf * sinzf - 0.25;
+    f3 = -0.5 * sinzf * cos(zf);
+    double sel = d.ee2 * f2 + d.e3 * f3;
+    double sil = d.xi2 * f2 + d.xi3 * f3;
+    double sll = d.xl2 * f2 + d.xl3 * f3 + d.xl4 * sinzf;
+    double sghl = d.xgh2 * f2 + d.xgh3 * f3 + d.xgh4 * sinzf;
+    double shll = d.xh2 * f2 + d.xh3 * f3;
+
+    double pe = ses + sel;
+    double pinc = sis + sil;
+    double pl = sls + sll;
+    double pgh = sghs + sghl;
+    double ph = shs + shll;
+
+    inclp = inclp + pinc;
+    ep = ep + pe;
+    double sinip = sin(inclp);
+    double cosip = cos(inclp);
+    if (inclp >= 0.2)
+    {
+        ph = ph / sinip;
+        pgh = pgh - cosip * ph;
+        argpp = argpp + pgh;
+        nodep = nodep + ph;
+        mp = mp + pl;
+    }
+    else
+    {
+        // Lyddane modification for low inclinations
+        double sinop = sin(nodep);
+        double cosop = cos(nodep);
+        double alfdp = sinip * sinop + ph * cosop + pinc * cosip * sinop;
+        double betdp = sinip * cosop - ph * sinop + pinc * cosip * cosop;
+        nodep = fmod(nodep, D2PI);
+        double xls = mp + argpp + cosip * nodep;
+        double dls = pl + pgh - pinc * nodep * sinip;
+        xls = xls + dls;
+        double xnoh = nodep;
+        nodep = atan2(alfdp, betdp);
+        if (fabs(xnoh - nodep) > M_PI)
+        {
+            nodep = nodep < xnoh ? nodep + D2PI : nodep - D2PI;
+        }
+        mp = mp + pl;
+        argpp = xls - mp - cosip * nodep;
+    }
+}
+
+Sgp4::Status Sgp4::propagate(double tsince, double r[3], double v[3]) const
+{
+    if (status != OK)
+    {
+        return status;
+    }
+    const double t = tsince;
+
+    // Secular gravity and atmospheric drag
+    double xmdf = elements.mo + mdot * t;
+    double argpdf = elements.argpo + argpdot * t;
+    double nodedf = elements.nodeo + nodedot * t;
+    double argpm = argpdf;
+    double mm = xmdf;
+    double t2 = t * t;
+    double nodem = nodedf + nodecf * t2;
+    double tempa = 1.0 - cc1 * t;
+    double tempe = elements.bstar * cc4 * t;
+    double templ = t2cof * t2;
+
+    if (!isimp)
+    {
+        double delomg = omgcof * t;
+        double delm = xmcof * (pow(1.0 + eta * cos(xmdf), 3) - delmo);
+        double temp = delomg + delm;
+        mm = xmdf + temp;
+        argpm = argpdf - temp;
+        double t3 = t2 * t;
+        double t4 = t3 * t;
+        tempa = tempa - d2 * t2 - d3 * t3 - d4 * t4;
+        tempe = tempe + elements.bstar * cc5 * (sin(mm) - sinmao);
+        templ = templ + t3cof * t3 + t4 * (t4cof + t * t5cof);
+    }
+
+    double nm = no_unkozai;
+    double em = elements.ecco;
+    double inclm = elements.inclo;
+    if (deepSpace)
+    {
+        deepSecular(t, em, argpm, inclm, mm, nodem, nm);
+        if (nm <= 0.0)
+        {
+            return MEAN_MOTION;
+        }
+    }
+
+    double am = pow(XKE / nm, X2O3) * tempa * tempa;
+    nm = XKE / pow(am, 1.5);
+    em = em - tempe;
+    if (em >= 1.0 || em < -0.001)
+    {
+        return ECCENTRICITY;
+    }
+    if (em < 1.0e-6)
+    {
+        em = 1.0e-6;
+    }
+    mm = mm + no_unkozai * templ;
+    double xlm = mm + argpm + nodem;
+
+    nodem = fmod(nodem, D2PI);
+    argpm = fmod(argpm, D2PI);
+    xlm = fmod(xlm, D2PI);
+    mm = fmod(xlm - argpm - nodem, D2PI);
+
+    // Lunar-solar periodics
+    double ep = em, xincp = inclm, argpp = argpm, nodep = nodem, mp = mm;
+    double xlcofp = xlcof, aycofp = aycof;
+    if (deepSpace)
+    {
+        deepPeriodics(t, ep, xincp, nodep, argpp, mp);
+        if (xincp < 0.0)
+        {
+            xincp = -xincp;
+            nodep = nodep + M_PI;
+            argpp = argpp - M_PI;
+        }
+        if (ep < 0.0 || ep > 1.0)
+        {
+            return PERTURBED_ECCENTRICITY;
+        }
+    }
+    double sinip = sin(xincp);
+    double cosip = cos(xincp);
+    if (deepSpace)
+    {
+        aycofp = -0.5 * J3OJ2 * sinip;
+        xlcofp = -0.25 * J3OJ2 * sinip * (3.0 + 5.0 * cosip) /
+                 (fabs(cosip + 1.0) > TEMP4 ? 1.0 + cosip : TEMP4);
+    }
+
+    // Long period periodics
+    double axnl = ep * cos(argpp);
+    double temp = 1.0 / (am * (1.0 - ep * ep));
+    double aynl = ep * sin(argpp) + temp * aycofp;
+    double xl = mp + argpp + nodep + temp * xlcofp * axnl;
+
+    // Kepler's equation
+    double u = fmod(xl - nodep, D2PI);
+    double eo1 = u;
+    double sineo1 = 0, coseo1 = 1;
+    double tem5 = 9999.9;
+    for (int ktr = 1; fabs(tem5) >= 1.0e-12 && ktr <= 10; ktr++)
+    {
+        sineo1 = sin(eo1);
+        coseo1 = cos(eo1);
+        tem5 = 1.0 - coseo1 * axnl - sineo1 * aynl;
+        tem5 = (u - aynl * coseo1 + axnl * sineo1 - eo1) / tem5;
+        if (fabs(tem5) >= 0.95)
+        {
+            tem5 = tem5 > 0.0 ? 0.95 : -0.95;
+        }
+        eo1 = eo1 + tem5;
+    }
+
+    // Short period preliminary quantities
+    double ecose = axnl * coseo1 + aynl * sineo1;
+    double esine = axnl * sineo1 - aynl * coseo1;
+    double el2 = axnl * axnl + aynl * aynl;
+    double pl = am * (1.0 - el2);
+    if (pl < 0.0)
+    {
+        return SEMI_LATUS;
+    }
+
+    double rl = am * (1.0 - ecose);
+    double rdotl = sqrt(am) * esine / rl;
+    double rvdotl = sqrt(pl) / rl;
+    double betal = sqrt(1.0 - el2);
+    temp = esine / (1.0 + betal);
+    double sinu = am / rl * (sineo1 - aynl - axnl * temp);
+    double cosu = am / rl * (coseo1 - axnl + aynl * temp);
+    double su = atan2(sinu, cosu);
+    double sin2u = (cosu + cosu) * sinu;
+    double cos2u = 1.0 - 2.0 * sinu * sinu;
+    temp = 1.0 / pl;
+    double temp1 = 0.5 * J2 * temp;
+    double temp2 = temp1 * temp;
+
+    // Short period periodics, on the perturbed inclination in deep space
+    double con41p = con41, x1mth2p = x1mth2, x7thm1p = x7thm1;
+    if (deepSpace)
+    {
+        double cosisq = cosip * cosip;
+        con41p = 3.0 * cosisq - 1.0;
+        x1mth2p = 1.0 - cosisq;
+        x7thm1p = 7.0 * cosisq - 1.0;
+    }
+    double mrt = rl * (1.0 - 1.5 * temp2 * betal * con41p) + 0.5 * temp1 * x1mth2p * cos2u;
+    su = su - 0.25 * temp2 * x7thm1p * sin2u;
+    double xnode = nodep + 1.5 * temp2 * cosip * sin2u;
+    double xinc = xincp + 1.5 * temp2 * cosip * sinip * cos2u;
+    double mvt = rdotl - nm * temp1 * x1mth2p * sin2u / XKE;
+    double rvdot = rvdotl + nm * temp1 * (x1mth2p * cos2u + 1.5 * con41p) / XKE;
+
+    // Orientation vectors
+    double sinsu = sin(su), cossu = cos(su);
+    double snod = sin(xnode), cnod = cos(xnode);
+    double sini = sin(xinc), cosi = cos(xinc);
+    double xmx = -snod * cosi;
+    double xmy = cnod * cosi;
+    double ux = xmx * sinsu + cnod * cossu;
+    double uy = xmy * sinsu + snod * cossu;
+    double uz = sini * sinsu;
+    double vx = xmx * cossu - cnod * sinsu;
+    double vy = xmy * cossu - snod * sinsu;
+    double vz = sini * cossu;
+
+    r[0] = mrt * ux * EARTH_RADIUS;
+    r[1] = mrt * uy * EARTH_RADIUS;
+    r[2] = mrt * uz * EARTH_RADIUS;
+    v[0] = (mvt * ux + rvdot * vx) * VKMPERSEC;
+    v[1] = (mvt * uy + rvdot * vy) * VKMPERSEC;
+    v[2] = (mvt * uz + rvdot * vz) * VKMPERSEC;
+
+    return mrt < 1.0 ? DECAYED : OK;
+}
+
+Sgp4::Status Sgp4::propagateAt(double unixTime, double r[3], double v[3]) const
+{
+    return propagate((unixTime - elements.epoch) / 60.0, r, v);
+}
+
+const char *sgp4StatusToString(Sgp4::Status status)
+{
+    switch (status)
+    {
+    case Sgp4::OK:
+        return "ok";
+    case Sgp4::ECCENTRICITY:
+        return "eccentricity out of range";
+    case Sgp4::MEAN_MOTION:
+        return "negative mean motion";
+    case Sgp4::SEMI_LATUS:
+        return "negative semi-latus rectum";
+    case Sgp4::DECAYED:
+        return "orbit decayed";
+    case Sgp4::PERTURBED_ECCENTRICITY:
+        return "perturbed eccentricity out of range";
+    default:
+        return "not initialized";
+    }
+}
+
+void temeToAltAz(const double r[3], const double v[3], double unixTime,
+                 double &az, double &el, double &azRate, double &elRate)
+{
+    // TEME -> Earth-fixed through GMST (IAU 1982, as in the TLE theory)
+    JulianDate jd = unixTimeToJD(unixTime);
+    double theta = iauGmst82(jd.day, jd.fraction + DUT1 / SECONDS_IN_DAY);
+    double st = sin(theta), ct = cos(theta);
+    double p[3] = {ct * r[0] + st * r[1], -st * r[0] + ct * r[1], r[2]};
+
+    // Observatory, WGS84
+    static const ObserverFrame obs;
+    double rho[3], local[3];
+    iauPmp(p, (double *)obs.position, rho);
+    obs.toLocal(rho, local);
+    double east = local[0], north = local[1], up = local[2];
+    double horizontal2 = east * east + north * north;
+
+    az = atan2(east, north) * DR2D;
+    if (az < 0)
+    {
+        az += 360.0;
+    }
+    el = atan2(up, sqrt(horizontal2)) * DR2D;
+
+    if (v == nullptr)
+    {
+        return;
+    }
+
+    // Earth-fixed velocity : rotated, minus the frame rotation (omega x p)
+    double pv[3] = {ct * v[0] + st * v[1] + EARTH_ROTATION_RATE * p[1],
+                    -st * v[0] + ct * v[1] - EARTH_ROTATION_RATE * p[0],
+                    v[2]};
+    double rate[3];
+    obs.toLocal(pv, rate);
+
+    // Derivatives of atan2(east, north) and atan2(up, horizontal)
+    double range2 = horizontal2 + up * up;
+    double horizontal = sqrt(horizontal2);
+    azRate = (north * rate[0] - east * rate[1]) / horizontal2 * DR2D;
+    elRate = (rate[2] * horizontal2 - up * (east * rate[0] + north * rate[1])) / (range2 * horizontal) * DR2D;
+}
+
+std::tuple<double, double> temeToAltAz(const double r[3], double unixTime)
+{
+    double az, el, azRate, elRate;
+    temeToAltAz(r, nullptr, unixTime, az, el, azRate, elRate);
+    return std::make_tuple(az, el);
+}
@@ -0,0 +1,68 @@
+#include "Telemetry.h"
+#include <math.h>
+#include "define.h"
+
+bool StreamRate::setRate(float rateHz)
+{
+    if (!(rateHz >= 0 && rateHz <= STREAM_MAX_RATE))
+    {
+        return false;
+    }
+    rate.store(rateHz, std::memory_order_relaxed);
+    return true;
+}
+
+float StreamRate::getRate() const
+{
+    return rate.load(std::memory_order_relaxed);
+}
+
+uint32_t StreamRate::getPeriodMs() const
+{
+    float hz = getRate();
+    if (hz == 0)
+    {
+        return defaultPeriod;
+    }
+    uint32_t period = (uint32_t)lroundf(1000.f / hz);
+    return period > 0 ? period : 1;
+}
+
+PositionStream::PositionStream()
+    : StreamRate(POSITION_BROADCAST_DELAY), deadband(STREAM_DEFAULT_DEADBAND), sent(0), suppressed(0),
+      started(false), lastAz(0), lastEl(0), lastStatus(ErrorType::NONE), lastTime(0)
+{
+}
+
+bool PositionStream::setDeadband(float deadbandDeg)
+{
+    if (!(deadbandDeg >= 0))
+    {
+        return false;
+    }
+    deadband.store(deadbandDeg, std::memory_order_relaxed);
+    return true;
+}
+
+float PositionStream::getDeadband() const
+{
+    return deadband.load(std::memory_order_relaxed);
+}
+
+bool PositionStream::accept(float az, float el, ErrorType status, uint32_t now)
+{
+    float band = getDeadband();
+    bool moved = fabsf(az - lastAz) > band || fabsf(el - lastEl) > band || band == 0;
+    if (started && !moved && status == lastStatus && now - lastTime < POSITION_BROADCAST_DELAY)
+    {
+        suppressed.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    started = true;
+    lastAz = az;
+    lastEl = el;
+    lastStatus = status;
+    lastTime = now;
+    sent.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
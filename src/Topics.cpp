@@ -0,0 +1,87 @@
+#include "Topics.h"
+#include <atomic>
+#include <string.h>
+#include "define.h"
+
+static const char *const TOPIC_NAMES[] = {"position", "tracking", "errors", "debug", "timing"};
+static const char *const LEVEL_NAMES[] = {"debug", "info", "warning", "error"};
+
+static_assert(sizeof(TOPIC_NAMES) / sizeof(TOPIC_NAMES[0]) == (size_t)Topic::COUNT, "TOPIC_NAMES out of date");
+
+// Everything subscribed at start, as before topics existed, but timing
+static std::atomic<bool> subscribed[(size_t)Topic::COUNT] = {{true}, {true}, {true}, {true}, {false}};
+static std::atomic<int> levels[(size_t)Topic::COUNT] = {
+    {LOG_LEVEL_DEBUG}, {LOG_LEVEL_INFO}, {LOG_LEVEL_WARNING}, {LOG_LEVEL_DEBUG}, {LOG_LEVEL_DEBUG}};
+
+const char *topicToString(Topic topic)
+{
+    return (size_t)topic < (size_t)Topic::COUNT ? TOPIC_NAMES[(size_t)topic] : "unknown";
+}
+
+bool topicFromString(const char *name, Topic &topic)
+{
+    for (size_t i = 0; i < (size_t)Topic::COUNT; i++)
+    {
+        if (strcmp(name, TOPIC_NAMES[i]) == 0)
+        {
+            topic = (Topic)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char *logLevelToString(int level)
+{
+    return level >= LOG_LEVEL_DEBUG && level <= LOG_LEVEL_ERROR ? LEVEL_NAMES[level] : "none";
+}
+
+bool logLevelFromString(const char *name, int &level)
+{
+    for (int i = LOG_LEVEL_DEBUG; i <= LOG_LEVEL_ERROR; i++)
+    {
+        if (strcmp(name, LEVEL_NAMES[i]) == 0)
+        {
+            level = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool isSubscribed(Topic topic)
+{
+    return subscribed[(size_t)topic].load(std::memory_order_relaxed);
+}
+
+int getTopicLevel(Topic topic)
+{
+    return levels[(size_t)topic].load(std::memory_order_relaxed);
+}
+
+void subscribe(Topic topic)
+{
+    subscribed[(size_t)topic].store(true, std::memory_order_relaxed);
+}
+
+void unsubscribe(Topic topic)
+{
+    subscribed[(size_t)topic].store(false, std::memory_order_relaxed);
+}
+
+void setTopicLevel(Topic topic, int level)
+{
+    levels[(size_t)topic].store(level, std::memory_order_relaxed);
+}
+
+Topic logTopic(int level)
+{
+    return level <= LOG_LEVEL_DEBUG ? Topic::DEBUG : level == LOG_LEVEL_INFO ? Topic::TRACKING
+                                                                             : Topic::ERRORS;
+}
+
+bool isLogSubscribed(int level)
+{
+    Topic topic = logTopic(level);
+    return isSubscribed(topic) && level >= getTopicLevel(topic);
+}
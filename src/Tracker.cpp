@@ -1,4 +1,5 @@
 #include "Tracker.h"
+#include "Log.h"
 
 Tracker &Tracker::getInstance()
 {
@@ -7,45 +8,39 @@ Tracker &Tracker::getInstance()
 }
 
 // Constructor initializes mutex and tracking mode
-Tracker::Tracker() : Tasker(), currentMode(IDLE), trackingTimer(nullptr), target_change_flag(false)
+Tracker::Tracker() : Tasker(), trackingTimer(nullptr), precisionEquatorial(TRACK_PRECISION_EQUATORIAL),
+                     precisionGalactic(TRACK_PRECISION_GALACTIC), trajectoryGeneration(0), ephemerisGeneration(0),
+                     planet(Body::JUPITER), currentMode(IDLE), requestedMode(IDLE), target_change_flag(false)
 {
-    targetAz = HOME_AZ;
-    targetEl = HOME_EL;
+    target.store({HOME_AZ, HOME_EL, 0, 0, 0});
     positionMutex = xSemaphoreCreateMutex();
+    astrometry.setTier(cheapestTier(POINTING_BUDGET));
 }
 
-// Start tracking by initializing tasks and timers
+// Start tracking : retargets the running tracker, or queues a track command.
+// The tracker is only retargeted while no command is queued : a queued
+// command makes it return, and the new target would be lost with it. Only
+// the receive task submits commands, so none can be queued in between.
 void Tracker::start(TrackingMode mode)
 {
-    switch (mode)
+    if (mode == IDLE)
     {
-    case IDLE:
         // Not supposed to be used ever, bust just in case
         stop();
-        break;
-    default:
-        if (currentMode == IDLE)
-        {
-            bool mode_success(setTrackingMode(mode)); // Change mode
-            if (!mode_success)
-            { // Check success
-                print_error("Failed to start tracking");
-                return;
-            }
-            // START TRACKING
-            startTracking(this); // From motionTasks
-        }
-        else
-        {
-            bool mode_success(setTrackingMode(mode)); // Change mode
-            if (!mode_success)
-            { // Check success
-                print_error("Failed to change tracking mode");
-                return;
-            }
-            target_change_flag = true; // Raises flag to kill point_to
-        }
-        break;
+        return;
+    }
+
+    requestedMode = mode; // Applied by the next task() run
+    if (getMotionState() == MOTION_TRACKING && !motionPreempted())
+    {
+        setTrackingMode(mode);
+        target_change_flag = true; // Raises flag to kill point_to
+        retargetTracking();        // The track now reports to this command
+        signalMotionEvent();       // Without waiting for its next poll
+    }
+    else if (!startTracking(this)) // From motionTasks
+    {
+        LOG_ERROR("Failed to start tracking");
     }
 }
 
@@ -72,6 +67,10 @@ bool Tracker::setTrackingMode(TrackingMode mode)
 
     xSemaphoreTake(positionMutex, portMAX_DELAY);
     currentMode = mode;
+    invalidateTrajectory();
+    Target none = target.load();
+    none.time = 0; // No setpoint until the new target is computed
+    target.store(none);
     xSemaphoreGive(positionMutex);
     return true;
 }
@@ -79,25 +78,43 @@ bool Tracker::setTrackingMode(TrackingMode mode)
 // Update target coordinates based on the tracking mode
 void Tracker::updateTargetCoordinates()
 {
-    if (currentMode == IDLE)
+    TrackingMode mode = currentMode;
+    if (mode == IDLE)
     {
         return; // No need to update in IDLE mode
     }
 
-    double az, el;
+    double az, el, azRate, elRate;
+    double now = getCurrentTime();
 
-    switch (currentMode)
+    switch (mode)
     {
     case TRACK_SATELLITE:
-        updateFromTLE(az, el);
+        if (!updateFromTLE(az, el, azRate, elRate))
+        {
+            return;
+        }
         break;
 
     case TRACK_GALACTIC:
-        std::tie(az, el) = galacticToAltAz(l, b);
+    case TRACK_EQUATORIAL:
+    case TRACK_SUN:
+    case TRACK_MOON:
+    case TRACK_PLANET:
+        if (!updateFromTrajectory(az, el))
+        {
+            return;
+        }
+        // Own motion of solar system bodies (< 4 % of sidereal for the
+        // Moon) is left to the position correction
+        std::tie(azRate, elRate) = siderealAltAzRates(az, el);
         break;
 
-    case TRACK_EQUATORIAL:
-        std::tie(az, el) = raDecToAltAz(ra, dec);
+    case TRACK_TABLE:
+        if (!updateFromTable(az, el, azRate, elRate))
+        {
+            return;
+        }
         break;
 
     default:
@@ -108,85 +125,148 @@ void Tracker::updateTargetCoordinates()
     if (isValidPosition(az, el))
     {
         xSemaphoreTake(positionMutex, portMAX_DELAY);
-        targetAz = az;
-        targetEl = el;
+        target.store({az, el, azRate, elRate, now});
         xSemaphoreGive(positionMutex);
     }
     else
     {
-        String az_str(az);
-        String el_str(el);
-        print_warning("Invalid position. Az : " + az_str + ", El : " + el_str);
+        // Every timer tick while the target is out of range
+        LOG_WARNING_EVERY(LOG_RATE_INTERVAL, "Invalid position. Az : " + String(az) + ", El : " + String(el));
     }
 }
 
-// Tracking task to move the antenna
-void Tracker::task()
+// Stops the mount on its last setpoint : position kept, rates zeroed
+static void holdSetpoint(MotionSetpoint &mount, double time)
 {
+    mount.time = time;
+    mount.azRate = mount.elRate = 0;
+    streamSetpoint(mount);
+}
+
+// Tracking task to move the antenna. Slews once onto the target, then
+// streams position + velocity setpoints every TRACK_UPDATE_INTERVAL.
+// Returns false if it could not track at all, or at the end of the uploaded
+// trajectory.
+bool Tracker::task()
+{
+    setTrackingMode(requestedMode);
     if (currentMode == IDLE)
     {
-        return; // No need to run in IDLE mode
+        return false; // Nothing to track
     }
 
     bool status = true;
+    bool streaming = false;    // Mount following the setpoint stream
+    MotionSetpoint mount = {}; // Last setpoint sent to the mount
 
-    setupTrackingTimer(); // Set up the timer to update coordinates
+    refreshAstrometry(); // Slow terms ready before the first timer tick
+    prepareTrajectory(); // And the first segment
+    if (!setupTrackingTimer()) // Timer to update coordinates
+    {
+        stop();
+        return false;
+    }
 
     while (true)
     {
-        print_info("DEBUG : tracking task here");
-        if (ulTaskNotifyTake(pdTRUE, 0))
+        if (motionPreempted())
         {
-            print_info("Stopping tracker...");
+            LOG_INFO("Stopping tracker...");
             stop();
-            print_info("Task gracefully canceled.");
+            if (streaming)
+            {
+                holdSetpoint(mount, getCurrentTime());
+            }
+            LOG_INFO("Task gracefully canceled.");
+            return true; // Back to the motion executor
+        }
+        refreshAstrometry();
+        prepareTrajectory();
 
-            // Notify completion
-            if (startPendingTaskHandle != nullptr)
+        double now = getCurrentTime();
+        if (currentMode == TRACK_TABLE && tableEnded(now))
+        {
+            LOG_WARNING("End of the uploaded trajectory");
+            stop();
+            if (streaming)
             {
-                xTaskNotifyGive(startPendingTaskHandle);
+                holdSetpoint(mount, now); // On the last point
             }
-            print_info("DEBUG : Notification sent.");
-            vTaskDelete(NULL); // Delete this task
+            return false; // The track failed
         }
-        double az, el;
-        xSemaphoreTake(positionMutex, portMAX_DELAY);
-        // TODO get current position
-        az = 50;
-        el = 50;
-        xSemaphoreGive(positionMutex);
 
-        // Check if movement is needed
-        if (needsMovement(az, el))
+        MotionSetpoint target;
+        if (getSetpoint(now, target))
         {
-            // Send command to point to new coordinates
-            print_info("DEBUG : start PointTo");
-            status = pointTo(targetAz, targetEl, &target_change_flag);
-            print_info("DEBUG : pointTo returned");
-            target_change_flag = false;
-            if (!status)
+            // TODO use the encoders ; the mount is assumed on its last setpoint
+            if (!streaming || target_change_flag || needsSlew(mount, target))
             {
-                print_info("Task gracefully canceled.");
-                // Notify completion
-                if (startPendingTaskHandle != nullptr)
+                LOG_DEBUG("start PointTo");
+                status = pointTo(target.az, target.el, &target_change_flag);
+                LOG_DEBUG("pointTo returned");
+                target_change_flag = false;
+                if (!status)
                 {
-                    xTaskNotifyGive(startPendingTaskHandle);
+                    stop();
+                    LOG_INFO("Task gracefully canceled.");
+                    return true; // Slew preempted
                 }
-                vTaskDelete(NULL);
+                // Standing on the slew target, the stream picks up from there
+                mount = target;
+                mount.azRate = mount.elRate = 0;
+                streaming = true;
             }
+            else
+            {
+                streamSetpoint(target);
+                mount = target;
+            }
+        }
+        else if (streaming && (mount.azRate != 0 || mount.elRate != 0))
+        {
+            // No fresh target in range : hold the last valid position
+            LOG_WARNING("No valid target, holding position");
+            holdSetpoint(mount, now);
         }
 
-        vTaskDelay(pdMS_TO_TICKS(TRACK_DELAY)); // Adjust the frequency as needed
+        waitMotionEvent(pdMS_TO_TICKS(TRACK_UPDATE_INTERVAL));
     }
 }
 
-void Tracker::setTLE(const String &newTLE)
+// Extrapolates the last target over TRACK_STALE_INTERVAL at most : the
+// target is not updated while out of range, and its rates would carry the
+// setpoint past the limits
+bool Tracker::getSetpoint(double time, MotionSetpoint &setpoint)
 {
+    Target last = target.load();
+    double dt = time - last.time;
+    if (last.time <= 0 || fabs(dt) > TRACK_STALE_INTERVAL * 1e-3)
+    {
+        return false; // None yet, or stale
+    }
+    setpoint.time = time;
+    setpoint.az = fmod(last.az + last.azRate * dt + 360.0, 360.0);
+    setpoint.el = last.el + last.elRate * dt;
+    setpoint.azRate = last.azRate;
+    setpoint.elRate = last.elRate;
+    return isValidPosition(setpoint.az, setpoint.el);
+}
+
+// Derives the SGP4 constants once, outside of the lock
+Sgp4::Status Tracker::setTLE(const TLE &newTLE)
+{
+    Sgp4 propagator;
+    if (!propagator.init(newTLE))
+    {
+        return propagator.getStatus();
+    }
+
     if (xSemaphoreTake(positionMutex, portMAX_DELAY))
     {
-        tle = newTLE;
+        satellite = propagator;
         xSemaphoreGive(positionMutex);
     }
+    return Sgp4::OK;
 }
 
 void Tracker::setEquatorial(double newRa, double newDec)
@@ -195,9 +275,10 @@ void Tracker::setEquatorial(double newRa, double newDec)
     {
         ra = newRa;
         dec = newDec;
+        invalidateTrajectory();
         xSemaphoreGive(positionMutex);
     }
-    print_info("DEBUG : RADEC updated");
+    LOG_DEBUG("RADEC updated");
 }
 
 void Tracker::setGalactic(double newL, double newB)
@@ -206,14 +287,304 @@ void Tracker::setGalactic(double newL, double newB)
     {
         l = newL;
         b = newB;
+        invalidateTrajectory();
         xSemaphoreGive(positionMutex);
     }
 }
 
-// Update the coordinates based on TLE data (satellite tracking)
-void Tracker::updateFromTLE(double &az, double &el)
+void Tracker::setPlanet(Body body)
 {
-    // Perform TLE-based coordinate calculation (details omitted)
+    if (xSemaphoreTake(positionMutex, portMAX_DELAY))
+    {
+        planet = body;
+        invalidateTrajectory();
+        xSemaphoreGive(positionMutex);
+    }
+}
+
+TableStatus Tracker::addTablePoints(const TrackPoint *points, size_t count)
+{
+    xSemaphoreTake(positionMutex, portMAX_DELAY);
+    TableStatus status = table.addPoints(points, count);
+    xSemaphoreGive(positionMutex);
+    return status;
+}
+
+TableStatus Tracker::addTableSegment(const ChebyshevSegment &segment)
+{
+    xSemaphoreTake(positionMutex, portMAX_DELAY);
+    TableStatus status = table.addSegment(segment);
+    xSemaphoreGive(positionMutex);
+    return status;
+}
+
+void Tracker::clearTable()
+{
+    xSemaphoreTake(positionMutex, portMAX_DELAY);
+    table.clear();
+    xSemaphoreGive(positionMutex);
+}
+
+TrajectoryTable::Info Tracker::getTableInfo()
+{
+    xSemaphoreTake(positionMutex, portMAX_DELAY);
+    TrajectoryTable::Info info = table.getInfo();
+    xSemaphoreGive(positionMutex);
+    return info;
+}
+
+void Tracker::refreshAstrometry()
+{
+    double now = getCurrentTime();
+    if (!astrometry.isStale(now))
+    {
+        return;
+    }
+
+    // Expensive part computed on a copy, so the timer callback never waits on it
+    xSemaphoreTake(positionMutex, portMAX_DELAY);
+    AstrometryContext fresh(astrometry);
+    xSemaphoreGive(positionMutex);
+    if (!fresh.refresh(now))
+    {
+        LOG_WARNING_EVERY(LOG_RATE_INTERVAL, "Astrometry refresh failed");
+        return;
+    }
+
+    xSemaphoreTake(positionMutex, portMAX_DELAY);
+    astrometry = fresh;
+    xSemaphoreGive(positionMutex);
+}
+
+bool Tracker::setPrecision(TrackingMode mode, PrecisionMode precision)
+{
+    switch (mode)
+    {
+    case TRACK_EQUATORIAL:
+        precisionEquatorial = precision;
+        return true;
+    case TRACK_GALACTIC:
+        precisionGalactic = precision;
+        return true;
+    default:
+        return false; // No per-target trigonometry in this mode
+    }
+}
+
+// Evaluates the current trajectory segment, or the next one once the
+// current expired. Never fits : until the tracker task has a segment
+// ready, no update.
+bool Tracker::updateFromTrajectory(double &az, double &el)
+{
+    double now = getCurrentTime();
+
+    xSemaphoreTake(positionMutex, portMAX_DELAY);
+    if (!trajectory.contains(now) && nextTrajectory.contains(now))
+    {
+        trajectory = nextTrajectory;
+        nextTrajectory.invalidate();
+    }
+    bool ready = trajectory.contains(now);
+    if (ready)
+    {
+        trajectory.evaluate(now, az, el);
+    }
+    xSemaphoreGive(positionMutex);
+    return ready;
+}
+
+void Tracker::invalidateTrajectory()
+{
+    trajectory.invalidate();
+    nextTrajectory.invalidate();
+    trajectoryGeneration++;
+}
+
+// Fits the segment covering now if there is none, else the one following
+// the current segment once it ends within TRAJ_FIT_LEAD. The fit runs on
+// copies, outside of the lock ; it is dropped if the target changed
+// meanwhile.
+void Tracker::prepareTrajectory()
+{
+    double now = getCurrentTime();
+
+    xSemaphoreTake(positionMutex, portMAX_DELAY);
+    bool current = trajectory.contains(now) || nextTrajectory.contains(now);
+    double start = now;
+    if (current)
+    {
+        const ChebyshevSegment &last = nextTrajectory.isValid() ? nextTrajectory : trajectory;
+        start = last.getEnd();
+    }
+    bool due = !current || (!nextTrajectory.isValid() && start - now < TRAJ_FIT_LEAD);
+    uint32_t generation = trajectoryGeneration;
+    FitTarget fitTarget = {currentMode, ra, dec, precisionEquatorial, planet};
+    double galacticL = l, galacticB = b;
+    AstrometryContext context(astrometry);
+    xSemaphoreGive(positionMutex);
+
+    if (!due)
+    {
+        return;
+    }
+    switch (fitTarget.mode)
+    {
+    case TRACK_GALACTIC:
+        std::tie(fitTarget.ra, fitTarget.dec) = galacticToEquatorial(galacticL, galacticB);
+        fitTarget.precision = precisionGalactic;
+        break;
+    case TRACK_SUN:
+        fitTarget.body = Body::SUN;
+        break;
+    case TRACK_MOON:
+        fitTarget.body = Body::MOON;
+        break;
+    case TRACK_EQUATORIAL:
+    case TRACK_PLANET:
+        break;
+    default:
+        return; // Not tracked through segments
+    }
+
+    ChebyshevSegment segment;
+    if (!fitTrajectory(fitTarget, generation, context, start, segment))
+    {
+        LOG_WARNING_EVERY(LOG_RATE_INTERVAL, "Trajectory fit failed");
+        return;
+    }
+    if (segment.getMaxError() > MOTION_MIN)
+    {
+        LOG_WARNING_EVERY(LOG_RATE_INTERVAL, "Trajectory error above MOTION_MIN : " +
+                                                 String(segment.getMaxError(), 4U) + " deg");
+    }
+
+    xSemaphoreTake(positionMutex, portMAX_DELAY);
+    if (generation == trajectoryGeneration)
+    {
+        (current ? nextTrajectory : trajectory) = segment;
+    }
+    xSemaphoreGive(positionMutex);
+}
+
+// Fits segment from start, on the slow astrometry terms of context. The
+// ephemeris grid nodes missing are computed here, in the tracker task, ahead
+// of the segment : never on the timer tick.
+bool Tracker::fitTrajectory(const FitTarget &fitTarget, uint32_t generation, AstrometryContext context, double start,
+                            ChebyshevSegment &segment)
+{
+    bool solarSystem = fitTarget.mode == TRACK_SUN || fitTarget.mode == TRACK_MOON || fitTarget.mode == TRACK_PLANET;
+    if (solarSystem && ephemeris.getBody() != fitTarget.body)
+    {
+        ephemeris.setBody(fitTarget.body);
+    }
+    if (generation != ephemerisGeneration)
+    {
+        ephemeris.invalidate(); // e.g. leap second table update : TT changed
+        ephemerisGeneration = generation;
+    }
+
+    // Slow astrometry terms are frozen over the segment
+    if (context.isStale(start) && !context.refresh(start))
+    {
+        return false;
+    }
+    context.setRefreshInterval(2 * TRAJ_SEGMENT_DURATION);
+
+    auto sample = [&](double t, double &az, double &el)
+    {
+        double targetRa = fitTarget.ra, targetDec = fitTarget.dec, distance = 0;
+        if (solarSystem && !ephemeris.raDec(t, targetRa, targetDec, distance))
+        {
+            az = el = NAN;
+            return;
+        }
+        std::tie(az, el) = context.raDecToAltAz(targetRa, targetDec, t, fitTarget.precision);
+        if (solarSystem)
+        {
+            el = topocentricElevation(el, distance);
+        }
+    };
+
+    return segment.fitWithin(start, TRAJ_SEGMENT_DURATION, TRAJ_ORDER, TRAJ_MAX_ERROR, TRAJ_MAX_REFITS, sample);
+}
+
+void Tracker::setAccuracyTier(AccuracyTier tier)
+{
+    xSemaphoreTake(positionMutex, portMAX_DELAY);
+    astrometry.setTier(tier);
+    invalidateTrajectory();
+    xSemaphoreGive(positionMutex);
+}
+
+AccuracyTier Tracker::setPointingBudget(double budget)
+{
+    AccuracyTier tier = cheapestTier(budget);
+    setAccuracyTier(tier);
+    return tier;
+}
+
+void Tracker::invalidateAstrometry()
+{
+    xSemaphoreTake(positionMutex, portMAX_DELAY);
+    astrometry.invalidate();
+    invalidateTrajectory();
+    xSemaphoreGive(positionMutex);
+    siderealTime().invalidate();
+}
+
+double Tracker::getTrajectoryError()
+{
+    xSemaphoreTake(positionMutex, portMAX_DELAY);
+    double error = trajectory.isValid() ? trajectory.getMaxError() : NAN;
+    xSemaphoreGive(positionMutex);
+    return error;
+}
+
+// Interpolates the uploaded trajectory at the current time. Outside of it,
+// no update : the mount holds its position, and past the end the tracking
+// task ends the track (see tableEnded).
+bool Tracker::updateFromTable(double &az, double &el, double &azRate, double &elRate)
+{
+    double now = getCurrentTime();
+
+    xSemaphoreTake(positionMutex, portMAX_DELAY);
+    bool covered = table.sample(now, az, el, azRate, elRate);
+    xSemaphoreGive(positionMutex);
+
+    if (!covered)
+    {
+        LOG_WARNING_EVERY(LOG_RATE_INTERVAL, "No uploaded trajectory at " + String(now, 3U));
+    }
+    return covered;
+}
+
+// True once time is past the last uploaded point or segment, or the table
+// was cleared. Appending more before then extends the track.
+bool Tracker::tableEnded(double time)
+{
+    TrajectoryTable::Info info = getTableInfo();
+    return info.kind == TrajectoryTable::EMPTY || time > info.end;
+}
+
+// Update the coordinates based on TLE data (satellite tracking). Propagated
+// on every tick : LEO passes move too fast for a trajectory segment. Rates
+// come from the SGP4 velocity.
+bool Tracker::updateFromTLE(double &az, double &el, double &azRate, double &elRate)
+{
+    double now = getCurrentTime();
+    double r[3], v[3];
+
+    xSemaphoreTake(positionMutex, portMAX_DELAY);
+    Sgp4::Status status = satellite.propagateAt(now, r, v);
+    xSemaphoreGive(positionMutex);
+
+    if (status != Sgp4::OK)
+    {
+        LOG_WARNING_EVERY(LOG_RATE_INTERVAL, "SGP4 propagation failed : " + String(sgp4StatusToString(status)));
+        return false;
+    }
+    temeToAltAz(r, v, now, az, el, azRate, elRate);
+    return true;
 }
 
 // Update the coordinates for galactic tracking
@@ -229,11 +600,14 @@ bool Tracker::isValidPosition(double az, double el)
     return (az >= AZ_MIN && az <= AZ_MAX && el >= EL_MIN && el <= EL_MAX);
 }
 
-// Check if movement is required
-bool Tracker::needsMovement(double az, double el)
+// Check if a slew is required : target change, or the mount extrapolated
+// along its last setpoint too far behind
+bool Tracker::needsSlew(MotionSetpoint const &mount, MotionSetpoint const &target)
 {
-    // You can add some logic to avoid unnecessary movements, for example:
-    return (abs(targetAz - az) > MOTION_MIN || abs(targetEl - el) > MOTION_MIN);
+    double dt = target.time - mount.time;
+    double azError = remainder(mount.az + mount.azRate * dt - target.az, 360.0);
+    double elError = mount.el + mount.elRate * dt - target.el;
+    return (fabs(azError) > TRACK_SLEW_THRESHOLD || fabs(elError) > TRACK_SLEW_THRESHOLD);
 }
 
 // Periodically update the coordinates (this function is called by the timer)
@@ -243,26 +617,24 @@ void updateCoordinatesPeriodically(TimerHandle_t xTimer)
 }
 
 // Timer setup to periodically call updateCoordinatesPeriodically
-void Tracker::setupTrackingTimer()
+bool Tracker::setupTrackingTimer()
 {
     if (trackingTimer != nullptr)
     {
         stopTrackingTimer();
-        setupTrackingTimer();
-        return;
+        return setupTrackingTimer();
     }
 
-    const TickType_t xFrequency = pdMS_TO_TICKS(100); // 100ms interval
+    const TickType_t xFrequency = pdMS_TO_TICKS(TRACK_UPDATE_INTERVAL);
 
     trackingTimer = xTimerCreate("TrackingTimer", xFrequency, pdTRUE, this, updateCoordinatesPeriodically);
     if (trackingTimer != NULL)
     {
         xTimerStart(trackingTimer, 0);
+        return true;
     }
-    else
-    {
-        print_error("Failed to create timer for tracking.");
-    }
+    LOG_ERROR("Failed to create timer for tracking.");
+    return false;
 }
 
 void Tracker::stopTrackingTimer()
@@ -272,12 +644,12 @@ void Tracker::stopTrackingTimer()
         // Stop and delete the timer
         if (xTimerStop(trackingTimer, 0) == pdFAIL)
         {
-            print_error("Failed to stop the tracking timer.");
+            LOG_ERROR("Failed to stop the tracking timer.");
         }
 
         if (xTimerDelete(trackingTimer, 0) == pdFAIL)
         {
-            print_error("Failed to delete the tracking timer.");
+            LOG_ERROR("Failed to delete the tracking timer.");
         }
         else
         {
@@ -286,6 +658,6 @@ void Tracker::stopTrackingTimer()
     }
     else
     {
-        print_warning("Tracking timer is not running.");
+        LOG_WARNING("Tracking timer is not running.");
     }
 }
@@ -0,0 +1,255 @@
+#include "Trajectory.h"
+
+double ChebyshevSegment::clenshaw(const double *coeffs, int order, double x)
+{
+    double b1 = 0, b2 = 0;
+    for (int j = order; j >= 1; j--)
+    {
+        double b0 = 2 * x * b1 - b2 + coeffs[j];
+        b2 = b1;
+        b1 = b0;
+    }
+    return x * b1 - b2 + coeffs[0] / 2;
+}
+
+void ChebyshevSegment::evaluate(double t, double &az, double &el) const
+{
+    // Map t to [-1, 1] ; slight extrapolation is tolerated
+    double x = (2 * t - t0 - t1) / (t1 - t0);
+
+    az = fmod(clenshaw(azCoeffs, order, x), 360.0);
+    if (az < 0)
+    {
+        az += 360.0;
+    }
+    el = clenshaw(elCoeffs, order, x);
+}
+
+bool ChebyshevSegment::set(double start, double end, int n, const double *az, const double *el)
+{
+    valid = false;
+    if (n < 1 || n > TRAJ_MAX_ORDER || !(end > start))
+    {
+        return false;
+    }
+    for (int j = 0; j <= n; j++)
+    {
+        if (!isfinite(az[j]) || !isfinite(el[j]))
+        {
+            return false;
+        }
+        azCoeffs[j] = az[j];
+        elCoeffs[j] = el[j];
+    }
+    t0 = start;
+    t1 = end;
+    order = n;
+    maxError = 0; // Unknown : the host's responsibility
+    valid = true;
+    return true;
+}
+
+void ChebyshevSegment::evaluateRates(double t, double &azRate, double &elRate) const
+{
+    // Coefficients of the derivative series, same convention as clenshaw()
+    double azDerivative[TRAJ_MAX_ORDER + 1], elDerivative[TRAJ_MAX_ORDER + 1];
+    azDerivative[order] = elDerivative[order] = 0;
+    azDerivative[order - 1] = 2 * order * azCoeffs[order];
+    elDerivative[order - 1] = 2 * order * elCoeffs[order];
+    for (int j = order - 2; j >= 0; j--)
+    {
+        azDerivative[j] = azDerivative[j + 2] + 2 * (j + 1) * azCoeffs[j + 1];
+        elDerivative[j] = elDerivative[j + 2] + 2 * (j + 1) * elCoeffs[j + 1];
+    }
+
+    double x = (2 * t - t0 - t1) / (t1 - t0);
+    double scale = 2 / (t1 - t0); // dx/dt
+    azRate = clenshaw(azDerivative, order, x) * scale;
+    elRate = clenshaw(elDerivative, order, x) * scale;
+}
+
+const char *tableStatusToString(TableStatus status)
+{
+    switch (status)
+    {
+    case TableStatus::OK:
+        return "ok";
+    case TableStatus::FULL:
+        return "table full";
+    case TableStatus::NOT_IN_ORDER:
+        return "times must increase after the last entry";
+    case TableStatus::WRONG_KIND:
+        return "points and segments do not mix, clear first";
+    case TableStatus::INVALID:
+        return "invalid values";
+    default:
+        return "unknown";
+    }
+}
+
+static_assert((TRAJ_TABLE_POINTS & (TRAJ_TABLE_POINTS - 1)) == 0, "TRAJ_TABLE_POINTS must be a power of 2");
+static_assert((TRAJ_TABLE_SEGMENTS & (TRAJ_TABLE_SEGMENTS - 1)) == 0, "TRAJ_TABLE_SEGMENTS must be a power of 2");
+
+void TrajectoryTable::clear()
+{
+    kind = EMPTY;
+    head = tail = 0;
+}
+
+TableStatus TrajectoryTable::addPoints(const TrackPoint *newPoints, size_t count)
+{
+    if (kind == SEGMENTS && head != tail)
+    {
+        return TableStatus::WRONG_KIND;
+    }
+    double last = head != tail ? point(head - 1).time : -INFINITY;
+    for (size_t i = 0; i < count; i++)
+    {
+        const TrackPoint &p = newPoints[i];
+        if (!isfinite(p.time) || !isfinite(p.az) || !isfinite(p.el))
+        {
+            return TableStatus::INVALID;
+        }
+        if (!(p.time > last))
+        {
+            return TableStatus::NOT_IN_ORDER;
+        }
+        last = p.time;
+    }
+    if (count > TRAJ_TABLE_POINTS - (head - tail))
+    {
+        return TableStatus::FULL;
+    }
+
+    kind = POINTS;
+    for (size_t i = 0; i < count; i++, head++)
+    {
+        points[head & (TRAJ_TABLE_POINTS - 1)] = newPoints[i];
+    }
+    return TableStatus::OK;
+}
+
+TableStatus TrajectoryTable::addSegment(const ChebyshevSegment &newSegment)
+{
+    if (kind == POINTS && head != tail)
+    {
+        return TableStatus::WRONG_KIND;
+    }
+    if (!newSegment.isValid())
+    {
+        return TableStatus::INVALID;
+    }
+    if (head != tail && newSegment.getStart() < segment(head - 1).getEnd())
+    {
+        return TableStatus::NOT_IN_ORDER;
+    }
+    if (head - tail >= TRAJ_TABLE_SEGMENTS)
+    {
+        return TableStatus::FULL;
+    }
+
+    kind = SEGMENTS;
+    segments[head++ & (TRAJ_TABLE_SEGMENTS - 1)] = newSegment;
+    return TableStatus::OK;
+}
+
+bool TrajectoryTable::sample(double t, double &az, double &el, double &azRate, double &elRate)
+{
+    switch (kind)
+    {
+    case POINTS:
+        return samplePoints(t, az, el, azRate, elRate);
+    case SEGMENTS:
+        return sampleSegments(t, az, el, azRate, elRate);
+    default:
+        return false;
+    }
+}
+
+// Secant slope between two points, azimuth unwrapped
+static double slope(const TrackPoint &a, const TrackPoint &b, bool azimuth)
+{
+    double delta = azimuth ? remainder((double)b.az - a.az, 360.0) : (double)b.el - a.el;
+    return delta / (b.time - a.time);
+}
+
+bool TrajectoryTable::samplePoints(double t, double &az, double &el, double &azRate, double &elRate)
+{
+    // Drops the points behind, keeping one before the current interval for
+    // its slope
+    while (head - tail >= 3 && point(tail + 2).time <= t)
+    {
+        tail++;
+    }
+    if (head - tail < 2 || t < point(tail).time || t > point(head - 1).time)
+    {
+        return false;
+    }
+
+    // Interval [k, k + 1] containing t
+    uint32_t k = point(tail + 1).time > t ? tail : tail + 1;
+    if (k + 1 == head)
+    {
+        k--; // t on the last point
+    }
+    const TrackPoint &p0 = point(k);
+    const TrackPoint &p1 = point(k + 1);
+    bool hasBefore = k != tail;
+    bool hasAfter = k + 2 != head;
+
+    double h = p1.time - p0.time;
+    double s = (t - p0.time) / h;
+    double s2 = s * s, s3 = s2 * s;
+    double h00 = 2 * s3 - 3 * s2 + 1, h10 = s3 - 2 * s2 + s, h01 = 3 * s2 - 2 * s3, h11 = s3 - s2;
+    double d00 = 6 * s2 - 6 * s, d10 = 3 * s2 - 4 * s + 1, d01 = 6 * s - 6 * s2, d11 = 3 * s2 - 2 * s;
+
+    for (int axis = 0; axis < 2; axis++)
+    {
+        bool azimuth = axis == 0;
+        double secant = slope(p0, p1, azimuth);
+        double m0 = hasBefore ? (slope(point(k - 1), p0, azimuth) + secant) / 2 : secant;
+        double m1 = hasAfter ? (secant + slope(p1, point(k + 2), azimuth)) / 2 : secant;
+        double v0 = azimuth ? p0.az : p0.el;
+        double v1 = v0 + secant * h; // Unwrapped
+        double value = h00 * v0 + h10 * h * m0 + h01 * v1 + h11 * h * m1;
+        double rate = (d00 * v0 + d10 * h * m0 + d01 * v1 + d11 * h * m1) / h;
+        if (azimuth)
+        {
+            az = fmod(value, 360.0);
+            az += az < 0 ? 360.0 : 0;
+            azRate = rate;
+        }
+        else
+        {
+            el = value;
+            elRate = rate;
+        }
+    }
+    return true;
+}
+
+bool TrajectoryTable::sampleSegments(double t, double &az, double &el, double &azRate, double &elRate)
+{
+    while (head != tail && segment(tail).getEnd() < t)
+    {
+        tail++;
+    }
+    if (head == tail || !segment(tail).contains(t))
+    {
+        return false;
+    }
+    segment(tail).evaluate(t, az, el);
+    segment(tail).evaluateRates(t, azRate, elRate);
+    return true;
+}
+
+TrajectoryTable::Info TrajectoryTable::getInfo() const
+{
+    Info info = {head != tail ? kind : EMPTY, head - tail, capacity(), 0, 0};
+    if (head != tail)
+    {
+        info.start = kind == POINTS ? point(tail).time : segment(tail).getStart();
+        info.end = kind == POINTS ? point(head - 1).time : segment(head - 1).getEnd();
+    }
+    return info;
+}
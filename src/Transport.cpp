@@ -0,0 +1,48 @@
+#include "Transport.h"
+
+LineReader::Status LineReader::next(SerialTransport &transport, char *&line)
+{
+    while (true)
+    {
+        if (rxHead == rxTail)
+        {
+            rxHead = 0;
+            rxTail = transport.read(rx, sizeof(rx));
+            if (rxTail == 0)
+            {
+                return NONE;
+            }
+        }
+
+        while (rxHead < rxTail)
+        {
+            char c = (char)rx[rxHead++];
+            if (c == delimiter)
+            {
+                size_t n = length;
+                bool dropped = overflow;
+                length = 0;
+                overflow = false;
+                if (dropped)
+                {
+                    return TOO_LONG;
+                }
+                if (delimiter == '\n' && n > 0 && buffer[n - 1] == '\r')
+                {
+                    n--;
+                }
+                buffer[n] = '\0';
+                line = buffer;
+                return LINE;
+            }
+            if (length + 1 < size)
+            {
+                buffer[length++] = c;
+            }
+            else
+            {
+                overflow = true; // Rest of the line dropped up to '\n'
+            }
+        }
+    }
+}
@@ -0,0 +1,47 @@
+#include "UartTransport.h"
+#include "define.h"
+
+void UartTransport::begin(unsigned long baudrate)
+{
+    serial.setRxBufferSize(SERIAL_RX_BUFFER); // Before begin()
+    serial.begin(baudrate);
+    serial.setRxTimeout(SERIAL_RX_TIMEOUT);
+
+    // Runs in the UART driver event task, not in the interrupt
+    serial.onReceive([this]()
+                     {
+                         TaskHandle_t task = waitingTask;
+                         if (task != nullptr)
+                         {
+                             xTaskNotifyGive(task);
+                         } },
+                     false); // On FIFO threshold as well, not only on idle
+}
+
+size_t UartTransport::read(uint8_t *buffer, size_t size)
+{
+    int available = serial.available();
+    if (available <= 0)
+    {
+        return 0;
+    }
+    return serial.readBytes(buffer, size < (size_t)available ? size : (size_t)available);
+}
+
+size_t UartTransport::write(const uint8_t *data, size_t size)
+{
+    return serial.write(data, size);
+}
+
+bool UartTransport::waitReadable(uint32_t timeoutMs)
+{
+    waitingTask = xTaskGetCurrentTaskHandle();
+    if (serial.available() > 0)
+    {
+        ulTaskNotifyTake(pdTRUE, 0); // Pending events are covered
+        return true;
+    }
+    TickType_t ticks = timeoutMs == TRANSPORT_WAIT_FOREVER ? portMAX_DELAY : pdMS_TO_TICKS(timeoutMs);
+    ulTaskNotifyTake(pdTRUE, ticks);
+    return serial.available() > 0;
+}
@@ -1,21 +1,38 @@
 #include <Arduino.h>
+#include <atomic>
 #include <chrono>
 #include <string>
 #include <vector>
 #include "utils.h"
 #include "motionTasks.h"
 #include "Tracker.h"
+#include "Command.h"
+#include "UartTransport.h"
+#include "Logger.h"
+#include "Log.h"
+#include "Protocol.h"
+#include "Telemetry.h"
+#include "Topics.h"
+#include "Clock.h"
 
 // ================= Global variables =================
 
 // Get singleton instance
 Tracker &tracker = Tracker::getInstance();
 
+// Command link
+UartTransport transport(HWSerial);
+
+// Periodic producers, set by the stream and subscribe commands
+PositionStream positionStream;
+StreamRate timingRate(TIMING_DEFAULT_PERIOD);
+TaskHandle_t positionTask = nullptr;
+TaskHandle_t timingTask = nullptr;
+
 // ================= Prototypes =================
 void receiveTask(void *parameter);
 void broadcast_position_task(void *parameter);
-std::vector<String> splitString(const String &str, char delimiter);
-bool isFloat(const String &str);
+void timing_task(void *parameter);
 
 ErrorStatus getPos(float &az, float &el);
 
@@ -27,222 +44,729 @@ ErrorStatus getEl(float &);
 
 void setup()
 {
-    HWSerial.begin(SERIAL_BAUDRATE);
+    transport.begin(SERIAL_BAUDRATE);
+    startLogger(transport);
+    startMotionExecutor();
 
     // Initializes the serial reader
-    xTaskCreate(receiveTask, "ReceiveTask", 4096, nullptr, 1, nullptr);
-    xTaskCreate(broadcast_position_task, "BroadcastPositionTask", 4096, nullptr, 1, nullptr);
-
-    start_time = 0;
+    xTaskCreate(receiveTask, "ReceiveTask", 6144, nullptr, 1, nullptr);
+    xTaskCreate(broadcast_position_task, "BroadcastPositionTask", 4096, nullptr, 1, &positionTask);
+    xTaskCreate(timing_task, "TimingTask", 3072, nullptr, 1, &timingTask);
 }
 
 void loop()
 {
     vTaskDelay(10000 / portTICK_PERIOD_MS); // Just a placeholder delay
-    print_info("pong");
+    LOG_INFO("pong");
+}
+
+// ================= COMMANDS =================
+
+// Acknowledges a motion command, or its rejection when the queue is full
+static void acknowledgeMotion(bool queued, const String &msg)
+{
+    if (queued)
+    {
+        print_acknowledgement(msg);
+    }
+    else
+    {
+        print_acknowledgement_error("Error : motion command queue full");
+    }
+}
+
+// Trims spaces in place
+static char *trim(char *str)
+{
+    while (*str == ' ')
+    {
+        str++;
+    }
+    size_t length = strlen(str);
+    while (length > 0 && str[length - 1] == ' ')
+    {
+        str[--length] = '\0';
+    }
+    return str;
+}
+
+static void cmdAccuracy(const CommandArgs &args)
+{
+    const char *tier = args.word(0);
+    if (strcmp(tier, "full") == 0)
+    {
+        tracker.setAccuracyTier(AccuracyTier::FULL);
+    }
+    else if (strcmp(tier, "truncated") == 0)
+    {
+        tracker.setAccuracyTier(AccuracyTier::TRUNCATED);
+    }
+    else if (strcmp(tier, "low") == 0)
+    {
+        tracker.setAccuracyTier(AccuracyTier::LOW);
+    }
+    else
+    {
+        print_acknowledgement_error("Error : " + String(args.command().usage));
+        return;
+    }
+    print_acknowledgement("Accuracy tier set to " + String(tier));
+}
+
+static void cmdAccuracyAuto(const CommandArgs &args)
+{
+    AccuracyTier tier = tracker.setPointingBudget(args.number(0));
+    print_acknowledgement("Accuracy tier " + String(tierToString(tier)) + " for a budget of " + args.word(0) + " deg");
+}
+
+// e.g. "synced, offset 0.012 ms, delay 0.850 ms, uncertainty 0.440 ms, drift
+// -12.3 ppm, 40 exchanges, 1 rejected"
+static String describeClock()
+{
+    DisciplinedClock::Status status = deviceClock().getStatus(clockMicros());
+    return String(status.synced ? "synced" : "not synced") + ", offset " + String(status.offset * 1e3, 3U) +
+           " ms, delay " + String(status.delay * 1e3, 3U) + " ms, uncertainty " + String(status.uncertainty * 1e3, 3U) +
+           " ms, drift " + String(status.frequency * 1e6, 1U) + " ppm, " + String(status.accepted) + " exchanges, " +
+           String(status.rejected) + " rejected";
+}
+
+static void cmdClock(const CommandArgs &args)
+{
+    print_acknowledgement_error("Error : " + String(args.command().usage));
+}
+
+// Last clock exchange, completed by clock adjust with the same t1. t3 is
+// stamped by the logger task as the answer is sent.
+static double exchangeT1 = NAN, exchangeT2 = 0;
+static std::atomic<double> exchangeT3(0);
+
+static void stampExchange(double t3)
+{
+    exchangeT3 = t3;
+}
+
+// clock adjust <t1> <t4> : t4 is the host time at which the answer to
+// clock sync <t1> arrived
+static void cmdClockAdjust(const CommandArgs &args)
+{
+    if (args.number(0) != exchangeT1)
+    {
+        print_acknowledgement_error("Error : no clock sync " + String(args.word(0)) + " to complete");
+        return;
+    }
+    exchangeT1 = NAN; // Used once
+    bool accepted = deviceClock().update(args.number(0), exchangeT2, exchangeT3, args.number(1), clockMicros());
+    print_acknowledgement((accepted ? "Clock adjusted : " : "Clock exchange rejected (delay) : ") + describeClock(),
+                          accepted ? ErrorType::NONE : ErrorType::WARNING);
+}
+
+static void cmdClockStatus(const CommandArgs &)
+{
+    print_acknowledgement("Clock : " + describeClock());
+}
+
+// clock sync <t1> : t1 is the host time at which the line was sent. The
+// answer carries t1, t2 (device time at reception) and t3 (device time at
+// which the answer is written to the transport, past the log queue), to be
+// completed by clock adjust.
+static void cmdClockSync(const CommandArgs &args)
+{
+    double t2 = deviceClock().at(clockLastReceive());
+    String answer = "Clock exchange " + String(args.word(0)) + " " + String(t2, 6U) + " ";
+    if (!print_acknowledgement_stamped(answer.c_str(), stampExchange))
+    {
+        print_acknowledgement_error("Error : previous clock sync not sent yet");
+        return;
+    }
+    exchangeT1 = args.number(0);
+    exchangeT2 = t2;
+}
+
+static void cmdGetPos(const CommandArgs &args)
+{
+    // Sends a POSITION message asap, then acknowledges
+    // TODO switch from mock
+    float az;
+    float el;
+    double readTime = getCurrentTime();
+    ErrorStatus status = getPos(az, el);
+    print_position(az, el, status, readTime);
+    print_acknowledgement(args.command().name, status.type);
+}
+
+static void cmdGetTime(const CommandArgs &args)
+{
+    print_acknowledgement(args.command().name);
+    print_timestamp();
+}
+
+static void cmdHome(const CommandArgs &)
+{
+    acknowledgeMotion(startHoming(), "Asking for homing...");
+}
+
+static void cmdLeap(const CommandArgs &args)
+{
+    print_acknowledgement_error("Error : " + String(args.command().usage));
+}
+
+static void cmdLeapAdd(const CommandArgs &args)
+{
+    int status = datAddLeapSecond((int)args.number(0), (int)args.number(1), args.number(2));
+    if (status != 0)
+    {
+        print_acknowledgement_error("Error : leap second rejected (status " + String(status) + ")");
+        return;
+    }
+    tracker.invalidateAstrometry();
+    print_acknowledgement("Leap second added : " + String(args.word(0)) + "-" + args.word(1) + ", TAI-UTC = " + args.word(2));
+}
+
+static void cmdLeapReset(const CommandArgs &)
+{
+    datResetLeapSeconds();
+    tracker.invalidateAstrometry();
+    print_acknowledgement("Leap second table reset");
+}
+
+static void cmdLeapValid(const CommandArgs &args)
+{
+    datSetValidYear((int)args.number(0));
+    print_acknowledgement("Leap second table valid until " + String(args.word(0)));
 }
 
+static void cmdLogStats(const CommandArgs &)
+{
+    LogRing::Stats stats = getLogStats();
+    print_acknowledgement("Log : " + String(stats.written) + " messages, " + String(stats.dropped) + " dropped (" +
+                          String(stats.droppedBytes) + " bytes), high water " + String(stats.highWater) + "/" +
+                          String(LOG_BUFFER_SIZE) + " bytes");
+}
+
+static void cmdPing(const CommandArgs &)
+{
+    print_acknowledgement("pong");
+}
+
+static void cmdPointTo(const CommandArgs &args)
+{
+    acknowledgeMotion(startPointTo(args.number(0), args.number(1)), // Queued only if all checks pass
+                      "Asking pointing task towards az = " + String(args.word(0)) + ", el = " + args.word(1));
+}
+
+static void cmdPrecision(const CommandArgs &args)
+{
+    const char *type = args.word(0);
+    const char *policy = args.word(1);
+    TrackingMode mode = strcmp(type, "radec") == 0 ? TRACK_EQUATORIAL : strcmp(type, "gal") == 0 ? TRACK_GALACTIC
+                                                                                                  : IDLE;
+    bool single = strcmp(policy, "single") == 0;
+    if (mode == IDLE || !(single || strcmp(policy, "double") == 0))
+    {
+        print_acknowledgement_error("Error : invalid precision arguments. Received : " + String(type) + " " + policy);
+        return;
+    }
+    tracker.setPrecision(mode, single ? PrecisionMode::SINGLE : PrecisionMode::DOUBLE);
+    print_acknowledgement("Precision set to " + String(policy) + " for " + type);
+}
+
+// proto <text|binary> switches the link protocol, proto caps lists what is
+// supported. The ack goes out in the mode the command came in.
+static void cmdProto(const CommandArgs &args)
+{
+    ProtocolMode mode;
+    if (strcmp(args.word(0), "caps") == 0)
+    {
+        print_acknowledgement("proto " + String(protocolModeToString(getProtocolMode())) +
+                              ", modes text binary, version " + String(PROTOCOL_VERSION));
+    }
+    else if (protocolModeFromString(args.word(0), mode))
+    {
+        print_acknowledgement("proto " + String(protocolModeToString(mode)) + ", version " + String(PROTOCOL_VERSION));
+        setProtocolMode(mode);
+    }
+    else
+    {
+        print_acknowledgement_error("Error : unsupported protocol " + String(args.word(0)) + ", modes are text and binary");
+    }
+}
+
+// For debugging; remove if not needed
+static void cmdRa2AzAlt(const CommandArgs &args)
+{
+    float az, alt;
+    std::tie(az, alt) = raDecToAltAz(args.number(0), args.number(1));
+    print_acknowledgement("Az: " + String(az, 2U) + ", el: " + String(alt, 2U));
+}
+
+// Batch version of ra2azalt
+static void cmdRa2AzAltBatch(const CommandArgs &args)
+{
+    size_t n = args.count() / 2;
+    if (args.count() % 2 != 0 || n > BATCH_MAX)
+    {
+        print_acknowledgement_error("Error: ra2azalt_batch requires 1 to " + String(BATCH_MAX) + " (ra, dec) pairs.");
+        return;
+    }
+
+    double ra[BATCH_MAX], dec[BATCH_MAX], az[BATCH_MAX], alt[BATCH_MAX];
+    for (size_t i = 0; i < n; i++)
+    {
+        ra[i] = args.number(2 * i);
+        dec[i] = args.number(2 * i + 1);
+    }
+
+    raDecToAltAzBatch(ra, dec, az, alt, n);
+
+    String result = "Az/el:";
+    for (size_t i = 0; i < n; i++)
+    {
+        result += " " + String(az[i], 2U) + " " + String(alt[i], 2U) + (i + 1 < n ? ";" : "");
+    }
+    print_acknowledgement(result);
+}
+
+static void cmdStandby(const CommandArgs &)
+{
+    acknowledgeMotion(startStandby(), "Asking for standby...");
+}
+
+static void cmdStop(const CommandArgs &)
+{
+    acknowledgeMotion(stopMotionTask(), "STOPPING");
+}
+
+static void cmdStopLatency(const CommandArgs &)
+{
+    MotionLatency latency = getMotionLatency();
+    print_acknowledgement("Stop latency : last " + String(latency.last, 3U) + " ms, max " +
+                          String(latency.max, 3U) + " ms over " + String(latency.count) + " stops");
+}
+
+// Wakes the periodic producer of topic, if any, to apply a rate or
+// subscription change at once
+static void notifyProducer(Topic topic)
+{
+    TaskHandle_t task = topic == Topic::POSITION ? positionTask : topic == Topic::TIMING ? timingTask
+                                                                                          : nullptr;
+    if (task != nullptr)
+    {
+        xTaskNotifyGive(task);
+    }
+}
+
+// Acknowledges the stream settings and counters
+static void acknowledgeStream()
+{
+    print_acknowledgement("Stream : " + String(positionStream.getRate(), 1U) + " Hz (period " +
+                          String(positionStream.getPeriodMs()) + " ms), deadband " + String(positionStream.getDeadband(), 4U) +
+                          " deg, " + String(positionStream.getSent()) + " sent, " + String(positionStream.getSuppressed()) +
+                          " suppressed");
+}
+
+// stream <rate_hz> sets the position telemetry rate, 0 for the default
+static void cmdStream(const CommandArgs &args)
+{
+    if (!positionStream.setRate(args.number(0)))
+    {
+        print_acknowledgement_error("Error : stream rate must be between 0 and " + String(STREAM_MAX_RATE) + " Hz");
+        return;
+    }
+    notifyProducer(Topic::POSITION); // New period from now on
+    acknowledgeStream();
+}
+
+static void cmdStreamDeadband(const CommandArgs &args)
+{
+    if (!positionStream.setDeadband(args.number(0)))
+    {
+        print_acknowledgement_error("Error : stream deadband must be positive or 0");
+        return;
+    }
+    acknowledgeStream();
+}
+
+static void cmdStreamStatus(const CommandArgs &)
+{
+    acknowledgeStream();
+}
+
+// Rate of the periodic topics, nullptr for the others
+static StreamRate *topicRate(Topic topic)
+{
+    return topic == Topic::POSITION ? &positionStream : topic == Topic::TIMING ? &timingRate
+                                                                                : nullptr;
+}
+
+// e.g. "position (20 ms)" or "errors (warning)"
+static String describeTopic(Topic topic)
+{
+    StreamRate *rate = topicRate(topic);
+    if (rate != nullptr)
+    {
+        return String(topicToString(topic)) + " (" + String(rate->getPeriodMs()) + " ms)";
+    }
+    return String(topicToString(topic)) + " (" + logLevelToString(getTopicLevel(topic)) + ")";
+}
+
+// subscribe <topic> [rate_hz | level] : a rate for the periodic topics
+// (position, timing), a verbosity for the others
+static void cmdSubscribe(const CommandArgs &args)
+{
+    char *tokens[3];
+    size_t n = tokenize(args.word(0), tokens, 3);
+    Topic topic;
+    if (n == 0 || !topicFromString(tokens[0], topic))
+    {
+        print_acknowledgement_error("Error : unknown topic " + String(args.word(0)) +
+                                    ", topics are position, tracking, errors, debug and timing");
+        return;
+    }
+    StreamRate *rate = topicRate(topic);
+    double hz;
+    int level;
+    if (n == 2 && rate != nullptr && parseNumber(tokens[1], hz))
+    {
+        if (!rate->setRate(hz))
+        {
+            print_acknowledgement_error("Error : topic rate must be between 0 and " + String(STREAM_MAX_RATE) + " Hz");
+            return;
+        }
+    }
+    else if (n == 2 && rate == nullptr && logLevelFromString(tokens[1], level))
+    {
+        setTopicLevel(topic, level);
+    }
+    else if (n != 1)
+    {
+        print_acknowledgement_error("Error : " + String(args.command().usage));
+        return;
+    }
+    subscribe(topic);
+    notifyProducer(topic);
+    String note = topic == Topic::DEBUG && LOG_LEVEL > LOG_LEVEL_DEBUG ? ", debug logs not built in" : "";
+    print_acknowledgement("Subscribed to " + describeTopic(topic) + note);
+}
+
+static void cmdSubscriptions(const CommandArgs &)
+{
+    String list;
+    for (size_t i = 0; i < (size_t)Topic::COUNT; i++)
+    {
+        if (isSubscribed((Topic)i))
+        {
+            list += (list.length() > 0 ? ", " : "") + describeTopic((Topic)i);
+        }
+    }
+    print_acknowledgement("Subscriptions : " + (list.length() > 0 ? list : String("none")));
+}
+
+// One-way : the link delay is not compensated, see clock sync
+static void cmdSyncTime(const CommandArgs &args)
+{
+    deviceClock().set(args.number(0), clockLastReceive());
+    print_acknowledgement("Clock synchronized");
+}
+
+static void cmdTrack(const CommandArgs &args)
+{
+    print_acknowledgement_error("Error : invalid track type. Valid types are radec, gal, tle, sun, moon, planet and traj. Received : " + String(args.word(0)));
+}
+
+static void cmdTrackGal(const CommandArgs &args)
+{
+    tracker.setGalactic(args.number(0), args.number(1));
+    tracker.start(TRACK_GALACTIC);
+    print_acknowledgement("Asked tracking GAL l = " + String(args.word(0)) + ", b = " + args.word(1));
+}
+
+static void cmdTrackMoon(const CommandArgs &)
+{
+    tracker.start(TRACK_MOON);
+    print_acknowledgement("Asked tracking moon");
+}
+
+static void cmdTrackPlanet(const CommandArgs &args)
+{
+    Body body;
+    if (!bodyFromString(args.word(0), body) || body == Body::SUN || body == Body::MOON)
+    {
+        print_acknowledgement_error("Error : " + String(args.command().usage));
+        return;
+    }
+    tracker.setPlanet(body);
+    tracker.start(TRACK_PLANET);
+    print_acknowledgement("Asked tracking " + String(args.word(0)));
+}
+
+static void cmdTrackRaDec(const CommandArgs &args)
+{
+    tracker.setEquatorial(args.number(0), args.number(1));
+    tracker.start(TRACK_EQUATORIAL);
+    print_acknowledgement("Asked tracking RADEC ra = " + String(args.word(0)) + ", dec = " + args.word(1));
+}
+
+static void cmdTrackSun(const CommandArgs &)
+{
+    tracker.start(TRACK_SUN);
+    print_acknowledgement("Asked tracking sun");
+}
+
+static void cmdTrackTle(const CommandArgs &args)
+{
+    // TLE lines contain spaces : the rest of the line is split on '|', in place
+    char *lines[3];
+    size_t n = 0;
+    char *p = args.word(0);
+    lines[n++] = p;
+    while ((p = strchr(p, '|')) != nullptr)
+    {
+        if (n == 3)
+        {
+            n = 0; // Too many parts
+            break;
+        }
+        *p++ = '\0';
+        lines[n++] = p;
+    }
+    if (n < 2)
+    {
+        print_acknowledgement_error("Error : " + String(args.command().usage));
+        return;
+    }
+    const char *name = n == 3 ? trim(lines[0]) : nullptr;
+
+    TLE tle;
+    if (!parseTLE(trim(lines[n - 2]), trim(lines[n - 1]), tle, name))
+    {
+        print_acknowledgement_error("Error : invalid TLE (format or checksum)");
+        return;
+    }
+    Sgp4::Status tleStatus = tracker.setTLE(tle);
+    if (tleStatus != Sgp4::OK)
+    {
+        print_acknowledgement_error("Error : TLE rejected, " + String(sgp4StatusToString(tleStatus)));
+        return;
+    }
+    tracker.start(TRACK_SATELLITE);
+    print_acknowledgement("Asked tracking satellite " + String(tle.satnum));
+}
+
+static void cmdTrackTraj(const CommandArgs &)
+{
+    TrajectoryTable::Info info = tracker.getTableInfo();
+    if (info.kind == TrajectoryTable::EMPTY)
+    {
+        print_acknowledgement_error("Error : no uploaded trajectory, see traj points and traj cheb");
+        return;
+    }
+    if (info.end < getCurrentTime())
+    {
+        print_acknowledgement_error("Error : the uploaded trajectory ended at " + String(info.end, 3U));
+        return;
+    }
+    tracker.start(TRACK_TABLE);
+    print_acknowledgement("Asked tracking the uploaded trajectory");
+}
+
+static void cmdTraj(const CommandArgs &args)
+{
+    print_acknowledgement_error("Error : " + String(args.command().usage));
+}
+
+// Acknowledges an upload with the table coverage
+static void acknowledgeTable(TableStatus status)
+{
+    if (status != TableStatus::OK)
+    {
+        print_acknowledgement_error("Error : trajectory upload rejected, " + String(tableStatusToString(status)));
+        return;
+    }
+    TrajectoryTable::Info info = tracker.getTableInfo();
+    print_acknowledgement("Trajectory : " + String(info.count) + "/" + String(info.capacity) +
+                          (info.kind == TrajectoryTable::SEGMENTS ? " segments" : " points") + ", from " +
+                          String(info.start, 3U) + " to " + String(info.end, 3U) + " (" +
+                          String(info.end - getCurrentTime(), 1U) + " s ahead)");
+}
+
+// traj cheb <t0> <t1> <order> <az0 ... az_order> <el0 ... el_order> : one
+// Chebyshev segment over [t0, t1] (Unix times), azimuth unwrapped
+static void cmdTrajCheb(const CommandArgs &args)
+{
+    double order = args.count() >= 3 ? args.number(2) : 0;
+    if (order != (int)order || order < 1 || order > TRAJ_MAX_ORDER || args.count() != 3 + 2 * ((size_t)order + 1))
+    {
+        print_acknowledgement_error("Error : " + String(args.command().usage) + ", order 1 to " + String(TRAJ_MAX_ORDER));
+        return;
+    }
+    int n = (int)order;
+    double az[TRAJ_MAX_ORDER + 1], el[TRAJ_MAX_ORDER + 1];
+    for (int j = 0; j <= n; j++)
+    {
+        az[j] = args.number(3 + j);
+        el[j] = args.number(4 + n + j);
+    }
+    ChebyshevSegment segment;
+    segment.set(args.number(0), args.number(1), n, az, el);
+    acknowledgeTable(tracker.addTableSegment(segment));
+}
+
+static void cmdTrajClear(const CommandArgs &)
+{
+    tracker.clearTable();
+    print_acknowledgement("Trajectory cleared");
+}
+
+// traj points <t> <az> <el> [<t> <az> <el> ...] : time-tagged points (Unix
+// time, degrees), after the last one uploaded
+static void cmdTrajPoints(const CommandArgs &args)
+{
+    if (args.count() % 3 != 0)
+    {
+        print_acknowledgement_error("Error : " + String(args.command().usage));
+        return;
+    }
+    TrackPoint points[COMMAND_MAX_TOKENS / 3];
+    size_t n = args.count() / 3;
+    for (size_t i = 0; i < n; i++)
+    {
+        points[i] = {args.number(3 * i), (float)args.number(3 * i + 1), (float)args.number(3 * i + 2)};
+    }
+    acknowledgeTable(tracker.addTablePoints(points, n));
+}
+
+static void cmdTrajStatus(const CommandArgs &)
+{
+    acknowledgeTable(TableStatus::OK);
+}
+
+static void cmdUnsubscribe(const CommandArgs &args)
+{
+    Topic topic;
+    if (!topicFromString(args.word(0), topic))
+    {
+        print_acknowledgement_error("Error : unknown topic " + String(args.word(0)));
+        return;
+    }
+    unsubscribe(topic);
+    notifyProducer(topic);
+    print_acknowledgement("Unsubscribed from " + String(topicToString(topic)));
+}
+
+static void cmdUntangle(const CommandArgs &)
+{
+    acknowledgeMotion(startUntangle(), "Asking for untangling...");
+}
+
+// Add commands here, keeping the names sorted
+static constexpr CommandSpec COMMANDS[] = {
+    {"accuracy", "s", cmdAccuracy, "usage is accuracy <full|truncated|low> or accuracy auto <budget_deg>"},
+    {"accuracy auto", "n", cmdAccuracyAuto, "usage is accuracy auto <budget_deg>"},
+    {"clock", "s", cmdClock, "usage is clock sync <t1>, clock adjust <t1> <t4> or clock status"},
+    {"clock adjust", "nn", cmdClockAdjust, "clock adjust needs t1 and t4, host times in seconds"},
+    {"clock status", "", cmdClockStatus, "clock status takes no argument"},
+    {"clock sync", "n", cmdClockSync, "clock sync needs t1, the host time in seconds"},
+    {"get_pos", "", cmdGetPos, "get_pos takes no argument"},
+    {"get_time", "", cmdGetTime, "get_time takes no argument"},
+    {"home", "", cmdHome, "home takes no argument"},
+    {"leap", "s", cmdLeap, "usage is leap add <year> <month> <delta_at>, leap valid <year> or leap reset"},
+    {"leap add", "nnn", cmdLeapAdd, "usage is leap add <year> <month> <delta_at>"},
+    {"leap reset", "", cmdLeapReset, "leap reset takes no argument"},
+    {"leap valid", "n", cmdLeapValid, "usage is leap valid <year>"},
+    {"log_stats", "", cmdLogStats, "log_stats takes no argument"},
+    {"ping", "", cmdPing, "ping takes no argument"},
+    {"point_to", "nn", cmdPointTo, "point_to command requires 2 numbers (az, elev)"},
+    {"precision", "ss", cmdPrecision, "precision needs two arguments : tracking type (radec, gal) and policy (double, single)"},
+    {"proto", "s", cmdProto, "usage is proto <text|binary|caps>"},
+    {"ra2azalt", "nn", cmdRa2AzAlt, "ra2azalt command requires 2 numbers (ra, dec)"},
+    {"ra2azalt_batch", "n+", cmdRa2AzAltBatch, "ra2azalt_batch requires (ra, dec) pairs of numbers"},
+    {"standby", "", cmdStandby, "standby takes no argument"},
+    {"stop", "", cmdStop, "stop takes no argument"},
+    {"stop_latency", "", cmdStopLatency, "stop_latency takes no argument"},
+    {"stream", "n", cmdStream, "usage is stream <rate_hz>, stream deadband <deg> or stream status"},
+    {"stream deadband", "n", cmdStreamDeadband, "usage is stream deadband <deg>"},
+    {"stream status", "", cmdStreamStatus, "stream status takes no argument"},
+    {"subscribe", "*", cmdSubscribe, "usage is subscribe <topic> [rate_hz | debug|info|warning|error]"},
+    {"subscriptions", "", cmdSubscriptions, "subscriptions takes no argument"},
+    {"sync_time", "n", cmdSyncTime, "sync_time needs an argument : timestamp"},
+    {"track", "s", cmdTrack, "track command requires type (radec, gal, tle, sun, moon, planet, traj) and according parameters"},
+    {"track gal", "nn", cmdTrackGal, "track gal needs two numbers : l and b"},
+    {"track moon", "", cmdTrackMoon, "track moon takes no argument"},
+    {"track planet", "s", cmdTrackPlanet, "track planet needs a planet name (mercury ... neptune)"},
+    {"track radec", "nn", cmdTrackRaDec, "track radec needs two numbers : ra and dec"},
+    {"track sun", "", cmdTrackSun, "track sun takes no argument"},
+    {"track tle", "*", cmdTrackTle, "track tle needs [name|]line1|line2"},
+    {"track traj", "", cmdTrackTraj, "track traj takes no argument, upload with traj points or traj cheb first"},
+    {"traj", "s", cmdTraj, "usage is traj points, traj cheb, traj clear or traj status"},
+    {"traj cheb", "n+", cmdTrajCheb, "traj cheb needs t0 t1 order, then order + 1 az and order + 1 el coefficients"},
+    {"traj clear", "", cmdTrajClear, "traj clear takes no argument"},
+    {"traj points", "n+", cmdTrajPoints, "traj points needs (t, az, el) triplets of numbers"},
+    {"traj status", "", cmdTrajStatus, "traj status takes no argument"},
+    {"unsubscribe", "s", cmdUnsubscribe, "usage is unsubscribe <topic>"},
+    {"untangle", "", cmdUntangle, "untangle takes no argument"},
+};
+static_assert(CommandDispatcher::isSorted(COMMANDS), "COMMANDS must be sorted by name");
+static_assert(COMMAND_MAX_TOKENS >= 1 + 2 * BATCH_MAX, "COMMAND_MAX_TOKENS too small for ra2azalt_batch");
+
+static const CommandDispatcher dispatcher(COMMANDS);
+
 // ================= TASKS DEFINITION =================
 
 void receiveTask(void *parameter)
 {
+    static char commandLine[COMMAND_LINE_MAX + 1]; // Parsed in place, no heap allocation
+    LineReader reader(commandLine, sizeof(commandLine));
     while (true)
     {
-        if (HWSerial.available() > 0)
+        // Handles every complete line, then sleeps until the next receive event
+        char *line;
+        LineReader::Status status;
+        while ((status = reader.next(transport, line)) != LineReader::NONE)
         {
-            ErrorStatus status; // None type, empty error message
-            String commandLine = HWSerial.readStringUntil('\n');
-
-            // Split the command line into tokens
-            std::vector<String>
-                tokens = splitString(commandLine, ' ');
-
-            // Check if there is at least one token (the command)
-            if (tokens.size() > 0)
+            clockMarkReceive(); // t2 of a clock exchange
+            if (status == LineReader::TOO_LONG)
             {
-                String cmd_name = tokens[0]; // First token is the command
-
-                // Add commands here
-                if (cmd_name.equals("point_to"))
-                {
-                    if (tokens.size() < 3)
-                    {
-                        print_acknowledgement_error("Error: point_to command requires 2 parameters (az, elev).");
-                        continue; // Skip to the next iteration
-                    }
-
-                    String az_str = tokens[1];
-                    String el_str = tokens[2];
-
-                    if (!isFloat(az_str) || !isFloat(el_str))
-                    {
-                        print_acknowledgement_error("Error: Invalid parameters for point_to. Both must be numbers. Received az = " + az_str + ", el = " + el_str);
-                        continue; // Skip to the next iteration
-                    }
-
-                    float az = az_str.toFloat();
-                    float el = el_str.toFloat();
-
-                    print_acknowledgement("Asking pointing task towards az = " + az_str + ", el = " + el_str);
-                    startPointTo(az, el); // Launch task only if all checks pass
-                }
-                else if (cmd_name.equals("track"))
-                {
-                    if (tokens.size() < 3)
-                    {
-                        print_acknowledgement_error("Error: track command requires type (radec, gal, tle) and according parameters.");
-                        continue; // Skip to the next iteration
-                    }
-                    String trackType = tokens[1];
-                    if (trackType.equals("radec"))
-                    {
-                        if (tokens.size() != 4)
-                        {
-                            print_acknowledgement_error("Error : track radec needs two arguments : ra and dec");
-                            continue;
-                        }
-                        String ra_str = tokens[2];
-                        String dec_str = tokens[3];
-
-                        if (!isFloat(ra_str) || !isFloat(dec_str))
-                        {
-                            print_acknowledgement_error("Error: Invalid parameters for track radec. Both must be numbers. Received ra = " + ra_str + ", dec = " + dec_str);
-                            continue; // Skip to the next iteration
-                        }
-
-                        float ra = ra_str.toFloat();
-                        float dec = dec_str.toFloat();
-
-                        tracker.setEquatorial(ra, dec);
-                        tracker.start(TRACK_EQUATORIAL);
-                        print_acknowledgement("Asked tracking RADEC ra = " + ra_str + ", dec = " + dec_str);
-                    }
-                    else if (trackType.equals("gal"))
-                    {
-                        if (tokens.size() != 4)
-                        {
-                            print_acknowledgement_error("Error : track gal needs two arguments : l and b");
-                            continue;
-                        }
-                        String l_str = tokens[2];
-                        String b_str = tokens[3];
-
-                        if (!isFloat(l_str) || !isFloat(b_str))
-                        {
-                            print_acknowledgement_error("Error: Invalid parameters for track gal. Both must be numbers. Received l = " + l_str + ", b = " + b_str);
-                            continue; // Skip to the next iteration
-                        }
-
-                        float l = l_str.toFloat();
-                        float b = b_str.toFloat();
-
-                        tracker.setGalactic(l, b);
-                        tracker.start(TRACK_GALACTIC);
-                        // TODO change completely receiving framework to JSON, in order to get tle correctly
-                    }
-                    else if (trackType.equals("tle"))
-                    {
-                    }
-                    else
-                    {
-                        print_acknowledgement_error("Error : invalid track type. Valid types are radec, gal and tle. Received : " + trackType);
-                        continue;
-                    }
-                }
-                else if (cmd_name.equals("home"))
-                {
-                    print_acknowledgement("Asking for homing...");
-                    startHoming();
-                }
-                else if (cmd_name.equals("untangle"))
-                {
-                    print_acknowledgement("Asking for untangling...");
-                    startUntangle();
-                }
-                else if (cmd_name.equals("standby"))
-                {
-                    print_acknowledgement("Asking for standby...");
-                    startStandby();
-                }
-                else if (cmd_name.equals("stop"))
+                print_acknowledgement_error("Error : command longer than " + String(COMMAND_LINE_MAX) + " characters");
+                continue;
+            }
+            if (getProtocolMode() == ProtocolMode::BINARY)
+            {
+                // A frame, with no 0 byte once COBS-encoded
+                int length = decodeFrame(reinterpret_cast<uint8_t *>(line), strlen(line));
+                if (length < 1 || line[0] != FRAME_COMMAND)
                 {
-                    print_acknowledgement("STOPPING");
-                    stopMotionTask();
+                    print_acknowledgement_error("Error : corrupt or unknown frame");
+                    continue;
                 }
-                else if (cmd_name.equals("ping"))
-                {
+                line[length] = '\0';
+                line++;
+            }
 
-                    print_acknowledgement("pong");
-                }
-                else if (cmd_name.equals("get_pos"))
-                {
-                    // Sends a POSITION message asap, then acknowledges
-                    // TODO switch from mock
-                    float az;
-                    float el;
-                    status = getPos(az, el);
-                    print_position(az, el, status);
-                    print_acknowledgement(cmd_name, status.type);
-                }
-                else if (cmd_name.equals("get_time"))
-                {
-                    print_acknowledgement(cmd_name);
-                    print_timestamp();
-                }
-                // For debugging; remove if not needed
-                else if (cmd_name.equals("ra2azalt"))
-                {
-                    if (tokens.size() < 3)
-                    {
-                        print_acknowledgement_error("Error: ra2azalt command requires 2 parameters (ra, dec).");
-                        continue; // Skip to the next iteration
-                    }
-
-                    String ra_str = tokens[1];
-                    String dec_str = tokens[2];
-
-                    if (!isFloat(ra_str) || !isFloat(dec_str))
-                    {
-                        print_acknowledgement_error("Error: Invalid parameters for ra2azalt. Both must be numbers. Received az = " + ra_str + ", el = " + dec_str);
-                        continue; // Skip to the next iteration
-                    }
-
-                    float ra = ra_str.toFloat();
-                    float dec = dec_str.toFloat();
-
-                    float az, alt;
-                    std::tie(az, alt) = raDecToAltAz(ra, dec);
-                    ra_str = String(az, 2U);
-                    dec_str = String(alt, 2U);
-                    print_acknowledgement("Az: " + ra_str + ", el: " + dec_str);
-                }
-                else if (cmd_name.equals("sync_time"))
-                {
-                    if (tokens.size() != 2)
-                    {
-                        print_acknowledgement_error("Error : sync_time needs an argument : timestamp");
-                        continue;
-                    }
-                    String timestamp = tokens[1];
-                    if (isFloat(timestamp))
-                    {
-                        start_time = timestamp.toDouble(); // In seconds
-                        print_acknowledgement("Clock synchronized");
-                    }
-                    else
-                    {
-                        print_acknowledgement_error("Error : invalid timestamp. Received : " + timestamp);
-                    }
-                }
-                // Ajouter ici les autres commandes
-                else
-                {
-                    print_acknowledgement_error("Unknown command : " + cmd_name + " wtf les amis");
-                }
+            // Replies to this command, errors included, echo its request ID
+            uint32_t requestId;
+            if (!parseRequestId(line, requestId))
+            {
+                print_acknowledgement_error("Error : request ID must be #<1..4294967295>");
+                continue;
             }
+            setRequestId(requestId);
+
+            const CommandSpec *spec;
+            switch (dispatcher.dispatch(line, spec))
+            {
+            case DispatchStatus::UNKNOWN:
+                print_acknowledgement_error("Unknown command : " + String(line) + " wtf les amis");
+                break;
+            case DispatchStatus::BAD_ARGUMENTS:
+                print_acknowledgement_error("Error : " + String(spec->usage));
+                break;
+            default:
+                break;
+            }
+            setRequestId(REQUEST_ID_NONE);
+            reader.setDelimiter(getProtocolMode() == ProtocolMode::BINARY ? 0 : '\n'); // After proto
         }
-        // HWSerial.readStringUntil('\n'); // Flushes until endline
-        vTaskDelay(10 / portTICK_PERIOD_MS); // Pause pour éviter de monopoliser le processeur
+        transport.waitReadable(TRANSPORT_WAIT_FOREVER);
     }
 }
 // Mock functions to get azimuth and altitude
@@ -275,23 +799,79 @@ ErrorStatus getPos(float &az, float &el)
     return statusAz;
 }
 
-// Broadcast task that sends position data periodically
+// Sleeps while topic has no subscriber ; a subscription restarts the
+// sampling grid from now
+static void waitSubscribed(Topic topic, TickType_t &nextWake)
+{
+    while (!isSubscribed(topic))
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        nextWake = xTaskGetTickCount();
+    }
+}
+
+// Sleeps until the next sample on a fixed grid at rate ; a rate or
+// subscription change (notification) restarts it at once. When late, the
+// grid restarts from now rather than catching up in a burst.
+static void waitNextSample(const StreamRate &rate, TickType_t &nextWake)
+{
+    TickType_t period = pdMS_TO_TICKS(rate.getPeriodMs());
+    nextWake += period > 0 ? period : 1;
+    TickType_t now = xTaskGetTickCount();
+    if ((int32_t)(nextWake - now) <= 0)
+    {
+        nextWake = now + 1;
+    }
+    if (ulTaskNotifyTake(pdTRUE, nextWake - now) > 0)
+    {
+        nextWake = xTaskGetTickCount();
+    }
+}
+
+// Broadcast task : samples the position at the stream rate, sending only the
+// samples that the stream lets through (see Telemetry.h)
 void broadcast_position_task(void *parameter)
 {
+    TickType_t nextWake = xTaskGetTickCount();
     while (true)
     {
-        // Get the current azimuth and altitude values from mock functions
+        waitSubscribed(Topic::POSITION, nextWake);
 
         float az(0);
         float el(0);
-        ErrorStatus status;
 
-        status = getPos(az, el);
+        double readTime = getCurrentTime(); // Stamped at the reading, not at the output
+        ErrorStatus status = getPos(az, el);
+        if (positionStream.accept(az, el, status.type, millis()))
+        {
+            print_position(az, el, status, readTime);
+        }
 
-        // Call the print_position utility function to broadcast the position
-        print_position(az, el, status);
+        waitNextSample(positionStream, nextWake);
+    }
+}
+
+// Timing topic : device time, output statistics, clock and trajectory error
+void timing_task(void *parameter)
+{
+    TickType_t nextWake = xTaskGetTickCount();
+    while (true)
+    {
+        waitSubscribed(Topic::TIMING, nextWake);
+
+        print_timestamp();
+        LogRing::Stats log = getLogStats();
+        print_timing("Uptime " + String(millis()) + " ms, log " + String(log.written) + " messages, " +
+                     String(log.dropped) + " dropped, high water " + String(log.highWater) + " bytes, position " +
+                     String(positionStream.getSent()) + " sent, " + String(positionStream.getSuppressed()) + " suppressed");
+        print_timing("Clock " + describeClock());
+        double trajectoryError = tracker.getTrajectoryError();
+        if (!isnan(trajectoryError))
+        {
+            print_timing("Trajectory error " + String(trajectoryError, 5U) + " deg, " +
+                         (trajectoryError <= MOTION_MIN ? "within" : "above") + " MOTION_MIN " + String(MOTION_MIN, 2U) + " deg");
+        }
 
-        // Wait for the specified delay before broadcasting again
-        vTaskDelay(POSITION_BROADCAST_DELAY / portTICK_PERIOD_MS);
+        waitNextSample(timingRate, nextWake);
     }
 }
@@ -1,8 +1,62 @@
 #include "motionTasks.h"
+#include "Log.h"
+#include "Seqlock.h"
 
-TaskHandle_t motionTaskHandle = nullptr;                 // Tâche point active
-TaskHandle_t startPendingTaskHandle = nullptr;           // Handle for startPointTo task
-SemaphoreHandle_t motionMutex = xSemaphoreCreateMutex(); // Créer le mutex
+static QueueHandle_t motionQueue = nullptr;
+static TaskHandle_t motionTaskHandle = nullptr; // Executor task
+
+// Written by the executor only, read by any task without blocking
+static std::atomic<MotionState> motionState(MOTION_IDLE);
+static Seqlock<MotionLatency> motionLatency;
+static std::atomic<uint32_t> motionRequestId(REQUEST_ID_NONE); // Of the running command, see retargetTracking
+
+const char *motionStateToString(MotionState state)
+{
+    switch (state)
+    {
+    case MOTION_POINTING:
+        return "pointing";
+    case MOTION_HOMING:
+        return "homing";
+    case MOTION_STANDING_BY:
+        return "standby";
+    case MOTION_UNTANGLING:
+        return "untangling";
+    case MOTION_TRACKING:
+        return "tracking";
+    default:
+        return "idle";
+    }
+}
+
+MotionState getMotionState()
+{
+    return motionState;
+}
+
+bool motionPreempted()
+{
+    return uxQueueMessagesWaiting(motionQueue) > 0;
+}
+
+bool waitMotionEvent(TickType_t timeout)
+{
+    // Every submission notifies the executor, which runs all motions
+    return ulTaskNotifyTake(pdTRUE, timeout) > 0;
+}
+
+void signalMotionEvent()
+{
+    if (motionTaskHandle != nullptr)
+    {
+        xTaskNotifyGive(motionTaskHandle);
+    }
+}
+
+MotionLatency getMotionLatency()
+{
+    return motionLatency.load();
+}
 
 // TODO Mocks ; update with real tasks (apm->truc)
 bool pointTo(float const &az, float const &el, bool *stop_flag)
@@ -10,242 +64,207 @@ bool pointTo(float const &az, float const &el, bool *stop_flag)
     for (size_t i(0); i < 50; i++)
     {
         // Vérifier l'annulation
-        if (ulTaskNotifyTakeIndexed(0, pdTRUE, 0))
+        if (motionPreempted())
         {
-            print_info("Point_to task gracefully canceled.");
+            LOG_INFO("Point_to task gracefully canceled.");
             return false; // Exit for loop, stop tracking if applicable
         }
 
         if ((stop_flag != nullptr) && (*stop_flag))
         {
-            print_info("Point_to task gracefully canceled.");
+            LOG_INFO("Point_to task gracefully canceled.");
             return true; // Exit for loop, continue tracking if applicable
         }
 
-        vTaskDelay(1000 / portTICK_PERIOD_MS);
-        print_info("Mock pointing task to az=" + String(az) + ", el=" + String(el));
+        if (waitMotionEvent(pdMS_TO_TICKS(1000)))
+        {
+            continue; // Woken early : check the reason at once
+        }
+        LOG_DEBUG("Mock pointing task to az=" + String(az) + ", el=" + String(el));
     }
-    print_info("For loop exited .");
+    LOG_DEBUG("For loop exited .");
     // apm->point_to(az, elev);  // Commande de pointage asynchrone
     return true;
 }
 
-void pointToTask(void *parameters)
+// Velocity feedforward : the drive follows the rates and corrects the
+// position error, with no stop between setpoints
+bool streamSetpoint(MotionSetpoint const &setpoint)
 {
-    unsigned long currentTime = millis();
-    if (currentTime - lastPointCommandTime < 1000)
-    {
-        print_info("Command ignored: Anti-spam active.");
-        return; // Ignore les commandes trop proches
-    }
-
-    lastPointCommandTime = currentTime;
-
-    auto *args = (float *)parameters;
-    float az = args[0];
-    float el = args[1];
-
-    pointTo(az, el);
-
-    // Notify completion
-    if (startPendingTaskHandle != nullptr)
-    {
-        xTaskNotifyGive(startPendingTaskHandle);
-    }
-    print_info("Notification sent.");
-    delete[] args;     // Libérer la mémoire utilisée
-    vTaskDelete(NULL); // Delete this task
+    // apm->set_velocity(setpoint.azRate, setpoint.elRate, setpoint.az, setpoint.el);
+    return true;
 }
 
-void homingTask(void *parameters)
+// Shared mock loop of homing, standby and untangle
+static bool mockMotion(const char *name)
 {
-    unsigned long currentTime = millis();
-    if (currentTime - lastPointCommandTime < 1000)
-    {
-        print_info("Command ignored: Anti-spam active.");
-        return; // Ignore les commandes trop proches
-    }
-
-    lastPointCommandTime = currentTime;
     for (size_t i(0); i < 50; i++)
     {
         // Vérifier l'annulation
-        if (ulTaskNotifyTake(pdTRUE, 0))
+        if (motionPreempted())
         {
-            print_info("Task gracefully canceled.");
-            break; // Exit for loop
+            LOG_INFO("Task gracefully canceled.");
+            return false;
         }
 
-        vTaskDelay(1000 / portTICK_PERIOD_MS);
-        print_info("Mock homing task here");
+        if (waitMotionEvent(pdMS_TO_TICKS(1000)))
+        {
+            continue;
+        }
+        LOG_DEBUG(String("Mock ") + name + " task here");
     }
-    print_info("For loop exited .");
-    // apm->point_to(az, elev);  // Commande de pointage asynchrone
+    LOG_DEBUG("For loop exited .");
+    return true;
+}
 
-    // Notify completion
-    if (startPendingTaskHandle != nullptr)
-    {
-        xTaskNotifyGive(startPendingTaskHandle);
-    }
-    print_info("Notification sent.");
+bool homing()
+{
+    return mockMotion("homing");
+}
+
+bool standby()
+{
+    return mockMotion("standby");
+}
 
-    vTaskDelete(NULL); // Delete this task
+bool untangle()
+{
+    return mockMotion("untangle");
 }
 
-void standbyTask(void *parameters)
+// Runs one command to completion or preemption, then reports which
+static void executeMotionCommand(MotionCommand const &command)
 {
-    unsigned long currentTime = millis();
-    if (currentTime - lastPointCommandTime < 1000)
+    bool completed = true;
+    const char *failure = "failed : preempted";
+    motionRequestId = command.requestId;
+    switch (command.type)
     {
-        print_info("Command ignored: Anti-spam active.");
-        return; // Ignore les commandes trop proches
+    case MOTION_POINT_TO:
+        motionState = MOTION_POINTING;
+        completed = pointTo(command.az, command.el);
+        break;
+    case MOTION_HOME:
+        motionState = MOTION_HOMING;
+        completed = homing();
+        break;
+    case MOTION_STANDBY:
+        motionState = MOTION_STANDING_BY;
+        completed = standby();
+        break;
+    case MOTION_UNTANGLE:
+        motionState = MOTION_UNTANGLING;
+        completed = untangle();
+        break;
+    case MOTION_TRACK:
+        motionState = MOTION_TRACKING;
+        completed = command.tasker->task(); // Returns when preempted, its normal end
+        failure = "failed";
+        break;
+    case MOTION_STOP:
+        // apm->stop();
+        LOG_INFO("Motion stopped.");
+        break;
     }
+    motionState = MOTION_IDLE;
+    print_event(completed ? "completed" : failure, motionRequestId, completed ? ErrorType::NONE : ErrorType::ERROR);
+}
 
-    lastPointCommandTime = currentTime;
-    for (size_t i(0); i < 50; i++)
+static void motionExecutorTask(void *parameters)
+{
+    MotionCommand command;
+    while (true)
     {
-        // Vérifier l'annulation
-        if (ulTaskNotifyTake(pdTRUE, 0))
+        if (xQueueReceive(motionQueue, &command, portMAX_DELAY) == pdTRUE)
         {
-            print_info("Task gracefully canceled.");
-            break; // Exit for loop
+            if (command.preempting)
+            {
+                MotionLatency latency = motionLatency.load();
+                latency.last = (micros() - command.submitted) / 1000.f;
+                latency.max = fmaxf(latency.max, latency.last);
+                latency.count++;
+                motionLatency.store(latency);
+            }
+            ulTaskNotifyTake(pdTRUE, 0); // This command's wake-up is consumed
+            executeMotionCommand(command);
         }
-
-        vTaskDelay(1000 / portTICK_PERIOD_MS);
-        print_info("Mock standby task here");
     }
-    print_info("For loop exited .");
-    // apm->point_to(az, elev);  // Commande de pointage asynchrone
+}
 
-    // Notify completion
-    if (startPendingTaskHandle != nullptr)
+void startMotionExecutor()
+{
+    if (motionQueue != nullptr)
     {
-        xTaskNotifyGive(startPendingTaskHandle);
+        return;
     }
-    print_info("Notification sent.");
-
-    vTaskDelete(NULL); // Delete this task
-}
 
-void untangleTask(void *parameters)
-{
-    unsigned long currentTime = millis();
-    if (currentTime - lastPointCommandTime < 1000)
+    motionQueue = xQueueCreate(MOTION_QUEUE_LENGTH, sizeof(MotionCommand));
+    if (motionQueue == nullptr ||
+        xTaskCreate(motionExecutorTask, "MotionExecutor", MOTION_TASK_STACK, nullptr, 1, &motionTaskHandle) != pdPASS)
     {
-        print_info("Command ignored: Anti-spam active.");
-        return; // Ignore les commandes trop proches
+        LOG_ERROR("Failed to start the motion executor.");
     }
+}
 
-    lastPointCommandTime = currentTime;
-    for (size_t i(0); i < 50; i++)
+bool submitMotionCommand(MotionCommand const &command)
+{
+    MotionCommand stamped = command;
+    stamped.submitted = micros();
+    stamped.preempting = motionState != MOTION_IDLE;
+    stamped.requestId = getRequestId();
+
+    // A stop is never refused : the commands it would preempt anyway are
+    // dropped to make room
+    if (command.type == MOTION_STOP && motionQueue != nullptr)
     {
-        // Vérifier l'annulation
-        if (ulTaskNotifyTake(pdTRUE, 0))
+        MotionCommand dropped;
+        while (xQueueReceive(motionQueue, &dropped, 0) == pdTRUE)
         {
-            print_info("Task gracefully canceled.");
-            break; // Exit for loop
+            print_event("failed : preempted", dropped.requestId, ErrorType::ERROR);
         }
-
-        vTaskDelay(1000 / portTICK_PERIOD_MS);
-        print_info("Mock untangle task here");
     }
-    print_info("For loop exited .");
-    // apm->point_to(az, elev);  // Commande de pointage asynchrone
 
-    // Notify completion
-    if (startPendingTaskHandle != nullptr)
+    // Never blocks : the running motion is woken and yields
+    if (motionQueue == nullptr || xQueueSend(motionQueue, &stamped, 0) != pdTRUE)
     {
-        xTaskNotifyGive(startPendingTaskHandle);
+        LOG_ERROR("Motion command queue full.");
+        return false;
     }
-    print_info("Notification sent.");
-
-    vTaskDelete(NULL); // Delete this task
+    signalMotionEvent();
+    return true;
 }
 
-// Declare the external task function
-void trackingTask(void *parameters)
+bool startPointTo(float az, float elev)
 {
-    // Cast the parameters to the Tracker object
-    Tasker *trackerInstance = static_cast<Tasker *>(parameters);
-
-    // Now you can call the tracking logic in the Tracker class
-    trackerInstance->task();
+    return submitMotionCommand({MOTION_POINT_TO, az, elev, nullptr, 0, false, REQUEST_ID_NONE});
 }
 
-void stopMotionTask()
+bool startHoming()
 {
-    if (xSemaphoreTake(motionMutex, portMAX_DELAY))
-    {
-        if (motionTaskHandle != nullptr)
-        {
-            print_warning("DEBUG : Previous task still running. Attempting to stop it");
-            startPendingTaskHandle = xTaskGetCurrentTaskHandle(); // Current task waiting for cancellation
-            xTaskNotifyGive(motionTaskHandle);                    // Notify to cancel
-
-            // Wait for confirmation of cancellation
-            if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(TASK_TIMEOUT)) == 0)
-            {
-                vTaskDelete(motionTaskHandle); // Delete this task
-                print_warning("Task stop timed out.");
-            }
-            else
-            {
-                print_info("Motion task stopped.");
-            }
-
-            motionTaskHandle = nullptr; // Reset task handle
-        }
-
-        xSemaphoreGive(motionMutex); // Release the mutex
-    }
+    return submitMotionCommand({MOTION_HOME, 0, 0, nullptr, 0, false, REQUEST_ID_NONE});
 }
 
-void startMotionTask(TaskFunction_t taskFunction, void *args, const char *taskName)
+bool startStandby()
 {
-
-    // First stop previous task if any
-    stopMotionTask();
-
-    // Take/Wait for the lock
-    if (xSemaphoreTake(motionMutex, portMAX_DELAY))
-    {
-        // Start the new task
-        if (xTaskCreate(taskFunction, taskName, 4096, args, 1, &motionTaskHandle) == pdPASS)
-        {
-            print_info(String("New task started: ") + taskName);
-        }
-        else
-        {
-            print_error(String("Failed to create task: ") + taskName);
-            delete[] args; // Free memory if task creation fails
-        }
-
-        xSemaphoreGive(motionMutex); // Release mutex
-    }
+    return submitMotionCommand({MOTION_STANDBY, 0, 0, nullptr, 0, false, REQUEST_ID_NONE});
 }
 
-void startPointTo(float az, float elev)
+bool startUntangle()
 {
-    float *args = new float[2]{az, elev};
-    startMotionTask(pointToTask, args, "PointTo");
+    return submitMotionCommand({MOTION_UNTANGLE, 0, 0, nullptr, 0, false, REQUEST_ID_NONE});
 }
 
-void startHoming()
+bool stopMotionTask()
 {
-    startMotionTask(homingTask, nullptr, "Homing");
+    return submitMotionCommand({MOTION_STOP, 0, 0, nullptr, 0, false, REQUEST_ID_NONE});
 }
 
-void startStandby()
+bool startTracking(Tasker *tracker)
 {
-    startMotionTask(standbyTask, nullptr, "Standby");
+    return submitMotionCommand({MOTION_TRACK, 0, 0, tracker, 0, false, REQUEST_ID_NONE});
 }
 
-void startUntangle()
+void retargetTracking()
 {
-    startMotionTask(untangleTask, nullptr, "Untangle");
+    print_event("completed", motionRequestId.exchange(getRequestId()));
 }
-
-void startTracking(Tasker *tracker)
-{
-    startMotionTask(trackingTask, tracker, "Tracking");
-}
\ No newline at end of file
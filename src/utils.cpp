@@ -1,4 +1,6 @@
 #include "utils.h"
+#include "Command.h"
+#include "Clock.h"
 
 extern std::vector<String> splitString(const String &str, char delimiter)
 {
@@ -21,19 +23,13 @@ extern std::vector<String> splitString(const String &str, char delimiter)
 // Function to check if a string can be converted to float
 bool isFloat(const String &str)
 {
-    char *endptr;
-    str.toFloat(); // Trigger conversion
-    strtod(str.c_str(), &endptr);
-    return (*endptr == '\0'); // Check if the entire string was consumed
+    double value;
+    return parseNumber(str.c_str(), value); // Single pass over the whole string
 }
 
 double getCurrentTime()
 {
-    using namespace std::chrono;
-    auto timestamp = system_clock::now();
-    auto duration = timestamp.time_since_epoch();
-    auto microseconds_duration = duration_cast<microseconds>(duration).count();
-    return (static_cast<double>(microseconds_duration)) / 1.e6f + start_time;
+    return deviceClock().at(clockMicros());
 }
 
 String getCurrentTimestamp()
@@ -42,26 +38,35 @@ String getCurrentTimestamp()
     return String(time_in_seconds, 6U); // Precision to the microsecond
 }
 
-// Convert Unix timestamp to Julian date
-double unixTimeToJD(double const &unixTime)
+// Split at 0h : the fraction is exact to the resolution of unixTime
+JulianDate unixTimeToJD(double unixTime)
 {
-    return unixTime / SECONDS_IN_DAY + UNIX_EPOCH_JD;
+    double days = floor(unixTime / SECONDS_IN_DAY);
+    return {UNIX_EPOCH_JD + days, (unixTime - days * SECONDS_IN_DAY) / SECONDS_IN_DAY};
 }
 
-// Compute Greenwich Mean Sidereal Time
-double computeGMST(double const &jd)
+bool unixTimeToTT(double unixTime, JulianDate &tt)
 {
-    // Split JD into UT1 components using the Date & Time method
-    double uta = floor(jd); // Integer part
-    double utb = jd - uta;  // Fractional day part
+    JulianDate utc = unixTimeToJD(unixTime);
+    double tai1, tai2;
+    if (iauUtctai(utc.day, utc.fraction, &tai1, &tai2) < 0)
+    {
+        return false;
+    }
+    iauTaitt(tai1, tai2, &tt.day, &tt.fraction);
+    return true;
+}
 
+// Compute Greenwich Mean Sidereal Time
+double computeGMST(JulianDate const &ut)
+{
     // NB : If this slows down, just use TT = UT for simplicity
     double tta, ttb, tai1, tai2;
-    iauUtctai(uta, utb, &tai1, &tai2);
+    iauUtctai(ut.day, ut.fraction, &tai1, &tai2);
     iauTaitt(tai1, tai2, &tta, &ttb);
 
     // Call SOFA function to compute GMST in radians
-    double gmst_rad = iauGmst00(uta, utb, tta, ttb);
+    double gmst_rad = iauGmst00(ut.day, ut.fraction, tta, ttb);
 
     // Convert GMST from radians to hours
     double gmst_hours = gmst_rad * 12.0 / M_PI;
@@ -92,18 +97,13 @@ double computeEquationOfEquinoxes(double const &d)
     return deltaPsi * cos(epsilon * DEG_TO_RAD);
 }
 
-// Convert RA/DEC to Alt/Az
-std::tuple<double, double> raDecToAltAz(double ra, double dec, double unixTime)
+// Local apparent sidereal time in degrees, [0, 360)
+double localSiderealTime(double unixTime)
 {
-    if (unixTime + 1 < 1e6f)
-    {
-        unixTime = getCurrentTime();
-    }
-    double jd = unixTimeToJD(unixTime);
-    double d = jd - J2000;
+    JulianDate jd = unixTimeToJD(unixTime); // The one split of this time
 
     double gmst = computeGMST(jd);
-    double eqeq = computeEquationOfEquinoxes(d);
+    double eqeq = computeEquationOfEquinoxes(jd.daysSinceJ2000());
     double gast = gmst + eqeq;
 
     double lst = gast + OBS_LON / 15.0;
@@ -111,7 +111,60 @@ std::tuple<double, double> raDecToAltAz(double ra, double dec, double unixTime)
     if (lst < 0)
         lst += 24.0;
 
-    double hourAngle = (lst * 15.0 - ra);
+    return lst * 15.0;
+}
+
+// The anchor is stale from the start (generation 1)
+SiderealPropagator::SiderealPropagator(double interval)
+    : anchor(Anchor{0, 0, 0}), interval(interval), generation(1), anchors(0)
+{
+}
+
+double SiderealPropagator::at(double unixTime)
+{
+    Anchor last = anchor.load();
+    uint32_t current = generation.load(std::memory_order_relaxed);
+    if (last.generation == current && fabs(unixTime - last.time) <= interval)
+    {
+        double lst = fmod(last.lst + SIDEREAL_RATE_DEG * (unixTime - last.time), 360.0);
+        return lst < 0 ? lst + 360.0 : lst;
+    }
+
+    double lst = localSiderealTime(unixTime);
+    if (!updating.test_and_set(std::memory_order_acquire))
+    {
+        anchor.store({unixTime, lst, current});
+        anchors++;
+        updating.clear(std::memory_order_release);
+    }
+    return lst;
+}
+
+SiderealPropagator &siderealTime()
+{
+    static SiderealPropagator propagator;
+    return propagator;
+}
+
+std::tuple<double, double> siderealAltAzRates(double az, double el)
+{
+    double azRate, elRate;
+    altAzHourAngleRates(az * DEG_TO_RAD, el * DEG_TO_RAD, sin(OBS_LAT * DEG_TO_RAD), cos(OBS_LAT * DEG_TO_RAD),
+                        azRate, elRate);
+    return std::make_tuple(azRate * SIDEREAL_RATE_DEG, elRate * SIDEREAL_RATE_DEG);
+}
+
+// Convert RA/DEC to Alt/Az
+template <class Policy>
+std::tuple<double, double> raDecToAltAz(double ra, double dec, double unixTime)
+{
+    if (unixTime + 1 < 1e6f)
+    {
+        unixTime = getCurrentTime();
+    }
+    double lst = siderealTime().at(unixTime);
+
+    double hourAngle = (lst - ra);
     hourAngle *= DEG_TO_RAD;
 
     double lat;
@@ -119,56 +172,196 @@ std::tuple<double, double> raDecToAltAz(double ra, double dec, double unixTime)
     lat = OBS_LAT * DEG_TO_RAD;
     dec *= DEG_TO_RAD;
 
-    double sh, ch, sd, cd, sp, cp, x, y, z, r, a;
+    double az, alt;
+    hourAngleToAltAz<Policy>(hourAngle, dec, sin(lat), cos(lat), az, alt);
 
-    // Starting from here : taken from SOFA hd2ae.c
-    /* Useful trig functions. */
-    sh = sin(hourAngle);
-    ch = cos(hourAngle);
-    sd = sin(dec);
-    cd = cos(dec);
-    sp = sin(lat);
-    cp = cos(lat);
+    return std::make_tuple(az * RAD_TO_DEG, alt * RAD_TO_DEG);
+}
 
-    /* Az,Alt unit vector. */
-    x = -ch * cd * sp + sd * cp;
-    y = -sh * cd;
-    z = ch * cd * cp + sd * sp;
+std::tuple<double, double> raDecToAltAz(double ra, double dec, double unixTime)
+{
+    return raDecToAltAz<DoublePrecision>(ra, dec, unixTime);
+}
 
-    /* To spherical. */
-    r = sqrt(x * x + y * y);
-    a = (r != 0.0) ? atan2(y, x) : 0.0;
-    double az = (a < 0.0) ? a + 2 * M_PI : a;
-    double alt = atan2(z, r);
+// Convert Galactic to Equatorial (RA, Dec)
+template <class Policy>
+std::tuple<double, double> galacticToEquatorial(double l, double b)
+{
+    double ra, dec;
+    galacticToEquatorial<Policy>(l * DEG_TO_RAD, b * DEG_TO_RAD,
+                                 sin(GALACTIC_NGP_DEC * DEG_TO_RAD), cos(GALACTIC_NGP_DEC * DEG_TO_RAD),
+                                 GALACTIC_NGP_RA * DEG_TO_RAD, GALACTIC_NORTH_LON * DEG_TO_RAD,
+                                 ra, dec);
 
-    return std::make_tuple(az * RAD_TO_DEG, alt * RAD_TO_DEG);
+    return std::make_tuple(ra * RAD_TO_DEG, dec * RAD_TO_DEG);
 }
 
-// Convert Galactic to Equatorial (RA, Dec)
 std::tuple<double, double> galacticToEquatorial(double l, double b)
 {
-    l *= DEG_TO_RAD;
-    b *= DEG_TO_RAD;
+    return galacticToEquatorial<DoublePrecision>(l, b);
+}
+
+template <class Policy>
+std::tuple<double, double> galacticToAltAz(double l, double b, double unixTime)
+{
+    auto [ra, dec] = galacticToEquatorial<Policy>(l, b);
+    return raDecToAltAz<Policy>(ra, dec, unixTime);
+}
 
-    double sinDec = sin(b) * sin(GALACTIC_NGP_DEC * DEG_TO_RAD) +
-                    cos(b) * cos(GALACTIC_NGP_DEC * DEG_TO_RAD) * cos(l - GALACTIC_NORTH_LON * DEG_TO_RAD);
-    double dec = asin(sinDec);
+std::tuple<double, double> galacticToAltAz(double l, double b, double unixTime)
+{
+    return galacticToAltAz<DoublePrecision>(l, b, unixTime);
+}
 
-    double y = cos(b) * sin(l - GALACTIC_NORTH_LON * DEG_TO_RAD);
-    double x = cos(b) * cos(l - GALACTIC_NORTH_LON * DEG_TO_RAD) * sin(GALACTIC_NGP_DEC * DEG_TO_RAD) -
-               sin(b) * cos(GALACTIC_NGP_DEC * DEG_TO_RAD);
+// ================= Batch conversions =================
+// The per-element loops have no branch nor library call without a vector
+// version : with -O3 -ffast-math and SSE4.1 or later (floor), GCC
+// vectorizes them on glibc libmvec. Check with -fopt-info-vec.
 
-    double ra = atan2(y, x) + GALACTIC_NGP_RA * DEG_TO_RAD;
+// Shared loop for a single epoch, LST in degrees
+template <class Policy>
+static void raDecToAltAzKernel(double lst, const double *__restrict__ ra, const double *__restrict__ dec,
+                               double *__restrict__ az, double *__restrict__ alt, size_t n)
+{
+    const double lat = OBS_LAT * DEG_TO_RAD;
+    const double sp = sin(lat);
+    const double cp = cos(lat);
 
-    ra = fmod(ra, 2 * M_PI);
-    if (ra < 0)
-        ra += 2 * M_PI;
+    for (size_t i = 0; i < n; i++)
+    {
+        hourAngleToAltAz<Policy>((lst - ra[i]) * DEG_TO_RAD, dec[i] * DEG_TO_RAD, sp, cp, az[i], alt[i]);
+        az[i] *= RAD_TO_DEG;
+        alt[i] *= RAD_TO_DEG;
+    }
+}
 
-    return std::make_tuple(ra * RAD_TO_DEG, dec * RAD_TO_DEG);
+template <class Policy>
+void raDecToAltAzBatch(const double *ra, const double *dec,
+                       double *az, double *alt, size_t n, double unixTime)
+{
+    if (unixTime + 1 < 1e6f)
+    {
+        unixTime = getCurrentTime();
+    }
+    raDecToAltAzKernel<Policy>(siderealTime().at(unixTime), ra, dec, az, alt, n);
 }
 
-std::tuple<double, double> galacticToAltAz(double l, double b, double unixTime)
+void raDecToAltAzBatch(const double *ra, const double *dec,
+                       double *az, double *alt, size_t n, double unixTime)
+{
+    raDecToAltAzBatch<DoublePrecision>(ra, dec, az, alt, n, unixTime);
+}
+
+template <class Policy>
+void raDecToAltAzBatch(const double *ra, const double *dec, const double *unixTimes,
+                       double *az, double *alt, size_t n)
+{
+    if (n == 0)
+    {
+        return;
+    }
+
+    // Sidereal time at the first epoch only ; the others are propagated at
+    // the mean sidereal rate (drift < 1e-6 deg over a day).
+    const double t0 = unixTimes[0];
+    const double lst0 = siderealTime().at(t0);
+    const double lat = OBS_LAT * DEG_TO_RAD;
+    const double sp = sin(lat);
+    const double cp = cos(lat);
+
+    const double *__restrict__ raIn = ra;
+    const double *__restrict__ decIn = dec;
+    const double *__restrict__ tIn = unixTimes;
+    double *__restrict__ azOut = az;
+    double *__restrict__ altOut = alt;
+
+    for (size_t i = 0; i < n; i++)
+    {
+        double lst = lst0 + SIDEREAL_RATE_DEG * (tIn[i] - t0);
+        hourAngleToAltAz<Policy>((lst - raIn[i]) * DEG_TO_RAD, decIn[i] * DEG_TO_RAD, sp, cp,
+                                 azOut[i], altOut[i]);
+        azOut[i] *= RAD_TO_DEG;
+        altOut[i] *= RAD_TO_DEG;
+    }
+}
+
+void raDecToAltAzBatch(const double *ra, const double *dec, const double *unixTimes,
+                       double *az, double *alt, size_t n)
+{
+    raDecToAltAzBatch<DoublePrecision>(ra, dec, unixTimes, az, alt, n);
+}
+
+template <class Policy>
+void galacticToEquatorialBatch(const double *l, const double *b,
+                               double *ra, double *dec, size_t n)
+{
+    // Hoisted pole terms
+    const double sinNgpDec = sin(GALACTIC_NGP_DEC * DEG_TO_RAD);
+    const double cosNgpDec = cos(GALACTIC_NGP_DEC * DEG_TO_RAD);
+    const double northLon = GALACTIC_NORTH_LON * DEG_TO_RAD;
+    const double ngpRa = GALACTIC_NGP_RA * DEG_TO_RAD;
+
+    const double *__restrict__ lIn = l;
+    const double *__restrict__ bIn = b;
+    double *__restrict__ raOut = ra;
+    double *__restrict__ decOut = dec;
+
+    for (size_t i = 0; i < n; i++)
+    {
+        galacticToEquatorial<Policy>(lIn[i] * DEG_TO_RAD, bIn[i] * DEG_TO_RAD,
+                                     sinNgpDec, cosNgpDec, ngpRa, northLon,
+                                     raOut[i], decOut[i]);
+        raOut[i] *= RAD_TO_DEG;
+        decOut[i] *= RAD_TO_DEG;
+    }
+}
+
+void galacticToEquatorialBatch(const double *l, const double *b,
+                               double *ra, double *dec, size_t n)
+{
+    galacticToEquatorialBatch<DoublePrecision>(l, b, ra, dec, n);
+}
+
+template <class Policy>
+void galacticToAltAzBatch(const double *l, const double *b,
+                          double *az, double *alt, size_t n, double unixTime)
 {
-    auto [ra, dec] = galacticToEquatorial(l, b);
-    return raDecToAltAz(ra, dec, unixTime);
-}
\ No newline at end of file
+    if (unixTime + 1 < 1e6f)
+    {
+        unixTime = getCurrentTime();
+    }
+    const double lst = siderealTime().at(unixTime);
+
+    // RA/Dec intermediates staged through small stack buffers
+    constexpr size_t CHUNK = 32;
+    double ra[CHUNK], dec[CHUNK];
+    for (size_t i = 0; i < n; i += CHUNK)
+    {
+        size_t m = (n - i < CHUNK) ? n - i : CHUNK;
+        galacticToEquatorialBatch<Policy>(l + i, b + i, ra, dec, m);
+        raDecToAltAzKernel<Policy>(lst, ra, dec, az + i, alt + i, m);
+    }
+}
+
+void galacticToAltAzBatch(const double *l, const double *b,
+                          double *az, double *alt, size_t n, double unixTime)
+{
+    galacticToAltAzBatch<DoublePrecision>(l, b, az, alt, n, unixTime);
+}
+
+// Explicit instantiations of the precision policies
+#define INSTANTIATE_TRANSFORMS(Policy)                                                                  \
+    template std::tuple<double, double> raDecToAltAz<Policy>(double, double, double);                 \
+    template std::tuple<double, double> galacticToEquatorial<Policy>(double, double);                 \
+    template std::tuple<double, double> galacticToAltAz<Policy>(double, double, double);              \
+    template void raDecToAltAzBatch<Policy>(const double *, const double *, double *, double *,       \
+                                            size_t, double);                                          \
+    template void raDecToAltAzBatch<Policy>(const double *, const double *, const double *, double *, \
+                                            double *, size_t);                                        \
+    template void galacticToEquatorialBatch<Policy>(const double *, const double *, double *,         \
+                                                    double *, size_t);                                \
+    template void galacticToAltAzBatch<Policy>(const double *, const double *, double *, double *,    \
+                                               size_t, double);
+
+INSTANTIATE_TRANSFORMS(DoublePrecision)
+INSTANTIATE_TRANSFORMS(SinglePrecision)
@@ -0,0 +1,139 @@
+#include <unity.h>
+#include <stdio.h>
+#include "Precision.h"
+#include "Clock.cpp"
+#include "utils.cpp"
+
+// Batch (structure-of-arrays) conversions against the scalar ones, on the
+// same inputs and for both precision policies. N is not a multiple of the
+// galactic chunk, nor of any vector width.
+
+constexpr size_t N = 101;
+constexpr double T0 = 1.7e9;
+
+// Scalar and vectorized libm may differ by a few ulps, in float for
+// SinglePrecision ; the epochs array adds the sidereal propagation
+template <class Policy>
+static double tolerance()
+{
+    return sizeof(typename Policy::real) == sizeof(double) ? 1e-9 : 1e-4;
+}
+
+struct Inputs
+{
+    double lon[N], lat[N], times[N];
+
+    Inputs()
+    {
+        for (size_t i = 0; i < N; i++)
+        {
+            lon[i] = fmod(i * 37.3, 360.0);
+            lat[i] = -85 + fmod(i * 13.7, 170.0);
+            times[i] = T0 + i * 36.0; // Over an hour
+        }
+    }
+};
+
+// Longitude error on the sky : az is ill-defined towards the zenith
+static void assertAngles(double expectedLon, double expectedLat, double lon, double lat, double within)
+{
+    TEST_ASSERT_DOUBLE_WITHIN(within, 0, remainder(lon - expectedLon, 360.0) * cos(expectedLat * DEG_TO_RAD));
+    TEST_ASSERT_DOUBLE_WITHIN(within, expectedLat, lat);
+}
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+template <class Policy>
+static void checkRaDecToAltAz()
+{
+    Inputs in;
+    double az[N], alt[N];
+    raDecToAltAzBatch<Policy>(in.lon, in.lat, az, alt, N, T0);
+    for (size_t i = 0; i < N; i++)
+    {
+        auto [expectedAz, expectedAlt] = raDecToAltAz<Policy>(in.lon[i], in.lat[i], T0);
+        assertAngles(expectedAz, expectedAlt, az[i], alt[i], tolerance<Policy>());
+    }
+}
+
+template <class Policy>
+static void checkRaDecToAltAzEpochs()
+{
+    Inputs in;
+    double az[N], alt[N];
+    raDecToAltAzBatch<Policy>(in.lon, in.lat, in.times, az, alt, N);
+    for (size_t i = 0; i < N; i++)
+    {
+        auto [expectedAz, expectedAlt] = raDecToAltAz<Policy>(in.lon[i], in.lat[i], in.times[i]);
+        // Sidereal time propagated from the first epoch
+        assertAngles(expectedAz, expectedAlt, az[i], alt[i], tolerance<Policy>() + 1e-6);
+    }
+}
+
+template <class Policy>
+static void checkGalacticToEquatorial()
+{
+    Inputs in;
+    double ra[N], dec[N];
+    galacticToEquatorialBatch<Policy>(in.lon, in.lat, ra, dec, N);
+    for (size_t i = 0; i < N; i++)
+    {
+        auto [expectedRa, expectedDec] = galacticToEquatorial<Policy>(in.lon[i], in.lat[i]);
+        assertAngles(expectedRa, expectedDec, ra[i], dec[i], tolerance<Policy>());
+    }
+}
+
+template <class Policy>
+static void checkGalacticToAltAz()
+{
+    Inputs in;
+    double az[N], alt[N];
+    galacticToAltAzBatch<Policy>(in.lon, in.lat, az, alt, N, T0);
+    for (size_t i = 0; i < N; i++)
+    {
+        auto [expectedAz, expectedAlt] = galacticToAltAz<Policy>(in.lon[i], in.lat[i], T0);
+        assertAngles(expectedAz, expectedAlt, az[i], alt[i], tolerance<Policy>());
+    }
+}
+
+void test_ra_dec_to_alt_az_batch()
+{
+    checkRaDecToAltAz<DoublePrecision>();
+    checkRaDecToAltAz<SinglePrecision>();
+    raDecToAltAzBatch(nullptr, nullptr, nullptr, nullptr, 0, T0); // Empty
+}
+
+void test_ra_dec_to_alt_az_epochs_batch()
+{
+    checkRaDecToAltAzEpochs<DoublePrecision>();
+    checkRaDecToAltAzEpochs<SinglePrecision>();
+    raDecToAltAzBatch(nullptr, nullptr, nullptr, nullptr, nullptr, 0);
+}
+
+void test_galactic_to_equatorial_batch()
+{
+    checkGalacticToEquatorial<DoublePrecision>();
+    checkGalacticToEquatorial<SinglePrecision>();
+}
+
+void test_galactic_to_alt_az_batch()
+{
+    checkGalacticToAltAz<DoublePrecision>();
+    checkGalacticToAltAz<SinglePrecision>();
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_ra_dec_to_alt_az_batch);
+    RUN_TEST(test_ra_dec_to_alt_az_epochs_batch);
+    RUN_TEST(test_galactic_to_equatorial_batch);
+    RUN_TEST(test_galactic_to_alt_az_batch);
+    UNITY_END();
+}
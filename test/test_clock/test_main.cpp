@@ -0,0 +1,160 @@
+#include <unity.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "Clock.cpp"
+
+// Disciplined clock : offset and delay of an exchange, stepping, slewing
+// without going backwards, delay outliers, and the error over a session
+// against a drifting oscillator, compared with the former one-way sync_time
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+static const double epoch = 1700000000.0;
+
+// Link of the simulated session : 0.3 to 0.5 ms each way, plus a queueing
+// spike of 5 to 40 ms on one direction in 1 exchange out of 10
+static double linkDelay()
+{
+    double delay = 0.3e-3 + 0.2e-3 * rand() / RAND_MAX;
+    if (rand() % 20 == 0)
+    {
+        delay += 5e-3 + 35e-3 * rand() / RAND_MAX;
+    }
+    return delay;
+}
+
+// Device oscillator running drift fast : counter value at true time t
+static int64_t counterAt(double t, double drift)
+{
+    return (int64_t)llround((t - epoch + 10) * (1 + drift) * 1e6);
+}
+
+void test_exchange()
+{
+    DisciplinedClock clock;
+    TEST_ASSERT_FALSE(clock.getStatus(0).synced);
+
+    // Device 2 s behind the host, 10 ms each way, 1 ms to answer
+    clock.set(epoch - 2, 0);
+    double t1 = epoch, t2 = clock.at(10000), t3 = clock.at(11000), t4 = epoch + 0.021;
+    TEST_ASSERT_TRUE(clock.update(t1, t2, t3, t4, 11000));
+    DisciplinedClock::Status status = clock.getStatus(11000);
+    TEST_ASSERT_TRUE(status.synced);
+    TEST_ASSERT_DOUBLE_WITHIN(1e-6, 2.0, status.offset);
+    TEST_ASSERT_DOUBLE_WITHIN(1e-6, 0.020, status.delay);
+    TEST_ASSERT_DOUBLE_WITHIN(1e-6, 0.010, status.uncertainty);
+    TEST_ASSERT_DOUBLE_WITHIN(1e-6, epoch + 0.011, clock.at(11000)); // Stepped
+}
+
+// Small offsets are slewed in at CLOCK_MAX_SLEW : no jump, never backwards
+void test_slew()
+{
+    DisciplinedClock clock;
+    clock.set(epoch, 0);
+    TEST_ASSERT_TRUE(clock.update(epoch, epoch, epoch, epoch, 0));
+
+    int64_t local = 1000000;
+    double before = clock.at(local);
+    double offset = -0.05; // Device 50 ms ahead
+    TEST_ASSERT_TRUE(clock.update(before + offset, before, before, before + offset, local));
+    double frequency = clock.getStatus(local).frequency;
+    TEST_ASSERT_DOUBLE_WITHIN(1e-9, before, clock.at(local));
+
+    double last = before;
+    for (int64_t t = local; t <= local + 200000000; t += 10000)
+    {
+        double now = clock.at(t);
+        TEST_ASSERT_TRUE(now >= last);
+        last = now;
+    }
+    double slewTime = fabs(offset) / CLOCK_MAX_SLEW;
+    TEST_ASSERT_DOUBLE_WITHIN(1e-6, before + slewTime * (1 + frequency) + offset, clock.at(local + (int64_t)(slewTime * 1e6)));
+    TEST_ASSERT_DOUBLE_WITHIN(1e-6, before + 200 * (1 + frequency) + offset, clock.at(local + 200000000));
+}
+
+void test_outlier()
+{
+    DisciplinedClock clock;
+    clock.set(epoch, 0);
+    for (int i = 0; i < 4; i++)
+    {
+        double t = epoch + i;
+        TEST_ASSERT_TRUE(clock.update(t - 0.0005, t, t, t + 0.0005, i * 1000000));
+    }
+    double t = epoch + 4;
+    TEST_ASSERT_FALSE(clock.update(t - 0.0305, t, t, t + 0.0005, 4000000)); // 30 ms of queueing
+    TEST_ASSERT_FALSE(clock.update(t - 0.0005, t, t + 0.002, t + 0.0005, 4000000)); // Negative delay
+    DisciplinedClock::Status status = clock.getStatus(4000000);
+    TEST_ASSERT_EQUAL(4, status.accepted);
+    TEST_ASSERT_EQUAL(2, status.rejected);
+    TEST_ASSERT_DOUBLE_WITHIN(1e-9, 0, status.offset); // Not taken in
+}
+
+// Half an hour against an oscillator 40 ppm fast, one exchange every 4 s :
+// error before each exchange, the worst case, after the first 5 minutes
+void test_session()
+{
+    const double drift = 40e-6, duration = 1800, period = 4;
+    srand(1);
+
+    DisciplinedClock clock, legacy;
+    double t = epoch;
+    legacy.set(t, counterAt(t + linkDelay(), drift)); // sync_time : one way
+
+    double worst = 0, legacyWorst = 0, uncertainty = 0, last = 0;
+    bool covered = true;
+    for (; t < epoch + duration; t += period)
+    {
+        int64_t local = counterAt(t, drift);
+        DisciplinedClock::Status status = clock.getStatus(local);
+        double error = fabs(clock.at(local) - t);
+        if (t > epoch + 300)
+        {
+            worst = fmax(worst, error);
+            uncertainty = fmax(uncertainty, status.uncertainty);
+            covered = covered && error <= status.uncertainty;
+        }
+        legacyWorst = fmax(legacyWorst, fabs(legacy.at(local) - t));
+
+        double t1 = t;
+        double received = t1 + linkDelay();
+        double t2 = clock.at(counterAt(received, drift));
+        double t3 = clock.at(counterAt(received + 0.002, drift)); // Handling
+        double t4 = received + 0.002 + linkDelay();
+        clock.update(t1, t2, t3, t4, counterAt(received + 0.002, drift));
+
+        // Readings until the next exchange, e.g. timestamps of position samples
+        for (double s = received + 0.01; s < t + period; s += 0.1)
+        {
+            double now = clock.at(counterAt(s, drift));
+            TEST_ASSERT_TRUE(now >= last);
+            last = now;
+        }
+    }
+
+    DisciplinedClock::Status status = clock.getStatus(counterAt(t, drift));
+    printf("disciplined : %.3f ms worst error, %.3f ms worst uncertainty, %.2f ppm drift, %u accepted, %u rejected\n",
+           worst * 1e3, uncertainty * 1e3, status.frequency * 1e6, status.accepted, status.rejected);
+    printf("one-way sync_time : %.3f ms worst error\n", legacyWorst * 1e3);
+    TEST_ASSERT_TRUE(worst < 0.5e-3);
+    TEST_ASSERT_TRUE(covered);
+    TEST_ASSERT_DOUBLE_WITHIN(2e-6, -drift / (1 + drift), status.frequency);
+    TEST_ASSERT_TRUE(status.rejected > 0);
+    TEST_ASSERT_TRUE(legacyWorst > 50 * worst);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_exchange);
+    RUN_TEST(test_slew);
+    RUN_TEST(test_outlier);
+    RUN_TEST(test_session);
+    return UNITY_END();
+}
@@ -0,0 +1,305 @@
+#include <unity.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <new>
+#include <string>
+#include <vector>
+#include "Command.cpp"
+
+// Command tokenizer and dispatcher : parsing, lookup, and a benchmark of
+// commands per second and heap bytes per command, against the former
+// split-into-strings parsing
+
+static size_t heapBytes = 0; // Allocated since the last reset
+
+void *operator new(size_t size)
+{
+    heapBytes += size;
+    void *p = malloc(size);
+    if (p == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void *p) noexcept
+{
+    free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+    free(p);
+}
+
+static const char *lastCommand = nullptr;
+static double lastSum = 0;
+static size_t lastCount = 0;
+static char lastWord[128];
+
+static void record(const CommandArgs &args)
+{
+    lastCommand = args.command().name;
+    lastCount = args.count();
+    lastSum = 0;
+    lastWord[0] = '\0';
+    for (size_t i = 0; i < args.count(); i++)
+    {
+        if (args.command().signature[0] == 'n')
+        {
+            lastSum += args.number(i);
+        }
+    }
+    if (args.count() > 0)
+    {
+        strncpy(lastWord, args.word(0), sizeof(lastWord) - 1);
+    }
+}
+
+// Same names and signatures as the firmware table
+static constexpr CommandSpec COMMANDS[] = {
+    {"accuracy", "s", record, ""},
+    {"accuracy auto", "n", record, ""},
+    {"get_pos", "", record, ""},
+    {"get_time", "", record, ""},
+    {"home", "", record, ""},
+    {"leap", "s", record, ""},
+    {"leap add", "nnn", record, ""},
+    {"leap reset", "", record, ""},
+    {"leap valid", "n", record, ""},
+    {"ping", "", record, ""},
+    {"point_to", "nn", record, ""},
+    {"precision", "ss", record, ""},
+    {"ra2azalt", "nn", record, ""},
+    {"ra2azalt_batch", "n+", record, ""},
+    {"standby", "", record, ""},
+    {"stop", "", record, ""},
+    {"stop_latency", "", record, ""},
+    {"sync_time", "n", record, ""},
+    {"track", "s", record, ""},
+    {"track gal", "nn", record, ""},
+    {"track moon", "", record, ""},
+    {"track planet", "s", record, ""},
+    {"track radec", "nn", record, ""},
+    {"track sun", "", record, ""},
+    {"track tle", "*", record, ""},
+    {"untangle", "", record, ""},
+};
+static_assert(CommandDispatcher::isSorted(COMMANDS), "COMMANDS must be sorted by name");
+
+static const CommandDispatcher dispatcher(COMMANDS);
+
+static DispatchStatus run(const char *text)
+{
+    static char line[1024];
+    strcpy(line, text);
+    const CommandSpec *spec;
+    lastCommand = nullptr;
+    return dispatcher.dispatch(line, spec);
+}
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+void test_tokenize()
+{
+    char line[] = "  track  radec 12.5 -3 ";
+    char *tokens[8];
+    TEST_ASSERT_EQUAL(4, tokenize(line, tokens, 8));
+    TEST_ASSERT_EQUAL_STRING("track", tokens[0]);
+    TEST_ASSERT_EQUAL_STRING("radec", tokens[1]);
+    TEST_ASSERT_EQUAL_STRING("12.5", tokens[2]);
+    TEST_ASSERT_EQUAL_STRING("-3", tokens[3]);
+
+    char rest[] = "a b c d";
+    TEST_ASSERT_EQUAL(2, tokenize(rest, tokens, 2));
+    TEST_ASSERT_EQUAL_STRING("b c d", tokens[1]);
+
+    double value;
+    TEST_ASSERT_TRUE(parseNumber("-1.5e3", value));
+    TEST_ASSERT_EQUAL_DOUBLE(-1500, value);
+    TEST_ASSERT_FALSE(parseNumber("", value));
+    TEST_ASSERT_FALSE(parseNumber("12x", value));
+}
+
+void test_dispatch()
+{
+    TEST_ASSERT_EQUAL(DispatchStatus::OK, run("ping"));
+    TEST_ASSERT_EQUAL_STRING("ping", lastCommand);
+
+    // Two-word commands first, one-word fallback
+    TEST_ASSERT_EQUAL(DispatchStatus::OK, run("track radec 10 20"));
+    TEST_ASSERT_EQUAL_STRING("track radec", lastCommand);
+    TEST_ASSERT_EQUAL_DOUBLE(30, lastSum);
+    TEST_ASSERT_EQUAL(DispatchStatus::OK, run("track foo"));
+    TEST_ASSERT_EQUAL_STRING("track", lastCommand);
+    TEST_ASSERT_EQUAL(DispatchStatus::OK, run("accuracy auto 0.1"));
+    TEST_ASSERT_EQUAL_STRING("accuracy auto", lastCommand);
+    TEST_ASSERT_EQUAL(DispatchStatus::OK, run("accuracy low"));
+    TEST_ASSERT_EQUAL_STRING("accuracy", lastCommand);
+
+    TEST_ASSERT_EQUAL(DispatchStatus::EMPTY, run("   "));
+    TEST_ASSERT_EQUAL(DispatchStatus::UNKNOWN, run("pong"));
+    TEST_ASSERT_EQUAL(DispatchStatus::UNKNOWN, run("trackradec 1 2"));
+
+    // Signatures
+    TEST_ASSERT_EQUAL(DispatchStatus::BAD_ARGUMENTS, run("point_to 10"));
+    TEST_ASSERT_EQUAL(DispatchStatus::BAD_ARGUMENTS, run("point_to 10 20 30"));
+    TEST_ASSERT_EQUAL(DispatchStatus::BAD_ARGUMENTS, run("point_to 10 abc"));
+    TEST_ASSERT_EQUAL(DispatchStatus::BAD_ARGUMENTS, run("ping 1"));
+    TEST_ASSERT_EQUAL(DispatchStatus::BAD_ARGUMENTS, run("ra2azalt_batch"));
+    TEST_ASSERT_EQUAL(DispatchStatus::OK, run("ra2azalt_batch 1 2 3 4"));
+    TEST_ASSERT_EQUAL(4, lastCount);
+    TEST_ASSERT_EQUAL_DOUBLE(10, lastSum);
+
+    // Raw rest of the line
+    TEST_ASSERT_EQUAL(DispatchStatus::OK, run("track tle ISS |1 25544U 98067A| 2 25544  51.6"));
+    TEST_ASSERT_EQUAL(1, lastCount);
+    TEST_ASSERT_EQUAL_STRING("ISS |1 25544U 98067A| 2 25544  51.6", lastWord);
+}
+
+void test_request_id()
+{
+    uint32_t id;
+    char tagged[] = "#42 point_to 10 20";
+    char *line = tagged;
+    TEST_ASSERT_TRUE(parseRequestId(line, id));
+    TEST_ASSERT_EQUAL(42, id);
+    TEST_ASSERT_EQUAL(DispatchStatus::OK, run(line));
+    TEST_ASSERT_EQUAL_STRING("point_to", lastCommand);
+
+    char plain[] = "ping";
+    line = plain;
+    TEST_ASSERT_TRUE(parseRequestId(line, id));
+    TEST_ASSERT_EQUAL(0, id);
+    TEST_ASSERT_EQUAL_PTR(plain, line);
+
+    char max[] = "#4294967295";
+    line = max;
+    TEST_ASSERT_TRUE(parseRequestId(line, id));
+    TEST_ASSERT_EQUAL_UINT32(4294967295u, id);
+    TEST_ASSERT_EQUAL(DispatchStatus::EMPTY, run(line));
+
+    const char *invalid[] = {"#0 ping", "#4294967296 ping", "#-1 ping", "#12ab ping", "# ping", "#+3 ping"};
+    for (const char *text : invalid)
+    {
+        char buffer[32];
+        strcpy(buffer, text);
+        line = buffer;
+        TEST_ASSERT_FALSE(parseRequestId(line, id));
+    }
+}
+
+void test_too_many_arguments()
+{
+    std::string line = "ra2azalt_batch";
+    for (int i = 0; i < COMMAND_MAX_TOKENS - 1; i++)
+    {
+        line += " 1";
+    }
+    TEST_ASSERT_EQUAL(DispatchStatus::OK, run(line.c_str()));
+    TEST_ASSERT_EQUAL(COMMAND_MAX_TOKENS - 1, lastCount);
+    line += " 1";
+    TEST_ASSERT_EQUAL(DispatchStatus::BAD_ARGUMENTS, run(line.c_str()));
+}
+
+// Former parsing : split into heap strings, then compare the names in turn
+static std::vector<std::string> splitLegacy(const std::string &str, char delimiter)
+{
+    std::vector<std::string> tokens;
+    size_t start = 0, end;
+    while ((end = str.find(delimiter, start)) != std::string::npos)
+    {
+        tokens.push_back(str.substr(start, end - start));
+        start = end + 1;
+    }
+    tokens.push_back(str.substr(start));
+    return tokens;
+}
+
+static size_t legacyDispatch(const std::string &commandLine)
+{
+    std::vector<std::string> tokens = splitLegacy(commandLine, ' ');
+    for (const CommandSpec &spec : COMMANDS)
+    {
+        std::string name = tokens.size() > 1 && strchr(spec.name, ' ') ? tokens[0] + " " + tokens[1] : tokens[0];
+        if (name == spec.name)
+        {
+            double sum = 0;
+            for (size_t i = 1; i < tokens.size(); i++)
+            {
+                char *end;
+                strtod(tokens[i].c_str(), &end); // isFloat, then toFloat
+                sum += strtod(tokens[i].c_str(), &end);
+            }
+            return (size_t)sum;
+        }
+    }
+    return 0;
+}
+
+static const char *const WORKLOAD[] = {
+    "ping",
+    "get_pos",
+    "point_to 123.456 45.678",
+    "track radec 83.633 22.0145",
+    "track planet jupiter",
+    "ra2azalt_batch 10 20 30 40 50 60 70 80",
+    "stop",
+    "untangle",
+};
+static const size_t WORKLOAD_SIZE = sizeof(WORKLOAD) / sizeof(WORKLOAD[0]);
+
+void test_command_benchmark()
+{
+    const size_t n = 200000;
+    static char line[256];
+    const CommandSpec *spec;
+
+    heapBytes = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < n; i++)
+    {
+        strcpy(line, WORKLOAD[i % WORKLOAD_SIZE]);
+        dispatcher.dispatch(line, spec);
+    }
+    auto stop = std::chrono::steady_clock::now();
+    double rate = n / std::chrono::duration<double>(stop - start).count();
+    double bytes = (double)heapBytes / n;
+
+    std::vector<std::string> lines(WORKLOAD, WORKLOAD + WORKLOAD_SIZE);
+    size_t sink = 0;
+    heapBytes = 0;
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < n; i++)
+    {
+        sink += legacyDispatch(lines[i % WORKLOAD_SIZE]);
+    }
+    stop = std::chrono::steady_clock::now();
+    double legacyRate = n / std::chrono::duration<double>(stop - start).count();
+    double legacyBytes = (double)heapBytes / n;
+
+    printf("table dispatch : %.0f commands/s, %.1f heap bytes/command\n", rate, bytes);
+    printf("split strings  : %.0f commands/s, %.1f heap bytes/command (%zu)\n", legacyRate, legacyBytes, sink % 2);
+    TEST_ASSERT_EQUAL_DOUBLE(0, bytes);
+    TEST_ASSERT_TRUE(rate > legacyRate);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_tokenize);
+    RUN_TEST(test_dispatch);
+    RUN_TEST(test_request_id);
+    RUN_TEST(test_too_many_arguments);
+    RUN_TEST(test_command_benchmark);
+    return UNITY_END();
+}
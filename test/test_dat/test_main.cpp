@@ -0,0 +1,111 @@
+#include <unity.h>
+#include <stdio.h>
+#include <chrono>
+
+extern "C"
+{
+#include <sofa.h>
+#include <leapsec.h>
+}
+
+// Leap second cache and run-time table of iauDat (lib/sofa/src/dat.c)
+
+void setUp(void)
+{
+    datResetLeapSeconds();
+}
+
+void tearDown(void)
+{
+    datResetLeapSeconds();
+}
+
+void test_cached_values()
+{
+    double dat;
+    // Miss, then hits in the same range, then a different range
+    TEST_ASSERT_EQUAL(0, iauDat(2024, 1, 1, 0.0, &dat));
+    TEST_ASSERT_EQUAL(37.0, dat);
+    TEST_ASSERT_EQUAL(0, iauDat(2024, 6, 15, 0.5, &dat));
+    TEST_ASSERT_EQUAL(37.0, dat);
+    TEST_ASSERT_EQUAL(0, iauDat(2016, 12, 31, 0.0, &dat));
+    TEST_ASSERT_EQUAL(36.0, dat);
+    TEST_ASSERT_EQUAL(0, iauDat(2017, 1, 1, 0.0, &dat));
+    TEST_ASSERT_EQUAL(37.0, dat);
+
+    // Errors are still reported on the cached range
+    TEST_ASSERT_EQUAL(-4, iauDat(2024, 1, 1, 1.5, &dat));
+    TEST_ASSERT_EQUAL(-3, iauDat(2024, 2, 30, 0.0, &dat));
+    TEST_ASSERT_EQUAL(-2, iauDat(2024, 13, 1, 0.0, &dat));
+
+    // Pre-1972 drift is never cached
+    TEST_ASSERT_EQUAL(0, iauDat(2003, 6, 1, 0.0, &dat));
+    TEST_ASSERT_EQUAL(32.0, dat);
+    TEST_ASSERT_EQUAL(0, iauDat(1962, 1, 1, 0.5, &dat));
+    TEST_ASSERT_DOUBLE_WITHIN(1e-6, 1.845858 + (37665.5 - 37665.0) * 0.0011232, dat);
+}
+
+void test_runtime_table()
+{
+    double dat;
+    TEST_ASSERT_EQUAL(0, iauDat(2028, 12, 1, 0.0, &dat));
+    TEST_ASSERT_EQUAL(37.0, dat);
+
+    TEST_ASSERT_EQUAL(-1, datAddLeapSecond(2016, 1, 38.0)); // Not after 2017-01
+    TEST_ASSERT_EQUAL(-2, datAddLeapSecond(2028, 13, 38.0));
+    TEST_ASSERT_EQUAL(0, datAddLeapSecond(2028, 7, 38.0));
+    TEST_ASSERT_EQUAL(1, datLeapSecondCount());
+
+    // The cache filled before the addition is dropped
+    TEST_ASSERT_EQUAL(0, iauDat(2028, 12, 1, 0.0, &dat));
+    TEST_ASSERT_EQUAL(38.0, dat);
+    TEST_ASSERT_EQUAL(0, iauDat(2028, 6, 1, 0.0, &dat));
+    TEST_ASSERT_EQUAL(37.0, dat);
+
+    // Beyond IYV + 5 until the validity is extended
+    TEST_ASSERT_EQUAL(1, iauDat(2030, 1, 1, 0.0, &dat));
+    TEST_ASSERT_EQUAL(38.0, dat);
+    datSetValidYear(2031);
+    TEST_ASSERT_EQUAL(0, iauDat(2030, 1, 1, 0.0, &dat));
+    TEST_ASSERT_EQUAL(38.0, dat);
+}
+
+void test_dat_benchmark()
+{
+    const int n = 200000;
+    double dat, hits = 0, misses = 0;
+
+    // Same range : cache hits
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < n; i++)
+    {
+        iauDat(2024, 1 + i % 12, 1 + i % 28, 0.5, &dat);
+        hits += dat;
+    }
+    auto hit = std::chrono::steady_clock::now();
+
+    // Alternating ranges : every call misses and takes the full path
+    for (int i = 0; i < n; i++)
+    {
+        iauDat((i & 1) ? 2024 : 2016, 1 + i % 12, 1 + i % 28, 0.5, &dat);
+        misses += dat;
+    }
+    auto miss = std::chrono::steady_clock::now();
+
+    double tHit = std::chrono::duration<double, std::nano>(hit - start).count() / n;
+    double tMiss = std::chrono::duration<double, std::nano>(miss - hit).count() / n;
+    printf("iauDat : cached %.1f ns, full path %.1f ns per call (checksum %.0f)\n", tHit, tMiss, hits + misses);
+
+    // Timings vary with the host load : only the values are checked
+    TEST_ASSERT_EQUAL_DOUBLE(37.0 * n, hits);
+    TEST_ASSERT_EQUAL_DOUBLE((37.0 + 36.0) * n / 2, misses);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_cached_values);
+    RUN_TEST(test_runtime_table);
+    RUN_TEST(test_dat_benchmark);
+    return UNITY_END();
+}
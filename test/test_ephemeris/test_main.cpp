@@ -0,0 +1,120 @@
+#include <unity.h>
+#include <stdio.h>
+#include <chrono>
+#include "Clock.cpp"
+#include "utils.cpp"
+#include "Ephemeris.cpp"
+
+// Solar system ephemerides : two-part Julian dates, interpolation error of
+// the coarse grid and cost of a cached vs direct evaluation
+
+volatile double sink; // Keeps the benchmark loops alive
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+void test_julian_date()
+{
+    // 2024-06-20 20:51 UTC
+    JulianDate utc = unixTimeToJD(1718916660);
+    TEST_ASSERT_EQUAL_DOUBLE(2460481.5, utc.day);
+    TEST_ASSERT_DOUBLE_WITHIN(1e-12, (20 * 3600 + 51 * 60) / SECONDS_IN_DAY, utc.fraction);
+    TEST_ASSERT_DOUBLE_WITHIN(1e-12, 8936.5 + utc.fraction, utc.daysSinceJ2000());
+
+    JulianDate tt;
+    TEST_ASSERT_TRUE(unixTimeToTT(1718916660, tt));
+    TEST_ASSERT_DOUBLE_WITHIN(1e-6, 69.184, ((tt.day - utc.day) + (tt.fraction - utc.fraction)) * SECONDS_IN_DAY);
+
+    // Microsecond steps : all distinct in two parts, merged in one double
+    int distinct = 0, merged = 0;
+    for (int i = 1; i <= 1000; i++)
+    {
+        double t0 = 1718916660 + (i - 1) * 1e-6, t1 = 1718916660 + i * 1e-6;
+        JulianDate a = unixTimeToJD(t0), b = unixTimeToJD(t1);
+        distinct += b.fraction > a.fraction;
+        merged += b.day + b.fraction > a.day + a.fraction;
+    }
+    printf("1 us steps resolved : %d / 1000 in two parts, %d / 1000 in one double\n", distinct, merged);
+    TEST_ASSERT_EQUAL(1000, distinct);
+
+    // Sidereal time over 1 ms follows the sidereal rate, to 0.01 mas
+    double step = localSiderealTime(1718916660.001) - localSiderealTime(1718916660);
+    TEST_ASSERT_DOUBLE_WITHIN(3e-9, SIDEREAL_RATE_DEG * 1e-3, step);
+}
+
+void test_sun_solstice()
+{
+    // 2024-06-20 20:51 UTC solstice : declination at its maximum (obliquity)
+    double p[3], ra, dec, distance;
+    TEST_ASSERT_TRUE(bodyPosition(Body::SUN, 1718916660, p));
+    positionToRaDec(p, ra, dec, distance);
+    TEST_ASSERT_TRUE(fabs(dec - 23.44) < 0.01);
+    TEST_ASSERT_TRUE(fabs(distance - 1.0162) < 1e-3);
+}
+
+void test_interpolation_error()
+{
+    // Worst body (the Moon) over a month, off-grid sampling
+    for (int b = (int)Body::SUN; b <= (int)Body::NEPTUNE; b++)
+    {
+        EphemerisCache cache((Body)b);
+        double maxError = 0;
+        for (double t = 1704063600; t < 1704063600 + 30 * 86400; t += 613)
+        {
+            double interpolated[3], direct[3];
+            TEST_ASSERT_TRUE(cache.position(t, interpolated));
+            TEST_ASSERT_TRUE(bodyPosition((Body)b, t, direct));
+            maxError = fmax(maxError, iauSepp(interpolated, direct));
+        }
+        printf("%s : max interpolation error %.3f mas\n", bodyToString((Body)b), maxError * DR2D * 3.6e6);
+        TEST_ASSERT_TRUE(maxError * DR2D < 0.1 / 3600);
+    }
+}
+
+void test_lunar_parallax()
+{
+    // Horizontal parallax of the Moon at mean distance is ~57 arcmin
+    double distance = 384400e3 / DAU;
+    TEST_ASSERT_TRUE(fabs(topocentricElevation(0, distance) + 0.951) < 1e-3);
+    TEST_ASSERT_TRUE(fabs(topocentricElevation(90, distance) - 90) < 1e-9);
+}
+
+void test_ephemeris_benchmark()
+{
+    const int n = 20000;
+    double p[3];
+    EphemerisCache cache(Body::MOON);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < n; i++)
+    {
+        bodyPosition(Body::MOON, 1704063600 + i * 0.1, p);
+        sink = p[0];
+    }
+    double direct = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / n;
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < n; i++)
+    {
+        cache.position(1704063600 + i * 0.1, p);
+        sink = p[0];
+    }
+    double cached = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / n;
+    printf("Moon : direct %.2f us, cached %.3f us\n", direct, cached);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_julian_date);
+    RUN_TEST(test_sun_solstice);
+    RUN_TEST(test_interpolation_error);
+    RUN_TEST(test_lunar_parallax);
+    RUN_TEST(test_ephemeris_benchmark);
+    return UNITY_END();
+}
@@ -0,0 +1,194 @@
+#include <unity.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "LogRing.cpp"
+
+// Lock-free output ring : record integrity and order under concurrent
+// producers, overflow accounting, and push cost
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+void test_wrap_and_split()
+{
+    alignas(4) static uint8_t buffer[64];
+    memset(buffer, 0, sizeof(buffer));
+    LogRing ring(buffer, sizeof(buffer));
+    uint8_t out[8];
+    char line[32];
+
+    // Odd lengths move the records across the wrap ; pops in small chunks
+    for (int i = 0; i < 50; i++)
+    {
+        int length = snprintf(line, sizeof(line), "message %d%s", i, i % 3 ? "" : "..");
+        TEST_ASSERT_TRUE(ring.push(line, length, true));
+        char received[32];
+        size_t n = 0, got;
+        while ((got = ring.pop(out, sizeof(out))) > 0)
+        {
+            memcpy(received + n, out, got);
+            n += got;
+            TEST_ASSERT_EQUAL(n == (size_t)length + 2, ring.atRecordStart()); // Split records
+        }
+        TEST_ASSERT_EQUAL((size_t)length + 2, n);
+        TEST_ASSERT_EQUAL(0, memcmp(received, line, length));
+        TEST_ASSERT_EQUAL(0, memcmp(received + length, "\r\n", 2));
+    }
+}
+
+void test_overflow()
+{
+    alignas(4) static uint8_t buffer[64];
+    memset(buffer, 0, sizeof(buffer));
+    LogRing ring(buffer, sizeof(buffer));
+
+    // 4-byte header + 12 bytes : 4 records fit
+    int accepted = 0;
+    for (int i = 0; i < 6; i++)
+    {
+        accepted += ring.push("0123456789ab", 12);
+    }
+    TEST_ASSERT_EQUAL(4, accepted);
+    LogRing::Stats stats = ring.getStats();
+    TEST_ASSERT_EQUAL(4, stats.written);
+    TEST_ASSERT_EQUAL(2, stats.dropped);
+    TEST_ASSERT_EQUAL(24, stats.droppedBytes);
+    TEST_ASSERT_EQUAL(64, stats.highWater);
+
+    uint8_t out[64];
+    TEST_ASSERT_EQUAL(48, ring.pop(out, sizeof(out)));
+    TEST_ASSERT_TRUE(ring.push("0123456789ab", 12)); // Space released
+    TEST_ASSERT_FALSE(ring.push((const char *)out, 61)); // Never fits
+}
+
+// Producers push numbered lines ; every received line must be intact and,
+// per producer, in increasing order (gaps are drops). Even producers retry
+// until accepted, so they must lose nothing.
+void test_concurrent_producers()
+{
+    const int producers = 4, perProducer = 50000;
+    alignas(4) static uint8_t buffer[4096];
+    memset(buffer, 0, sizeof(buffer));
+    LogRing ring(buffer, sizeof(buffer));
+    std::atomic<int> done(0);
+    std::atomic<unsigned long> attempts(0);
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; p++)
+    {
+        threads.emplace_back([&, p]()
+                             {
+                                 char line[48];
+                                 for (int i = 0; i < perProducer; i++)
+                                 {
+                                     int length = snprintf(line, sizeof(line), "{producer: %d, seq: %d}", p, i);
+                                     attempts++;
+                                     while (!ring.push(line, length, true) && p % 2 == 0)
+                                     {
+                                         attempts++;
+                                         std::this_thread::yield();
+                                     }
+                                 }
+                                 done++; });
+    }
+
+    int last[producers];
+    for (int p = 0; p < producers; p++)
+    {
+        last[p] = -1;
+    }
+    unsigned long received = 0;
+    bool valid = true;
+    char line[64];
+    size_t length = 0;
+    uint8_t chunk[256];
+    while (true)
+    {
+        bool finished = done == producers; // Read before the final drain
+        size_t n = ring.pop(chunk, sizeof(chunk));
+        for (size_t i = 0; i < n; i++)
+        {
+            if (chunk[i] != '\n')
+            {
+                valid = valid && length < sizeof(line) - 1;
+                line[length++ % sizeof(line)] = chunk[i];
+                continue;
+            }
+            line[length % sizeof(line)] = '\0';
+            length = 0;
+            int p, seq;
+            char end;
+            if (sscanf(line, "{producer: %d, seq: %d}%c", &p, &seq, &end) != 3 || end != '\r' ||
+                p < 0 || p >= producers || seq <= last[p])
+            {
+                valid = false;
+                continue;
+            }
+            last[p] = seq;
+            received++;
+        }
+        if (n == 0 && finished)
+        {
+            break;
+        }
+    }
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+
+    LogRing::Stats stats = ring.getStats();
+    printf("%lu received, %u dropped, high water %u bytes\n", received, stats.dropped, stats.highWater);
+    TEST_ASSERT_TRUE(valid);
+    TEST_ASSERT_EQUAL(received, stats.written);
+    TEST_ASSERT_EQUAL(attempts.load(), stats.written + stats.dropped);
+    TEST_ASSERT_EQUAL(perProducer - 1, last[0]);
+    TEST_ASSERT_EQUAL(perProducer - 1, last[2]);
+}
+
+void test_push_benchmark()
+{
+    alignas(4) static uint8_t buffer[4096];
+    memset(buffer, 0, sizeof(buffer));
+    LogRing ring(buffer, sizeof(buffer));
+    const char *line = "{type: \"POSITION\", status: \"success\", payload: \"{azimuth: 45.00, elevation: 45.00}\"}";
+    size_t length = strlen(line);
+    uint8_t chunk[256];
+
+    const int n = 1000000;
+    double pushTime = 0;
+    for (int i = 0; i < n; i += 32)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (int j = 0; j < 32; j++)
+        {
+            ring.push(line, length, true);
+        }
+        pushTime += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        while (ring.pop(chunk, sizeof(chunk)) > 0)
+        {
+        }
+    }
+    printf("push : %.1f ns per %zu-byte message\n", pushTime / n, length);
+    TEST_ASSERT_EQUAL(0, ring.getStats().dropped);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_wrap_and_split);
+    RUN_TEST(test_overflow);
+    RUN_TEST(test_concurrent_producers);
+    RUN_TEST(test_push_benchmark);
+    return UNITY_END();
+}
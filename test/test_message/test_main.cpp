@@ -0,0 +1,331 @@
+#include <unity.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <new>
+#include <string>
+#include "JsonWriter.cpp"
+#include "Protocol.cpp"
+#include "Topics.cpp"
+#include "Clock.cpp"
+#include "utils.cpp"
+#include "Message.cpp"
+#include "Log.h"
+
+// Strict JSON message formatter : output, escaping, truncation, fixed-point
+// numbers, topic filtering, and a benchmark of messages per second and heap bytes per message
+// against the former String concatenation
+
+static size_t heapBytes = 0; // Allocated since the last reset
+
+void *operator new(size_t size)
+{
+    heapBytes += size;
+    void *p = malloc(size);
+    if (p == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void *p) noexcept
+{
+    free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+    free(p);
+}
+
+// The logger is not under test : keeps the last line
+static char lastLine[MESSAGE_MAX + 2];
+
+bool logLine(const char *data, size_t length)
+{
+    memcpy(lastLine, data, length);
+    lastLine[length] = '\0';
+    return true;
+}
+
+bool logWrite(const uint8_t *data, size_t length)
+{
+    return true;
+}
+
+// Held until the test runs it, as the logger task would
+static LogComposer pendingComposer = nullptr;
+
+bool logComposed(LogComposer compose)
+{
+    if (pendingComposer != nullptr)
+    {
+        return false;
+    }
+    pendingComposer = compose;
+    return true;
+}
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+static std::string fixed(double value, unsigned decimals)
+{
+    char out[32];
+    formatFixed(out, value, decimals);
+    return out;
+}
+
+void test_fixed_point()
+{
+    TEST_ASSERT_EQUAL_STRING("45.00", fixed(45, 2).c_str());
+    TEST_ASSERT_EQUAL_STRING("-12.35", fixed(-12.345001, 2).c_str());
+    TEST_ASSERT_EQUAL_STRING("0.00", fixed(-0.004, 2).c_str()); // No "-0.00"
+    TEST_ASSERT_EQUAL_STRING("1", fixed(0.5, 0).c_str());
+    TEST_ASSERT_EQUAL_STRING("0.000001", fixed(0.000001, 6).c_str());
+    TEST_ASSERT_EQUAL_STRING("1700000000.123457", fixed(1700000000.1234567, 6).c_str());
+    TEST_ASSERT_EQUAL_STRING("1e+20", fixed(1e20, 2).c_str());
+
+    char buffer[64];
+    JsonWriter json(buffer, sizeof(buffer));
+    json.beginObject().key("a").number(NAN, 2).key("b").integer(-42).endObject();
+    TEST_ASSERT_EQUAL_STRING("{\"a\":null,\"b\":-42}", buffer);
+}
+
+void test_message_format()
+{
+    char buffer[MESSAGE_MAX];
+    Message ack(MsgType::ACKNOWLEDGEMENT, ErrorType::ERROR, "Unknown command : \"x\"\tbad\n", 1700000000.5);
+    ack.format(buffer, sizeof(buffer));
+    TEST_ASSERT_EQUAL_STRING("{\"type\":\"ACKNOWLEDGEMENT\",\"status\":\"error\",\"timestamp\":1700000000.500000,"
+                             "\"payload\":\"Unknown command : \\\"x\\\"\\tbad\\n\"}",
+                             buffer);
+
+    Message position(45.f, -1.234f, ErrorType::NONE, 12.25);
+    position.format(buffer, sizeof(buffer));
+    TEST_ASSERT_EQUAL_STRING("{\"type\":\"POSITION\",\"status\":\"success\",\"timestamp\":12.250000,"
+                             "\"payload\":{\"azimuth\":45.00,\"elevation\":-1.23}}",
+                             buffer);
+
+    Message time(MsgType::TIMESTAMP, ErrorType::NONE, nullptr, 3.5);
+    time.format(buffer, sizeof(buffer));
+    TEST_ASSERT_EQUAL_STRING("{\"type\":\"TIMESTAMP\",\"status\":\"success\",\"timestamp\":3.500000,\"payload\":3.500000}", buffer);
+
+    // The event time is the caller's, not the output time
+    print_position(1, 2, ErrorStatus(), 42);
+    TEST_ASSERT_TRUE(strstr(lastLine, "\"timestamp\":42.000000") != nullptr);
+}
+
+void test_truncation()
+{
+    char buffer[80];
+    std::string text(200, 'a');
+    text[70] = '"'; // Escapes are never cut in half
+    Message msg(MsgType::GENERIC, ErrorType::NONE, text.c_str(), 0);
+    size_t length = msg.format(buffer, sizeof(buffer));
+    TEST_ASSERT_TRUE(length > 0 && length < sizeof(buffer));
+    TEST_ASSERT_EQUAL(length, strlen(buffer));
+    TEST_ASSERT_EQUAL(0, strcmp(buffer + length - 2, "\"}"));
+    TEST_ASSERT_TRUE(buffer[length - 3] != '\\');
+
+    // UTF-8 sequences are never cut in half either
+    std::string accents;
+    for (int i = 0; i < 40; i++)
+    {
+        accents += "\xc3\xa9"; // é
+    }
+    Message utf8(MsgType::GENERIC, ErrorType::NONE, accents.c_str(), 0);
+    length = utf8.format(buffer, sizeof(buffer));
+    size_t start = strstr(buffer, "\"payload\":\"") - buffer + 11;
+    TEST_ASSERT_EQUAL(0, (length - 2 - start) % 2);
+}
+
+// Replies echo the request ID of the command being handled, and only them
+void test_request_id()
+{
+    char buffer[MESSAGE_MAX];
+    Message event(MsgType::EVENT, ErrorType::ERROR, "failed : preempted", 2.5, 42);
+    event.format(buffer, sizeof(buffer));
+    TEST_ASSERT_EQUAL_STRING("{\"type\":\"EVENT\",\"id\":42,\"status\":\"error\",\"timestamp\":2.500000,"
+                             "\"payload\":\"failed : preempted\"}",
+                             buffer);
+
+    setRequestId(7);
+    print_acknowledgement("pong");
+    TEST_ASSERT_TRUE(strstr(lastLine, "\"id\":7,") != nullptr);
+    print_info("Motion stopped.");
+    TEST_ASSERT_TRUE(strstr(lastLine, "\"id\"") == nullptr);
+    setRequestId(REQUEST_ID_NONE);
+    print_acknowledgement("pong");
+    TEST_ASSERT_TRUE(strstr(lastLine, "\"id\"") == nullptr);
+
+    print_event("completed", 9, ErrorType::NONE, 3);
+    TEST_ASSERT_EQUAL_STRING("{\"type\":\"EVENT\",\"id\":9,\"status\":\"success\",\"timestamp\":3.000000,"
+                             "\"payload\":\"completed\"}",
+                             lastLine);
+}
+
+static double stampedTime = 0;
+
+static void stamp(double time)
+{
+    stampedTime = time;
+}
+
+// The time is taken when the logger task composes the answer, not when it
+// is queued
+void test_stamped_acknowledgement()
+{
+    setRequestId(11);
+    TEST_ASSERT_TRUE(print_acknowledgement_stamped("Clock exchange 1.5 2.000000 ", stamp));
+    TEST_ASSERT_FALSE(print_acknowledgement_stamped("Clock exchange 1.6 2.000000 ", stamp)); // Pending
+    setRequestId(REQUEST_ID_NONE);
+    TEST_ASSERT_EQUAL_DOUBLE(0, stampedTime);
+
+    char line[LOG_TX_CHUNK + 1];
+    double before = getCurrentTime();
+    size_t length = pendingComposer(reinterpret_cast<uint8_t *>(line), LOG_TX_CHUNK);
+    pendingComposer = nullptr;
+    TEST_ASSERT_TRUE(stampedTime >= before && stampedTime <= getCurrentTime());
+    TEST_ASSERT_TRUE(length > 2);
+    TEST_ASSERT_EQUAL(0, memcmp(line + length - 2, "\r\n", 2));
+    line[length - 2] = '\0';
+
+    char expected[MESSAGE_MAX], time[32];
+    formatFixed(time, stampedTime, 6);
+    Message(MsgType::ACKNOWLEDGEMENT, ErrorType::NONE, (std::string("Clock exchange 1.5 2.000000 ") + time).c_str(),
+            stampedTime, 11)
+        .format(expected, sizeof(expected));
+    TEST_ASSERT_EQUAL_STRING(expected, line);
+
+    TEST_ASSERT_TRUE(print_acknowledgement_stamped("Clock exchange 1.6 2.000000 ", stamp)); // Sent, free again
+    pendingComposer = nullptr;
+}
+
+static int evaluations = 0;
+
+static String counted(const char *text)
+{
+    evaluations++;
+    return text;
+}
+
+// Log messages go out only on a subscribed topic at or above its level, and
+// are not even built otherwise
+void test_topics()
+{
+    lastLine[0] = '\0';
+    unsubscribe(Topic::TRACKING);
+    LOG_INFO(counted("Motion stopped."));
+    print_info("Motion stopped.");
+    TEST_ASSERT_EQUAL(0, evaluations);
+    TEST_ASSERT_EQUAL_STRING("", lastLine);
+
+    print_acknowledgement("pong"); // Acknowledgements always
+    TEST_ASSERT_TRUE(strstr(lastLine, "pong") != nullptr);
+
+    subscribe(Topic::TRACKING);
+    LOG_INFO(counted("Motion stopped."));
+    TEST_ASSERT_EQUAL(1, evaluations);
+    TEST_ASSERT_TRUE(strstr(lastLine, "Motion stopped.") != nullptr);
+
+    setTopicLevel(Topic::ERRORS, LOG_LEVEL_ERROR);
+    print_warning("Trajectory fit failed");
+    TEST_ASSERT_TRUE(strstr(lastLine, "Trajectory") == nullptr);
+    print_msg_filtered(ErrorStatus(ErrorType::WARNING, "Azimuth read failed"));
+    TEST_ASSERT_TRUE(strstr(lastLine, "Azimuth") == nullptr);
+    print_error("Motion command queue full.");
+    TEST_ASSERT_TRUE(strstr(lastLine, "queue full") != nullptr);
+    setTopicLevel(Topic::ERRORS, LOG_LEVEL_WARNING);
+
+    Topic topic;
+    TEST_ASSERT_TRUE(topicFromString("timing", topic));
+    TEST_ASSERT_EQUAL((int)Topic::TIMING, (int)topic);
+    TEST_ASSERT_FALSE(topicFromString("count", topic));
+    TEST_ASSERT_FALSE(isSubscribed(Topic::TIMING)); // Opt-in
+}
+
+// Former format : String concatenation with unquoted keys, the timestamp
+// formatted at output time
+static std::string legacyFormat(const char *type, const char *status, const std::string &payload, double time)
+{
+    char timestamp[32];
+    snprintf(timestamp, sizeof(timestamp), "%.6f", time);
+    return "{type: \"" + std::string(type) +
+           "\", status: \"" + status +
+           "\", payload: \"" + payload +
+           "\", timestamp: \"" + timestamp + "\"}";
+}
+
+void test_format_benchmark()
+{
+    const int n = 500000;
+    char buffer[MESSAGE_MAX];
+    size_t sink = 0;
+
+    heapBytes = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < n; i++)
+    {
+        if (i % 2)
+        {
+            sink += Message(45.f + i % 7, 30.f, ErrorType::NONE, 1700000000.0 + i * 1e-3).format(buffer, sizeof(buffer));
+        }
+        else
+        {
+            sink += Message(MsgType::ACKNOWLEDGEMENT, ErrorType::NONE, "Asking pointing task towards az = 123.4, el = 45.6",
+                            1700000000.0 + i * 1e-3)
+                        .format(buffer, sizeof(buffer));
+        }
+    }
+    double rate = n / std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double bytes = (double)heapBytes / n;
+
+    heapBytes = 0;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < n; i++)
+    {
+        if (i % 2)
+        {
+            char az[16], el[16];
+            snprintf(az, sizeof(az), "%.2f", 45.f + i % 7);
+            snprintf(el, sizeof(el), "%.2f", 30.f);
+            sink += legacyFormat("POSITION", "success", "{azimuth: " + std::string(az) + ", elevation: " + el + "}",
+                                 1700000000.0 + i * 1e-3)
+                        .size();
+        }
+        else
+        {
+            sink += legacyFormat("ACKNOWLEDGEMENT", "success", "Asking pointing task towards az = 123.4, el = 45.6",
+                                 1700000000.0 + i * 1e-3)
+                        .size();
+        }
+    }
+    double legacyRate = n / std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double legacyBytes = (double)heapBytes / n;
+
+    printf("JsonWriter : %.0f messages/s, %.1f heap bytes/message\n", rate, bytes);
+    printf("String concatenation : %.0f messages/s, %.1f heap bytes/message (%zu)\n", legacyRate, legacyBytes, sink % 2);
+    TEST_ASSERT_EQUAL_DOUBLE(0, bytes);
+    TEST_ASSERT_TRUE(rate > legacyRate);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_fixed_point);
+    RUN_TEST(test_message_format);
+    RUN_TEST(test_truncation);
+    RUN_TEST(test_topics);
+    RUN_TEST(test_request_id);
+    RUN_TEST(test_stamped_acknowledgement);
+    RUN_TEST(test_format_benchmark);
+    return UNITY_END();
+}
@@ -0,0 +1,247 @@
+#ifndef FREERTOS_HOST_H
+#define FREERTOS_HOST_H
+
+// Minimal FreeRTOS subset on std::thread for the native test build
+// (ArduinoFake has no RTOS) : tasks, direct-to-task notifications, queues,
+// mutexes and auto-reload timers, with ticks of 1 ms. Not included on the device, where the real
+// kernel is used.
+#ifndef INC_FREERTOS_H
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned UBaseType_t;
+typedef void *TaskHandle_t;
+typedef void *QueueHandle_t;
+typedef void *SemaphoreHandle_t;
+typedef void *TimerHandle_t;
+typedef void (*TaskFunction_t)(void *);
+typedef void (*TimerCallbackFunction_t)(TimerHandle_t);
+
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS 1
+#define pdFAIL 0
+#define portMAX_DELAY 0xffffffffUL
+#define portTICK_PERIOD_MS 1
+#define pdMS_TO_TICKS(x) ((TickType_t)(x))
+
+namespace host
+{
+    struct Task
+    {
+        std::mutex mutex;
+        std::condition_variable cv;
+        uint32_t notifications = 0;
+    };
+
+    struct Queue
+    {
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::deque<std::vector<uint8_t>> items;
+        UBaseType_t length, itemSize;
+    };
+
+    struct Timer
+    {
+        TickType_t period;
+        void *id;
+        TimerCallbackFunction_t callback;
+        std::atomic<bool> running{false};
+        std::thread thread;
+    };
+
+    inline Task *&currentTask()
+    {
+        thread_local Task *task = nullptr;
+        return task;
+    }
+
+    // Waits on cv until ready() or ticks elapsed
+    template <class Lock, class Predicate>
+    bool waitFor(std::condition_variable &cv, Lock &lock, TickType_t ticks, Predicate ready)
+    {
+        if (ticks == portMAX_DELAY)
+        {
+            cv.wait(lock, ready);
+            return true;
+        }
+        return cv.wait_for(lock, std::chrono::milliseconds(ticks), ready);
+    }
+}
+
+inline BaseType_t xTaskCreate(TaskFunction_t function, const char *, uint32_t, void *parameters,
+                              UBaseType_t, TaskHandle_t *handle)
+{
+    host::Task *task = new host::Task();
+    if (handle != nullptr)
+    {
+        *handle = task;
+    }
+    std::thread([=]()
+                {
+                    host::currentTask() = task;
+                    function(parameters); })
+        .detach();
+    return pdPASS;
+}
+
+inline void vTaskDelay(TickType_t ticks)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(ticks));
+}
+
+inline uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t ticks)
+{
+    host::Task *task = host::currentTask();
+    std::unique_lock<std::mutex> lock(task->mutex);
+    host::waitFor(task->cv, lock, ticks, [&]()
+                  { return task->notifications > 0; });
+    uint32_t value = task->notifications;
+    task->notifications = clear ? 0 : (value > 0 ? value - 1 : 0);
+    return value;
+}
+
+inline BaseType_t xTaskNotifyGive(TaskHandle_t handle)
+{
+    host::Task *task = static_cast<host::Task *>(handle);
+    {
+        std::lock_guard<std::mutex> lock(task->mutex);
+        task->notifications++;
+    }
+    task->cv.notify_one();
+    return pdPASS;
+}
+
+inline QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize)
+{
+    host::Queue *queue = new host::Queue();
+    queue->length = length;
+    queue->itemSize = itemSize;
+    return queue;
+}
+
+inline BaseType_t xQueueSend(QueueHandle_t handle, const void *item, TickType_t)
+{
+    host::Queue *queue = static_cast<host::Queue *>(handle);
+    {
+        std::lock_guard<std::mutex> lock(queue->mutex);
+        if (queue->items.size() >= queue->length)
+        {
+            return pdFALSE; // Only non-blocking sends are used
+        }
+        const uint8_t *bytes = static_cast<const uint8_t *>(item);
+        queue->items.emplace_back(bytes, bytes + queue->itemSize);
+    }
+    queue->cv.notify_one();
+    return pdTRUE;
+}
+
+inline BaseType_t xQueueReceive(QueueHandle_t handle, void *item, TickType_t ticks)
+{
+    host::Queue *queue = static_cast<host::Queue *>(handle);
+    std::unique_lock<std::mutex> lock(queue->mutex);
+    if (!host::waitFor(queue->cv, lock, ticks, [&]()
+                       { return !queue->items.empty(); }))
+    {
+        return pdFALSE;
+    }
+    memcpy(item, queue->items.front().data(), queue->itemSize);
+    queue->items.pop_front();
+    return pdTRUE;
+}
+
+inline UBaseType_t uxQueueMessagesWaiting(QueueHandle_t handle)
+{
+    host::Queue *queue = static_cast<host::Queue *>(handle);
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    return queue->items.size();
+}
+
+inline SemaphoreHandle_t xSemaphoreCreateMutex()
+{
+    return new std::timed_mutex();
+}
+
+inline BaseType_t xSemaphoreTake(SemaphoreHandle_t handle, TickType_t ticks)
+{
+    std::timed_mutex *mutex = static_cast<std::timed_mutex *>(handle);
+    if (ticks == portMAX_DELAY)
+    {
+        mutex->lock();
+        return pdTRUE;
+    }
+    return mutex->try_lock_for(std::chrono::milliseconds(ticks)) ? pdTRUE : pdFALSE;
+}
+
+inline BaseType_t xSemaphoreGive(SemaphoreHandle_t handle)
+{
+    static_cast<std::timed_mutex *>(handle)->unlock();
+    return pdTRUE;
+}
+
+inline TimerHandle_t xTimerCreate(const char *, TickType_t period, UBaseType_t, void *id,
+                                  TimerCallbackFunction_t callback)
+{
+    host::Timer *timer = new host::Timer();
+    timer->period = period;
+    timer->id = id;
+    timer->callback = callback;
+    return timer;
+}
+
+inline BaseType_t xTimerStart(TimerHandle_t handle, TickType_t)
+{
+    host::Timer *timer = static_cast<host::Timer *>(handle);
+    if (timer->running.exchange(true))
+    {
+        return pdPASS;
+    }
+    timer->thread = std::thread([=]()
+                                {
+                                    while (timer->running)
+                                    {
+                                        std::this_thread::sleep_for(std::chrono::milliseconds(timer->period));
+                                        if (timer->running)
+                                        {
+                                            timer->callback(timer);
+                                        }
+                                    } });
+    return pdPASS;
+}
+
+// Returns once the callback is no longer running
+inline BaseType_t xTimerStop(TimerHandle_t handle, TickType_t)
+{
+    host::Timer *timer = static_cast<host::Timer *>(handle);
+    timer->running = false;
+    if (timer->thread.joinable())
+    {
+        timer->thread.join();
+    }
+    return pdPASS;
+}
+
+inline BaseType_t xTimerDelete(TimerHandle_t handle, TickType_t ticks)
+{
+    xTimerStop(handle, ticks);
+    delete static_cast<host::Timer *>(handle);
+    return pdPASS;
+}
+
+inline void *pvTimerGetTimerID(TimerHandle_t handle)
+{
+    return static_cast<host::Timer *>(handle)->id;
+}
+#endif
+
+#endif
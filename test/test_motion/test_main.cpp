@@ -0,0 +1,237 @@
+#include <unity.h>
+#include <stdio.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <Arduino.h>
+#include "freertos_host.h"
+#include "motionTasks.cpp"
+
+// Motion executor : preemption of a running motion by a new command, stop
+// with a full queue, completion events, and worst-case stop latency
+// (submission -> preempted motion returned)
+
+void print_info(const String &info, const MsgType &type) {}
+void print_error(const String &error, const MsgType &type) {}
+bool isLogSubscribed(int level) { return true; }
+
+// Events as sent, from the executor task
+struct Event
+{
+    std::string event;
+    uint32_t requestId;
+};
+static std::mutex eventsMutex;
+static std::vector<Event> events;
+static uint32_t receivedId = REQUEST_ID_NONE; // Of the command being received
+
+void print_event(const char *event, uint32_t requestId, const ErrorType &status, double timestamp)
+{
+    std::lock_guard<std::mutex> lock(eventsMutex);
+    events.push_back({event, requestId});
+}
+uint32_t getRequestId() { return receivedId; }
+double getCurrentTime() { return 0; }
+
+static const auto hostStart = std::chrono::steady_clock::now();
+
+static unsigned long hostMicros()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - hostStart).count();
+}
+
+#ifdef ArduinoFake
+static void mockMicros()
+{
+    When(Method(ArduinoFake(), micros)).AlwaysDo(hostMicros);
+}
+#else
+unsigned long micros()
+{
+    return hostMicros();
+}
+static void mockMicros()
+{
+}
+#endif
+
+// Tracking-like motion : streams until preempted
+struct FakeTracker : public Tasker
+{
+    std::atomic<int> cycles{0};
+    virtual bool task()
+    {
+        while (!motionPreempted())
+        {
+            cycles++;
+            waitMotionEvent(pdMS_TO_TICKS(TRACK_UPDATE_INTERVAL));
+        }
+        return true;
+    }
+};
+
+// Motion slow to yield : keeps the queue filling up
+struct StuckTracker : public Tasker
+{
+    std::atomic<bool> release{false};
+    virtual bool task()
+    {
+        while (!release)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return true;
+    }
+};
+
+// Tracking that cannot start, e.g. no timer
+struct FailingTracker : public Tasker
+{
+    virtual bool task()
+    {
+        return false;
+    }
+};
+
+static bool waitForState(MotionState state, int timeoutMs)
+{
+    for (int i = 0; i < timeoutMs; i++)
+    {
+        if (getMotionState() == state)
+        {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return false;
+}
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+void test_preemption()
+{
+    TEST_ASSERT_TRUE(startPointTo(10, 20));
+    TEST_ASSERT_TRUE(waitForState(MOTION_POINTING, 100));
+    TEST_ASSERT_TRUE(startHoming());
+    TEST_ASSERT_TRUE(waitForState(MOTION_HOMING, 100));
+    TEST_ASSERT_TRUE(stopMotionTask());
+    TEST_ASSERT_TRUE(waitForState(MOTION_IDLE, 100));
+}
+
+void test_stop_queue_full()
+{
+    StuckTracker tracker;
+    TEST_ASSERT_TRUE(startTracking(&tracker));
+    TEST_ASSERT_TRUE(waitForState(MOTION_TRACKING, 100));
+    for (int i = 0; i < MOTION_QUEUE_LENGTH; i++)
+    {
+        TEST_ASSERT_TRUE(startPointTo(10, 20));
+    }
+    TEST_ASSERT_FALSE(startHoming()); // Full
+    TEST_ASSERT_TRUE(stopMotionTask());
+
+    tracker.release = true;
+    TEST_ASSERT_TRUE(waitForState(MOTION_IDLE, 100));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    TEST_ASSERT_EQUAL(MOTION_IDLE, getMotionState()); // The dropped point_to never ran
+}
+
+static std::vector<Event> takeEvents()
+{
+    std::lock_guard<std::mutex> lock(eventsMutex);
+    std::vector<Event> taken;
+    taken.swap(events);
+    return taken;
+}
+
+static void assertEvent(const Event &event, const char *expected, uint32_t id)
+{
+    TEST_ASSERT_EQUAL_STRING(expected, event.event.c_str());
+    TEST_ASSERT_EQUAL_UINT32(id, event.requestId);
+}
+
+void test_events()
+{
+    TEST_ASSERT_TRUE(waitForState(MOTION_IDLE, 100));
+    takeEvents();
+
+    // Preempted slew, then a track retargeted once and stopped
+    FakeTracker tracker;
+    receivedId = 1;
+    TEST_ASSERT_TRUE(startPointTo(10, 20));
+    TEST_ASSERT_TRUE(waitForState(MOTION_POINTING, 100));
+    receivedId = 2;
+    TEST_ASSERT_TRUE(startTracking(&tracker));
+    TEST_ASSERT_TRUE(waitForState(MOTION_TRACKING, 100));
+    receivedId = 3;
+    retargetTracking(); // As Tracker::start on a new target
+    receivedId = 4;
+    TEST_ASSERT_TRUE(stopMotionTask());
+    TEST_ASSERT_TRUE(waitForState(MOTION_IDLE, 100));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20)); // The stop itself
+
+    // A track that cannot run
+    FailingTracker failing;
+    receivedId = 5;
+    TEST_ASSERT_TRUE(startTracking(&failing));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    TEST_ASSERT_EQUAL(MOTION_IDLE, getMotionState());
+    receivedId = REQUEST_ID_NONE;
+
+    std::vector<Event> sent = takeEvents();
+    TEST_ASSERT_EQUAL(5, sent.size());
+    assertEvent(sent[0], "failed : preempted", 1);
+    assertEvent(sent[1], "completed", 2); // Superseded by the new target
+    assertEvent(sent[2], "completed", 3); // The track, ended by the stop
+    assertEvent(sent[3], "completed", 4);
+    assertEvent(sent[4], "failed", 5);
+}
+
+void test_stop_latency()
+{
+    FakeTracker tracker;
+    const int n = 50;
+    for (int i = 0; i < n; i++)
+    {
+        // Alternates a long mock slew and tracking, stopped at a random phase
+        if (i % 2 == 0)
+        {
+            startPointTo(10, 20);
+        }
+        else
+        {
+            startTracking(&tracker);
+        }
+        TEST_ASSERT_TRUE(waitForState(i % 2 == 0 ? MOTION_POINTING : MOTION_TRACKING, 100));
+        std::this_thread::sleep_for(std::chrono::microseconds(rand() % 20000));
+        stopMotionTask();
+        TEST_ASSERT_TRUE(waitForState(MOTION_IDLE, 100));
+    }
+
+    MotionLatency latency = getMotionLatency();
+    printf("Stop latency over %lu stops : max %.3f ms, last %.3f ms\n", latency.count, latency.max, latency.last);
+    // One polling period was up to 1000 ms
+    TEST_ASSERT_TRUE(latency.count >= n);
+    TEST_ASSERT_TRUE(latency.max < 10);
+}
+
+int main(int argc, char **argv)
+{
+    mockMicros();
+    startMotionExecutor();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_preemption);
+    RUN_TEST(test_stop_queue_full);
+    RUN_TEST(test_events);
+    RUN_TEST(test_stop_latency);
+    return UNITY_END();
+}
@@ -0,0 +1,198 @@
+#include <unity.h>
+#include <stdio.h>
+#include <chrono>
+#include "Precision.h"
+#include "Clock.cpp"
+#include "utils.cpp"
+#include "Astrometry.cpp"
+
+// Accuracy and cost of the precision policies against the full double path,
+// and of the double AstrometryContext against SOFA iauAtco13.
+// Run on both the native and the device environments : the ratio between
+// the two policies is what matters on the ESP32 single-precision FPU.
+
+constexpr double D2R = M_PI / 180.0;
+constexpr double R2AS = 180.0 / M_PI * 3600.0;
+constexpr double LAT = 46.5194444 * D2R;
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+// Max Az/El error in arcseconds over the sky above the horizon
+static void altAzError(double &azErr, double &elErr)
+{
+    azErr = 0;
+    elErr = 0;
+    for (double ha = -180; ha < 180; ha += 1.7)
+    {
+        for (double dec = -40; dec < 90; dec += 0.9)
+        {
+            double az1, el1, az2, el2;
+            hourAngleToAltAz<DoublePrecision>(ha * D2R, dec * D2R, sin(LAT), cos(LAT), az1, el1);
+            hourAngleToAltAz<SinglePrecision>(ha * D2R, dec * D2R, sin(LAT), cos(LAT), az2, el2);
+            if (el1 * 180 / M_PI < 1 || el1 * 180 / M_PI > 89)
+            {
+                continue; // Outside the mount range
+            }
+            azErr = fmax(azErr, fabs(remainder(az2 - az1, 2 * M_PI)) * R2AS);
+            elErr = fmax(elErr, fabs(el2 - el1) * R2AS);
+        }
+    }
+}
+
+static void galacticError(double &raErr, double &decErr)
+{
+    const double sdp = sin(27.12825 * D2R), cdp = cos(27.12825 * D2R);
+    raErr = 0;
+    decErr = 0;
+    for (double l = 0; l < 360; l += 1.3)
+    {
+        for (double b = -89; b < 90; b += 0.7)
+        {
+            double ra1, dec1, ra2, dec2;
+            galacticToEquatorial<DoublePrecision>(l * D2R, b * D2R, sdp, cdp, 192.85948 * D2R, 122.932 * D2R, ra1, dec1);
+            galacticToEquatorial<SinglePrecision>(l * D2R, b * D2R, sdp, cdp, 192.85948 * D2R, 122.932 * D2R, ra2, dec2);
+            // RA error projected on the sky
+            raErr = fmax(raErr, fabs(remainder(ra2 - ra1, 2 * M_PI)) * cos(dec1) * R2AS);
+            decErr = fmax(decErr, fabs(dec2 - dec1) * R2AS);
+        }
+    }
+}
+
+// Max Az/El error in arcseconds over the sky above the horizon, 2020-2035 :
+// SinglePrecision against DoublePrecision, and DoublePrecision (FULL tier)
+// against iauAtco13 with the same observatory, DUT1 and no refraction, on
+// the sky (az times cos el), right after a refresh and one interval later
+static void astrometryError(double &azErr, double &elErr, double &azSofa, double &elSofa)
+{
+    azErr = elErr = azSofa = elSofa = 0;
+    for (double t = 1577836800; t < 2051222400; t += 86400 * 91.3 + 3607)
+    {
+        AstrometryContext context(ASTROM_REFRESH_INTERVAL, AccuracyTier::FULL);
+        JulianDate utc = unixTimeToJD(t);
+        double late = t + ASTROM_REFRESH_INTERVAL;
+        JulianDate lateUtc = unixTimeToJD(late);
+        for (double ra = 0; ra < 360; ra += 7)
+        {
+            for (double dec = -40; dec < 89; dec += 3)
+            {
+                auto [az1, el1] = context.raDecToAltAz<DoublePrecision>(ra, dec, t);
+                auto [az2, el2] = context.raDecToAltAz<SinglePrecision>(ra, dec, t);
+                if (el1 < 1 || el1 > 89)
+                {
+                    continue; // Outside the mount range
+                }
+                // Just before the next refresh : slow terms at their oldest
+                auto [az3, el3] = context.raDecToAltAz<DoublePrecision>(ra, dec, late);
+                double aob, zob, hob, dob, rob, eo;
+                iauAtco13(ra * DD2R, dec * DD2R, 0, 0, 0, 0, utc.day, utc.fraction, DUT1,
+                          OBS_LON * DD2R, OBS_LAT * DD2R, OBS_HEIGHT, 0, 0, 0, 0, 0, 0,
+                          &aob, &zob, &hob, &dob, &rob, &eo);
+                azErr = fmax(azErr, fabs(remainder(az2 - az1, 360.0)) * 3600);
+                elErr = fmax(elErr, fabs(el2 - el1) * 3600);
+                azSofa = fmax(azSofa, fabs(remainder(az1 * D2R - aob, 2 * M_PI)) * cos(el1 * D2R) * R2AS);
+                elSofa = fmax(elSofa, fabs(el1 * D2R - (M_PI / 2 - zob)) * R2AS);
+                iauAtco13(ra * DD2R, dec * DD2R, 0, 0, 0, 0, lateUtc.day, lateUtc.fraction, DUT1,
+                          OBS_LON * DD2R, OBS_LAT * DD2R, OBS_HEIGHT, 0, 0, 0, 0, 0, 0,
+                          &aob, &zob, &hob, &dob, &rob, &eo);
+                azSofa = fmax(azSofa, fabs(remainder(az3 * D2R - aob, 2 * M_PI)) * cos(el3 * D2R) * R2AS);
+                elSofa = fmax(elSofa, fabs(el3 * D2R - (M_PI / 2 - zob)) * R2AS);
+            }
+        }
+    }
+}
+
+volatile double sink = 0; // Keeps the benchmark loops alive
+
+template <class Policy>
+static double benchAltAz(int n)
+{
+    const double sp = sin(LAT), cp = cos(LAT);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < n; i++)
+    {
+        double az, el;
+        hourAngleToAltAz<Policy>(i * 1e-3, 0.4 + i * 1e-6, sp, cp, az, el);
+        sink += az + el;
+    }
+    auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::micro>(stop - start).count() / n;
+}
+
+void test_single_precision_accuracy()
+{
+    double azErr, elErr, raErr, decErr;
+    altAzError(azErr, elErr);
+    galacticError(raErr, decErr);
+
+    printf("| transform            | error 1 (arcsec) | error 2 (arcsec) |\n");
+    printf("| hourAngleToAltAz     | az %13.3f | el %13.3f |\n", azErr, elErr);
+    printf("| galacticToEquatorial | ra %13.3f | dec %12.3f |\n", raErr, decErr);
+
+    // Far below MOTION_MIN (0.1 deg = 360 arcsec)
+    TEST_ASSERT_TRUE(azErr < 5.0);
+    TEST_ASSERT_TRUE(elErr < 5.0);
+    TEST_ASSERT_TRUE(raErr < 5.0);
+    TEST_ASSERT_TRUE(decErr < 5.0);
+}
+
+void test_astrometry_context_accuracy()
+{
+    double azErr, elErr, azSofa, elSofa;
+    astrometryError(azErr, elErr, azSofa, elSofa);
+
+    printf("| AstrometryContext    | error 1 (arcsec) | error 2 (arcsec) |\n");
+    printf("| single vs double     | az %13.3f | el %13.3f |\n", azErr, elErr);
+    printf("| double vs iauAtco13  | az %13.6f | el %13.6f |\n", azSofa, elSofa);
+
+    TEST_ASSERT_TRUE(azErr < 5.0);
+    TEST_ASSERT_TRUE(elErr < 5.0);
+    TEST_ASSERT_TRUE(azSofa < 0.002); // 2 mas
+    TEST_ASSERT_TRUE(elSofa < 0.002);
+}
+
+void test_hour_angle_rates()
+{
+    // Analytic rates against central differences, over the mount range
+    const double sp = sin(LAT), cp = cos(LAT), h = 1e-6;
+    for (double ha = -M_PI; ha < M_PI; ha += 0.1)
+    {
+        for (double dec = -0.5; dec < 1.5; dec += 0.1)
+        {
+            double az, el, az1, el1, az2, el2, azRate, elRate;
+            hourAngleToAltAz<DoublePrecision>(ha, dec, sp, cp, az, el);
+            if (el < 1 * M_PI / 180 || el > 89 * M_PI / 180)
+            {
+                continue;
+            }
+            hourAngleToAltAz<DoublePrecision>(ha + h, dec, sp, cp, az1, el1);
+            hourAngleToAltAz<DoublePrecision>(ha - h, dec, sp, cp, az2, el2);
+            altAzHourAngleRates(az, el, sp, cp, azRate, elRate);
+            TEST_ASSERT_TRUE(fabs(remainder(az1 - az2, 2 * M_PI) / (2 * h) - azRate) < 1e-5);
+            TEST_ASSERT_TRUE(fabs((el1 - el2) / (2 * h) - elRate) < 1e-5);
+        }
+    }
+}
+
+void test_precision_benchmark()
+{
+    const int n = 20000;
+    double tDouble = benchAltAz<DoublePrecision>(n);
+    double tSingle = benchAltAz<SinglePrecision>(n);
+    printf("hourAngleToAltAz : double %.3f us, single %.3f us per call\n", tDouble, tSingle);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_single_precision_accuracy);
+    RUN_TEST(test_astrometry_context_accuracy);
+    RUN_TEST(test_hour_angle_rates);
+    RUN_TEST(test_precision_benchmark);
+    return UNITY_END();
+}
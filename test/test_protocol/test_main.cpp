@@ -0,0 +1,186 @@
+#include <unity.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include "Protocol.cpp"
+#include "Topics.cpp"
+#include "JsonWriter.cpp"
+#include "Clock.cpp"
+#include "utils.cpp"
+#include "Message.cpp"
+
+// Binary link protocol : COBS framing and CRC, message encoding, and
+// position samples per second over the UART against the JSON text mode
+
+// The logger is not under test : keeps the last output
+static uint8_t lastOutput[1024];
+static size_t lastLength = 0;
+
+bool logLine(const char *data, size_t length)
+{
+    memcpy(lastOutput, data, length);
+    memcpy(lastOutput + length, "\r\n", 2);
+    lastLength = length + 2;
+    return true;
+}
+
+bool logWrite(const uint8_t *data, size_t length)
+{
+    memcpy(lastOutput, data, length);
+    lastLength = length;
+    return true;
+}
+
+// Composed at once, as by an idle logger task
+bool logComposed(LogComposer compose)
+{
+    lastLength = compose(lastOutput, LOG_TX_CHUNK);
+    return true;
+}
+
+void setUp(void)
+{
+    setProtocolMode(ProtocolMode::TEXT);
+}
+
+void tearDown(void)
+{
+}
+
+void test_crc()
+{
+    TEST_ASSERT_EQUAL(0x29b1, crc16((const uint8_t *)"123456789", 9)); // Check value of CRC-16/CCITT-FALSE
+}
+
+// Round trips of random payloads, with zero runs and blocks above 254 bytes
+void test_frame_round_trip()
+{
+    const size_t maxLength = 700;
+    static uint8_t buffer[frameOverhead(maxLength) + maxLength];
+    static uint8_t payload[maxLength];
+    srand(1);
+    for (int trial = 0; trial < 2000; trial++)
+    {
+        size_t length = rand() % (maxLength + 1);
+        int zeros = rand() % 4; // None, few, many, all
+        for (size_t i = 0; i < length; i++)
+        {
+            payload[i] = zeros == 0 ? 1 + rand() % 255 : zeros == 3 ? 0 : (rand() % (zeros == 1 ? 50 : 2)) ? 1 + rand() % 255 : 0;
+        }
+        memcpy(buffer + frameHeadroom(maxLength), payload, length);
+        size_t frameLength = encodeFrame(buffer, length, maxLength);
+
+        TEST_ASSERT_TRUE(frameLength <= length + frameOverhead(maxLength));
+        TEST_ASSERT_EQUAL(0, buffer[frameLength - 1]);
+        TEST_ASSERT_TRUE(memchr(buffer, 0, frameLength - 1) == nullptr);
+        TEST_ASSERT_EQUAL((int)length, decodeFrame(buffer, frameLength - 1));
+        TEST_ASSERT_EQUAL(0, memcmp(buffer, payload, length));
+    }
+}
+
+void test_corrupt_frame()
+{
+    uint8_t buffer[64];
+    const char *command = "\x10point_to 10 20";
+    size_t length = strlen(command);
+    int rejected = 0;
+    for (size_t i = 0; i < length + 3; i++)
+    {
+        memcpy(buffer + frameHeadroom(sizeof(buffer) - 8), command, length);
+        size_t frameLength = encodeFrame(buffer, length, sizeof(buffer) - 8);
+        buffer[i] ^= 0x24;
+        rejected += buffer[i] == 0 || decodeFrame(buffer, frameLength - 1) < 0;
+    }
+    TEST_ASSERT_EQUAL(length + 3, rejected);
+}
+
+static void ignoreStamp(double time)
+{
+}
+
+void test_binary_messages()
+{
+    setProtocolMode(ProtocolMode::BINARY);
+    print_position(123.25f, 45.5f, ErrorStatus(), 1700000000.25);
+    int length = decodeFrame(lastOutput, lastLength - 1);
+    TEST_ASSERT_EQUAL(17, length);
+    TEST_ASSERT_EQUAL((uint8_t)MsgType::POSITION, lastOutput[0] & 0xf);
+    TEST_ASSERT_EQUAL((uint8_t)ErrorType::NONE, lastOutput[0] >> 4);
+    double timestamp;
+    float az, el;
+    memcpy(&timestamp, lastOutput + 1, 8);
+    memcpy(&az, lastOutput + 9, 4);
+    memcpy(&el, lastOutput + 13, 4);
+    TEST_ASSERT_EQUAL_DOUBLE(1700000000.25, timestamp);
+    TEST_ASSERT_EQUAL_DOUBLE(123.25, az);
+    TEST_ASSERT_EQUAL_DOUBLE(45.5, el);
+
+    print_event("completed", 0xdeadbeef, ErrorType::NONE, 5);
+    length = decodeFrame(lastOutput, lastLength - 1);
+    TEST_ASSERT_EQUAL(13 + 9, length);
+    TEST_ASSERT_EQUAL((uint8_t)MsgType::EVENT | FRAME_FLAG_REQUEST_ID, lastOutput[0]);
+    uint32_t id;
+    memcpy(&id, lastOutput + 9, 4);
+    TEST_ASSERT_EQUAL_UINT32(0xdeadbeef, id);
+    TEST_ASSERT_EQUAL(0, memcmp(lastOutput + 13, "completed", 9));
+
+    print_acknowledgement_error("Error : corrupt");
+    length = decodeFrame(lastOutput, lastLength - 1);
+    TEST_ASSERT_EQUAL(9 + 15, length);
+    TEST_ASSERT_EQUAL((uint8_t)MsgType::ACKNOWLEDGEMENT, lastOutput[0] & 0xf);
+    TEST_ASSERT_EQUAL((uint8_t)ErrorType::ERROR, lastOutput[0] >> 4);
+    TEST_ASSERT_EQUAL(0, memcmp(lastOutput + 9, "Error : corrupt", 15));
+
+    // Stamped at transmission, framed by the logger task
+    setRequestId(3);
+    TEST_ASSERT_TRUE(print_acknowledgement_stamped("t3 ", ignoreStamp));
+    setRequestId(REQUEST_ID_NONE);
+    TEST_ASSERT_EQUAL(0, lastOutput[lastLength - 1]);
+    length = decodeFrame(lastOutput, lastLength - 1);
+    TEST_ASSERT_TRUE(length > 13 + 3);
+    TEST_ASSERT_EQUAL((uint8_t)MsgType::ACKNOWLEDGEMENT | FRAME_FLAG_REQUEST_ID, lastOutput[0]);
+    memcpy(&id, lastOutput + 9, 4);
+    TEST_ASSERT_EQUAL_UINT32(3, id);
+    TEST_ASSERT_EQUAL(0, memcmp(lastOutput + 13, "t3 ", 3));
+    setProtocolMode(ProtocolMode::TEXT);
+}
+
+// Position samples per second at SERIAL_BAUDRATE (10 bits per byte), and
+// encoding cost per sample, text against binary
+void test_position_throughput()
+{
+    const int n = 200000;
+    size_t bytes[2];
+    double cost[2];
+    for (int mode = 0; mode < 2; mode++)
+    {
+        setProtocolMode(mode ? ProtocolMode::BINARY : ProtocolMode::TEXT);
+        size_t total = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < n; i++)
+        {
+            print_position(100 + (i % 3600) * 0.1f, 45.f + (i % 90) * 0.01f, ErrorStatus(), 1700000000.0 + i * 0.01);
+            total += lastLength;
+        }
+        cost[mode] = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / n;
+        bytes[mode] = total / n;
+    }
+
+    double textRate = SERIAL_BAUDRATE / 10.0 / bytes[0];
+    double binaryRate = SERIAL_BAUDRATE / 10.0 / bytes[1];
+    printf("text : %zu bytes/sample, %.0f samples/s, %.0f ns to encode\n", bytes[0], textRate, cost[0]);
+    printf("binary : %zu bytes/sample, %.0f samples/s, %.0f ns to encode (x%.1f)\n", bytes[1], binaryRate, cost[1], binaryRate / textRate);
+    TEST_ASSERT_TRUE(binaryRate >= 5 * textRate);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_crc);
+    RUN_TEST(test_frame_round_trip);
+    RUN_TEST(test_corrupt_frame);
+    RUN_TEST(test_binary_messages);
+    RUN_TEST(test_position_throughput);
+    return UNITY_END();
+}
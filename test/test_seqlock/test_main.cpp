@@ -0,0 +1,95 @@
+#include <unity.h>
+#include <stdio.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "Seqlock.h"
+
+// Seqlock snapshots : readers on other threads never see a torn value while
+// the writer updates as fast as it can
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+// Every field derived from the same counter, as the target of the tracker
+struct Snapshot
+{
+    double az, el, azRate, elRate, time;
+    uint32_t count;
+};
+
+static Snapshot make(uint32_t n)
+{
+    return {n * 0.5, -(double)n, n * 2.0, n * 3.0, n + 1700000000.0, n};
+}
+
+static bool consistent(const Snapshot &s)
+{
+    const Snapshot expected = make(s.count);
+    return s.az == expected.az && s.el == expected.el && s.azRate == expected.azRate &&
+           s.elRate == expected.elRate && s.time == expected.time;
+}
+
+void test_initial_value()
+{
+    Seqlock<Snapshot> snapshot(make(7));
+    TEST_ASSERT_TRUE(consistent(snapshot.load()));
+    TEST_ASSERT_EQUAL(7, snapshot.load().count);
+    snapshot.store(make(8));
+    TEST_ASSERT_EQUAL(8, snapshot.load().count);
+}
+
+void test_no_torn_reads()
+{
+    const uint32_t writes = 2000000;
+    Seqlock<Snapshot> snapshot(make(0));
+    std::atomic<bool> done(false);
+    std::atomic<uint32_t> torn(0), backwards(0);
+    std::atomic<uint64_t> reads(0);
+
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 3; r++)
+    {
+        readers.emplace_back([&]()
+                             {
+            uint32_t last = 0;
+            uint64_t n = 0;
+            while (!done.load(std::memory_order_relaxed))
+            {
+                Snapshot s = snapshot.load();
+                torn += !consistent(s);
+                backwards += s.count < last;
+                last = s.count;
+                n++;
+            }
+            reads += n; });
+    }
+    for (uint32_t n = 1; n <= writes; n++)
+    {
+        snapshot.store(make(n));
+    }
+    done = true;
+    for (std::thread &reader : readers)
+    {
+        reader.join();
+    }
+
+    printf("%u writes, %llu reads, %u torn, %u backwards\n", writes, (unsigned long long)reads.load(), torn.load(),
+           backwards.load());
+    TEST_ASSERT_EQUAL(0, torn.load());
+    TEST_ASSERT_EQUAL(0, backwards.load());
+    TEST_ASSERT_EQUAL(writes, snapshot.load().count);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_initial_value);
+    RUN_TEST(test_no_torn_reads);
+    return UNITY_END();
+}
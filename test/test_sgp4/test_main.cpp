@@ -0,0 +1,258 @@
+#include <unity.h>
+#include <stdio.h>
+#include <chrono>
+#include "Clock.cpp"
+#include "utils.cpp"
+#include "Satellite.cpp"
+
+// SGP4 / SDP4 against the Vallado et al. (2006) and Spacetrack Report #3
+// reference vectors, deep-space resonances, and host propagation throughput
+
+static const char *LINE1 = "1 00005U 58002B   00179.78495062  .00000023  00000-0  28098-4 0  4753";
+static const char *LINE2 = "2 00005  34.2682 348.7242 1859667 331.7664  19.3264 10.82419157413667";
+
+// Deep space : 10.5 h orbit (no resonance), Molniya (12 h resonance),
+// geostationary (24 h resonance, near-zero inclination)
+static const char *DEEP1 = "1 11801U          80230.29629788  .01431103  00000-0  14311-1 0    13";
+static const char *DEEP2 = "2 11801  46.7916 230.4354 7318036  47.4722  10.4117  2.28537848    13";
+static const char *MOLNIYA1 = "1 08195U 75081A   06176.33215444  .00000099  00000-0  11873-3 0   813";
+static const char *MOLNIYA2 = "2 08195  64.1586 279.0717 6877146 264.7651  20.2257  2.00491383225656";
+static const char *GEO1 = "1 28626U 05008A   06176.46683397 -.00000205  00000-0  10000-3 0  2190";
+static const char *GEO2 = "2 28626   0.0019 286.9433 0000335  13.7918  55.6504  1.00270176  4891";
+
+volatile double sink; // Keeps the benchmark loop alive
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+static void assertVector(const double *expected, const double *actual, double tolerance)
+{
+    for (int i = 0; i < 3; i++)
+    {
+        TEST_ASSERT_TRUE(fabs(expected[i] - actual[i]) < tolerance);
+    }
+}
+
+void test_parse()
+{
+    TLE tle;
+    TEST_ASSERT_TRUE(parseTLE(LINE1, LINE2, tle, "VANGUARD 1"));
+    TEST_ASSERT_EQUAL(5, tle.satnum);
+    TEST_ASSERT_TRUE(fabs(tle.ecco - 0.1859667) < 1e-12);
+    TEST_ASSERT_TRUE(fabs(tle.bstar - 0.28098e-4) < 1e-15);
+    // 2000-06-27 18:50:19.733568 UTC
+    TEST_ASSERT_TRUE(fabs(tle.epoch - 962131819.733568) < 1e-3);
+
+    char corrupted[70];
+    strcpy(corrupted, LINE1);
+    corrupted[68] = '4'; // Checksum
+    TEST_ASSERT_FALSE(parseTLE(corrupted, LINE2, tle));
+    TEST_ASSERT_FALSE(parseTLE(LINE2, LINE1, tle));
+}
+
+void test_reference_vectors()
+{
+    TLE tle;
+    Sgp4 propagator;
+    parseTLE(LINE1, LINE2, tle);
+    TEST_ASSERT_TRUE(propagator.init(tle));
+
+    double r[3], v[3];
+    const double r0[3] = {7022.46529266, -1400.08296755, 0.03995155};
+    const double v0[3] = {1.893841015, 6.405893759, 4.534807250};
+    TEST_ASSERT_EQUAL(Sgp4::OK, propagator.propagate(0, r, v));
+    assertVector(r0, r, 1e-6);
+    assertVector(v0, v, 1e-9);
+
+    const double r360[3] = {-7154.03120202, -3783.17682504, -3536.19412294};
+    const double v360[3] = {4.741887409, -4.151817765, -2.093935425};
+    TEST_ASSERT_EQUAL(Sgp4::OK, propagator.propagate(360, r, v));
+    assertVector(r360, r, 1e-6);
+    assertVector(v360, v, 1e-9);
+}
+
+static void initDeep(const char *line1, const char *line2, Sgp4 &propagator)
+{
+    TLE tle;
+    TEST_ASSERT_TRUE(parseTLE(line1, line2, tle));
+    TEST_ASSERT_TRUE(propagator.init(tle));
+    TEST_ASSERT_TRUE(propagator.isDeepSpace());
+}
+
+void test_deep_space_vectors()
+{
+    Sgp4 propagator;
+    double r[3], v[3];
+
+    // Spacetrack Report #3 SDP4 test case, printed to 1 cm
+    initDeep(DEEP1, DEEP2, propagator);
+    const double r11801[3] = {7473.37102, 428.94748, 5828.74846};
+    TEST_ASSERT_EQUAL(Sgp4::OK, propagator.propagate(0, r, v));
+    assertVector(r11801, r, 1e-5);
+
+    // Vallado et al. (2006)
+    initDeep(MOLNIYA1, MOLNIYA2, propagator);
+    const double r08195[3] = {2349.89483350, -14785.93811562, 0.02119378};
+    TEST_ASSERT_EQUAL(Sgp4::OK, propagator.propagate(0, r, v));
+    assertVector(r08195, r, 1e-6);
+}
+
+// Semi-major axis (km) from the vis-viva equation
+static double semiMajorAxis(const double r[3], const double v[3])
+{
+    return 1.0 / (2.0 / sqrt(r[0] * r[0] + r[1] * r[1] + r[2] * r[2]) -
+                  (v[0] * v[0] + v[1] * v[1] + v[2] * v[2]) / EARTH_MU);
+}
+
+void test_deep_space_resonance()
+{
+    Sgp4 propagator;
+    double r[3], v[3], before[3], after[3];
+
+    // Geostationary : stays within 0.02 deg of its epoch Az/El for a day
+    initDeep(GEO1, GEO2, propagator);
+    double epoch = propagator.getTLE().epoch;
+    propagator.propagate(0, r, v);
+    auto [az0, el0] = temeToAltAz(r, epoch);
+    for (double t = 60; t <= 1440; t += 60)
+    {
+        TEST_ASSERT_EQUAL(Sgp4::OK, propagator.propagate(t, r, v));
+        auto [az, el] = temeToAltAz(r, epoch + t * 60);
+        TEST_ASSERT_TRUE(fabs(az - az0) < 0.02);
+        TEST_ASSERT_TRUE(fabs(el - el0) < 0.02);
+    }
+
+    // Molniya : continuous across the 720 min integration steps, both
+    // ways, and without a drift of its orbit over 10 days
+    initDeep(MOLNIYA1, MOLNIYA2, propagator);
+    propagator.propagate(0, r, v);
+    double a0 = semiMajorAxis(r, v);
+    for (double t = -1440; t <= 14400; t += 720)
+    {
+        if (t == 0)
+        {
+            continue;
+        }
+        TEST_ASSERT_EQUAL(Sgp4::OK, propagator.propagate(t - 1e-6, before, v));
+        TEST_ASSERT_EQUAL(Sgp4::OK, propagator.propagate(t + 1e-6, after, v));
+        for (int i = 0; i < 3; i++)
+        {
+            TEST_ASSERT_TRUE(fabs(after[i] - before[i]) < 1e-3); // 10 km/s for 0.12 ms
+        }
+        propagator.propagate(t, r, v);
+        TEST_ASSERT_TRUE(fabs(semiMajorAxis(r, v) - a0) < 1e-3 * a0);
+    }
+}
+
+void test_teme_to_altaz()
+{
+    // 500 km above the observatory along the local vertical, rotated to TEME
+    double t = 1704063600;
+    double up[3] = {cos(OBS_LAT * DD2R) * cos(OBS_LON * DD2R),
+                    cos(OBS_LAT * DD2R) * sin(OBS_LON * DD2R),
+                    sin(OBS_LAT * DD2R)};
+    double fixed[3], r[3];
+    iauGd2gc(WGS84, OBS_LON * DD2R, OBS_LAT * DD2R, OBS_HEIGHT, fixed);
+    for (int i = 0; i < 3; i++)
+    {
+        fixed[i] = fixed[i] * 1e-3 + 500 * up[i];
+    }
+    JulianDate jd = unixTimeToJD(t);
+    double theta = iauGmst82(jd.day, jd.fraction + DUT1 / SECONDS_IN_DAY);
+    r[0] = cos(theta) * fixed[0] - sin(theta) * fixed[1];
+    r[1] = sin(theta) * fixed[0] + cos(theta) * fixed[1];
+    r[2] = fixed[2];
+
+    auto [az, el] = temeToAltAz(r, t);
+    TEST_ASSERT_TRUE(fabs(el - 90) < 1e-6);
+}
+
+void test_altaz_rates()
+{
+    // Rates from the SGP4 velocity against central differences over a day
+    TLE tle;
+    Sgp4 propagator;
+    parseTLE(LINE1, LINE2, tle);
+    propagator.init(tle);
+
+    const double h = 0.01;
+    for (double t = tle.epoch; t < tle.epoch + 86400; t += 97)
+    {
+        double r[3], v[3], az, el, azRate, elRate;
+        propagator.propagateAt(t, r, v);
+        temeToAltAz(r, v, t, az, el, azRate, elRate);
+        if (el < EL_MIN || el > EL_MAX)
+        {
+            continue;
+        }
+        propagator.propagateAt(t + h, r, v);
+        auto [az1, el1] = temeToAltAz(r, t + h);
+        propagator.propagateAt(t - h, r, v);
+        auto [az2, el2] = temeToAltAz(r, t - h);
+        TEST_ASSERT_TRUE(fabs(remainder(az1 - az2, 360.0) / (2 * h) - azRate) < 1e-4);
+        TEST_ASSERT_TRUE(fabs((el1 - el2) / (2 * h) - elRate) < 1e-4);
+    }
+}
+
+void test_sgp4_benchmark()
+{
+    TLE tle;
+    Sgp4 propagator;
+    parseTLE(LINE1, LINE2, tle);
+    propagator.init(tle);
+
+    const int n = 200000;
+    double r[3], v[3];
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < n; i++)
+    {
+        propagator.propagate(i * 0.01, r, v);
+        sink = r[0];
+    }
+    auto stop = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(stop - start).count();
+    printf("SGP4 : %.0f propagations/s (%.2f us each)\n", n / seconds, seconds / n * 1e6);
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < n; i++)
+    {
+        double t = 1704063600 + i * 0.05;
+        propagator.propagateAt(t, r, v);
+        auto [az, el] = temeToAltAz(r, t);
+        sink = az + el;
+    }
+    stop = std::chrono::steady_clock::now();
+    seconds = std::chrono::duration<double>(stop - start).count();
+    printf("SGP4 + Az/El : %.0f updates/s (%.2f us each)\n", n / seconds, seconds / n * 1e6);
+
+    // One day after the epoch : two resonance integration steps
+    parseTLE(MOLNIYA1, MOLNIYA2, tle);
+    propagator.init(tle);
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < n; i++)
+    {
+        propagator.propagate(1440 + i * 0.01, r, v);
+        sink = r[0];
+    }
+    stop = std::chrono::steady_clock::now();
+    seconds = std::chrono::duration<double>(stop - start).count();
+    printf("SDP4 : %.0f propagations/s (%.2f us each)\n", n / seconds, seconds / n * 1e6);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_parse);
+    RUN_TEST(test_reference_vectors);
+    RUN_TEST(test_deep_space_vectors);
+    RUN_TEST(test_deep_space_resonance);
+    RUN_TEST(test_teme_to_altaz);
+    RUN_TEST(test_altaz_rates);
+    RUN_TEST(test_sgp4_benchmark);
+    return UNITY_END();
+}
@@ -0,0 +1,82 @@
+#include <unity.h>
+#include <stdio.h>
+#include "Telemetry.cpp"
+
+// Position stream : rate settings, delta suppression, keepalive, and the
+// samples sent during a slew followed by a long stationary period
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+void test_rate()
+{
+    PositionStream stream;
+    TEST_ASSERT_EQUAL(POSITION_BROADCAST_DELAY, stream.getPeriodMs());
+    TEST_ASSERT_TRUE(stream.setRate(50));
+    TEST_ASSERT_EQUAL(20, stream.getPeriodMs());
+    TEST_ASSERT_TRUE(stream.setRate(STREAM_MAX_RATE));
+    TEST_ASSERT_EQUAL(10, stream.getPeriodMs());
+    TEST_ASSERT_TRUE(stream.setRate(3));
+    TEST_ASSERT_EQUAL(333, stream.getPeriodMs());
+    TEST_ASSERT_FALSE(stream.setRate(STREAM_MAX_RATE + 1));
+    TEST_ASSERT_FALSE(stream.setRate(-1));
+    TEST_ASSERT_FALSE(stream.setRate(NAN));
+    TEST_ASSERT_EQUAL(333, stream.getPeriodMs()); // Unchanged
+    TEST_ASSERT_TRUE(stream.setRate(0));
+    TEST_ASSERT_EQUAL(POSITION_BROADCAST_DELAY, stream.getPeriodMs());
+    TEST_ASSERT_FALSE(stream.setDeadband(-0.1f));
+}
+
+void test_suppression()
+{
+    PositionStream stream;
+    stream.setDeadband(0.01f);
+    TEST_ASSERT_TRUE(stream.accept(10, 20, ErrorType::NONE, 0)); // First sample
+    TEST_ASSERT_FALSE(stream.accept(10.005f, 20, ErrorType::NONE, 10));
+    TEST_ASSERT_FALSE(stream.accept(10.009f, 19.995f, ErrorType::NONE, 20)); // Still within the band of the last sent
+    TEST_ASSERT_TRUE(stream.accept(10.02f, 20, ErrorType::NONE, 30));
+    TEST_ASSERT_TRUE(stream.accept(10.02f, 20.02f, ErrorType::NONE, 40));
+    TEST_ASSERT_TRUE(stream.accept(10.02f, 20.02f, ErrorType::WARNING, 50)); // Status change
+    TEST_ASSERT_FALSE(stream.accept(10.02f, 20.02f, ErrorType::WARNING, 50 + POSITION_BROADCAST_DELAY - 1));
+    TEST_ASSERT_TRUE(stream.accept(10.02f, 20.02f, ErrorType::WARNING, 50 + POSITION_BROADCAST_DELAY)); // Keepalive
+    TEST_ASSERT_EQUAL(5, stream.getSent());
+    TEST_ASSERT_EQUAL(3, stream.getSuppressed());
+
+    stream.setDeadband(0);
+    TEST_ASSERT_TRUE(stream.accept(10.02f, 20.02f, ErrorType::WARNING, 60)); // Every sample
+}
+
+// 100 Hz for one minute : a 10 s slew at 2 deg/s, then 50 s stationary with
+// encoder noise below the deadband
+void test_slew_then_stationary()
+{
+    PositionStream stream;
+    stream.setRate(100);
+    uint32_t period = stream.getPeriodMs();
+    int samples = 0, slewSent = 0;
+    for (uint32_t t = 0; t < 60000; t += period, samples++)
+    {
+        float az = t < 10000 ? 100 + 2e-3f * t : 120;
+        float noise = ((int)(t / period % 3) - 1) * 2e-4f;
+        bool sent = stream.accept(az + noise, 45 + noise, ErrorType::NONE, t);
+        slewSent += sent && t < 10000;
+    }
+    printf("%d samples, %u sent (%d while slewing), %u suppressed\n", samples, stream.getSent(), slewSent,
+           stream.getSuppressed());
+    TEST_ASSERT_EQUAL(1000, slewSent); // Every slew sample
+    TEST_ASSERT_TRUE(stream.getSent() <= 1000 + 1 + 50000 / POSITION_BROADCAST_DELAY);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_rate);
+    RUN_TEST(test_suppression);
+    RUN_TEST(test_slew_then_stationary);
+    return UNITY_END();
+}
@@ -0,0 +1,89 @@
+#include <unity.h>
+#include <stdio.h>
+#include <chrono>
+#include "Clock.cpp"
+#include "utils.cpp"
+#include "Astrometry.cpp"
+
+// Max error and cost per refresh of the astrometry accuracy tiers
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+// Max on-sky Az/El error of a tier against FULL, in degrees
+static double tierError(AccuracyTier tier)
+{
+    double maxError = 0;
+    // 2020-2035, every ~37 days at a drifting time of day
+    for (double t = 1577836800; t < 2051222400; t += 86400 * 37.3 + 3607)
+    {
+        AstrometryContext full(ASTROM_REFRESH_INTERVAL, AccuracyTier::FULL);
+        AstrometryContext tested(ASTROM_REFRESH_INTERVAL, tier);
+        for (double ra = 0; ra < 360; ra += 23)
+        {
+            for (double dec = -40; dec < 89; dec += 11)
+            {
+                auto [az1, el1] = full.raDecToAltAz(ra, dec, t);
+                auto [az2, el2] = tested.raDecToAltAz(ra, dec, t);
+                if (el1 < EL_MIN || el1 > EL_MAX)
+                {
+                    continue;
+                }
+                double dAz = remainder(az2 - az1, 360.0) * cos(el1 * DEG_TO_RAD);
+                maxError = fmax(maxError, sqrt(dAz * dAz + (el2 - el1) * (el2 - el1)));
+            }
+        }
+    }
+    return maxError;
+}
+
+static double refreshCost(AccuracyTier tier, int n)
+{
+    AstrometryContext context(ASTROM_REFRESH_INTERVAL, tier);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < n; i++)
+    {
+        context.refresh(1704063600 + i * ASTROM_REFRESH_INTERVAL);
+    }
+    auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::micro>(stop - start).count() / n;
+}
+
+void test_tier_errors()
+{
+    double truncated = tierError(AccuracyTier::TRUNCATED);
+    double low = tierError(AccuracyTier::LOW);
+    printf("max error : truncated %.4f arcsec, low %.2f arcsec\n", truncated * 3600, low * 3600);
+    TEST_ASSERT_TRUE(truncated <= tierMaxError(AccuracyTier::TRUNCATED));
+    TEST_ASSERT_TRUE(low <= tierMaxError(AccuracyTier::LOW));
+}
+
+void test_cheapest_tier()
+{
+    TEST_ASSERT_TRUE(cheapestTier(MOTION_MIN) == AccuracyTier::LOW);
+    TEST_ASSERT_TRUE(cheapestTier(1e-3) == AccuracyTier::TRUNCATED); // 3.6 arcsec
+    TEST_ASSERT_TRUE(cheapestTier(1e-7) == AccuracyTier::FULL);
+}
+
+void test_tier_benchmark()
+{
+    const int n = 500;
+    printf("refresh cost : full %.1f us, truncated %.1f us, low %.1f us\n",
+           refreshCost(AccuracyTier::FULL, n),
+           refreshCost(AccuracyTier::TRUNCATED, n),
+           refreshCost(AccuracyTier::LOW, n));
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_tier_errors);
+    RUN_TEST(test_cheapest_tier);
+    RUN_TEST(test_tier_benchmark);
+    return UNITY_END();
+}
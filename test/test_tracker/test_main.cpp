@@ -0,0 +1,216 @@
+#include <unity.h>
+#include <stdio.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <Arduino.h>
+#include "../test_motion/freertos_host.h"
+#include "Clock.cpp"
+#include "utils.cpp"
+#include "Astrometry.cpp"
+#include "Trajectory.cpp"
+#include "Satellite.cpp"
+#include "Ephemeris.cpp"
+#include "Log.cpp"
+#include "Tracker.cpp"
+
+// Tracker setpoints at the limits : a target leaving the valid range and
+// the end of an uploaded trajectory, run through the tracking task with the
+// motion primitives recorded
+
+void print_debug(const String &debug, const MsgType &type) {}
+void print_info(const String &info, const MsgType &type) {}
+void print_warning(const String &warning, const MsgType &type) {}
+void print_error(const String &error, const MsgType &type) {}
+bool isLogSubscribed(int level) { return true; }
+
+#ifdef ArduinoFake
+static void mockMillis()
+{
+    When(Method(ArduinoFake(), millis)).AlwaysReturn(0);
+}
+#else
+unsigned long millis()
+{
+    return 0;
+}
+static void mockMillis()
+{
+}
+#endif
+
+// Motion primitives as called by the tracking task
+static std::mutex motionMutex;
+static std::vector<MotionSetpoint> streamed;
+static std::atomic<bool> preempted(false);
+
+bool pointTo(float const &az, float const &el, bool *stop_flag)
+{
+    return true; // Standing on the target at once
+}
+
+bool streamSetpoint(MotionSetpoint const &setpoint)
+{
+    std::lock_guard<std::mutex> lock(motionMutex);
+    streamed.push_back(setpoint);
+    return true;
+}
+
+bool motionPreempted() { return preempted; }
+bool waitMotionEvent(TickType_t timeout)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(timeout));
+    return false;
+}
+void signalMotionEvent() {}
+MotionState getMotionState() { return MOTION_IDLE; }
+bool startTracking(Tasker *tracker) { return true; }
+void retargetTracking() {}
+
+static const double START = 1.7e9; // Device clock at the start of a test
+
+// Sets the device clock to time
+static void setTime(double time)
+{
+    deviceClock().set(time, clockMicros());
+}
+
+// Points every 0.1 s from start, from el0 at elRate
+static void uploadTrack(Tracker &tracker, double start, double duration, double el0, double elRate)
+{
+    tracker.clearTable();
+    TrackPoint points[64];
+    size_t count = (size_t)(duration / 0.1) + 1;
+    TEST_ASSERT_TRUE(count <= 64);
+    for (size_t i = 0; i < count; i++)
+    {
+        double t = i * 0.1;
+        points[i] = {start + t, 120.0f + 0.5f * (float)t, (float)(el0 + elRate * t)};
+    }
+    TEST_ASSERT_EQUAL(TableStatus::OK, tracker.addTablePoints(points, count));
+}
+
+static void assertInRange(const MotionSetpoint &setpoint)
+{
+    TEST_ASSERT_TRUE(setpoint.az >= AZ_MIN && setpoint.az <= AZ_MAX);
+    TEST_ASSERT_TRUE(setpoint.el >= EL_MIN && setpoint.el <= EL_MAX);
+}
+
+void setUp(void)
+{
+    preempted = false;
+    std::lock_guard<std::mutex> lock(motionMutex);
+    streamed.clear();
+}
+
+void tearDown(void)
+{
+    Tracker::getInstance().stop();
+}
+
+// Target going below EL_MIN at 2 deg/s, updated every tick : setpoints
+// stay in range, then stop once the last valid target is stale
+void test_setpoint_below_horizon()
+{
+    Tracker &tracker = Tracker::getInstance();
+    uploadTrack(tracker, START, 4, 3, -2);
+    tracker.setTrackingMode(TRACK_TABLE);
+
+    int valid = 0, stale = 0;
+    MotionSetpoint setpoint;
+    for (double t = START; t <= START + 4; t += TRACK_UPDATE_INTERVAL * 1e-3)
+    {
+        setTime(t);
+        tracker.updateTargetCoordinates();
+        // At the tick and up to the next one, and far past it
+        for (double dt = 0; dt <= 2 * TRACK_UPDATE_INTERVAL * 1e-3; dt += 0.01)
+        {
+            if (tracker.getSetpoint(t + dt, setpoint))
+            {
+                assertInRange(setpoint);
+                valid++;
+            }
+        }
+        TEST_ASSERT_FALSE(tracker.getSetpoint(t + 10, setpoint));
+        stale += !tracker.getSetpoint(t, setpoint);
+    }
+    TEST_ASSERT_TRUE(valid > 0);
+    TEST_ASSERT_TRUE(stale > 0);
+    TEST_ASSERT_FALSE(tracker.getSetpoint(START + 4, setpoint)); // Below the horizon
+}
+
+// Same descent through the tracking task, in real time : the mount holds
+// its last valid position, with zero rates
+void test_task_holds_below_horizon()
+{
+    Tracker &tracker = Tracker::getInstance();
+    setTime(START);
+    uploadTrack(tracker, START, 2, 1.6, -2); // EL_MIN after 0.3 s
+    tracker.start(TRACK_TABLE);
+
+    std::thread task([&]()
+                     { tracker.task(); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(800));
+    preempted = true;
+    task.join();
+
+    std::lock_guard<std::mutex> lock(motionMutex);
+    TEST_ASSERT_TRUE(streamed.size() >= 2);
+    for (const MotionSetpoint &setpoint : streamed)
+    {
+        assertInRange(setpoint);
+    }
+    // The hold, then nothing more until the stop repeats it
+    const MotionSetpoint &hold = streamed[streamed.size() - 2];
+    TEST_ASSERT_EQUAL_DOUBLE(0, hold.azRate);
+    TEST_ASSERT_EQUAL_DOUBLE(0, hold.elRate);
+    TEST_ASSERT_TRUE(hold.el < 1.6);
+    TEST_ASSERT_EQUAL_DOUBLE(hold.el, streamed.back().el);
+}
+
+// Track ending 0.5 s after the start : the task holds the last point and
+// fails, without a stop
+void test_table_end()
+{
+    Tracker &tracker = Tracker::getInstance();
+    setTime(START);
+    uploadTrack(tracker, START, 0.5, 30, 1);
+    tracker.start(TRACK_TABLE);
+
+    std::atomic<bool> done(false);
+    bool result = true;
+    std::thread task([&]()
+                     { result = tracker.task();
+                       done = true; });
+    for (int i = 0; i < 1000 && !done; i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    TEST_ASSERT_TRUE(done.load());
+    preempted = true; // Not to hang if still running
+    task.join();
+
+    TEST_ASSERT_FALSE(result);
+    MotionSetpoint setpoint;
+    TEST_ASSERT_FALSE(tracker.getSetpoint(getCurrentTime(), setpoint)); // Back to IDLE
+
+    std::lock_guard<std::mutex> lock(motionMutex);
+    TEST_ASSERT_TRUE(streamed.size() >= 2);
+    const MotionSetpoint &hold = streamed.back();
+    TEST_ASSERT_EQUAL_DOUBLE(0, hold.azRate);
+    TEST_ASSERT_EQUAL_DOUBLE(0, hold.elRate);
+    TEST_ASSERT_DOUBLE_WITHIN(0.1, 120.25, hold.az);
+    TEST_ASSERT_DOUBLE_WITHIN(0.1, 30.5, hold.el);
+}
+
+int main(int argc, char **argv)
+{
+    mockMillis();
+    UNITY_BEGIN();
+    RUN_TEST(test_setpoint_below_horizon);
+    RUN_TEST(test_task_holds_below_horizon);
+    RUN_TEST(test_table_end);
+    UNITY_END();
+}
@@ -0,0 +1,250 @@
+#include <unity.h>
+#include <stdio.h>
+#include <chrono>
+#include "Trajectory.cpp"
+
+// Chebyshev fit of a track, and uploaded trajectory table : ring behaviour,
+// Hermite interpolation of points and Chebyshev segments against a known
+// track, and sampling cost
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+// Smooth track crossing azimuth 0/360, over about an hour
+static void track(double t, double &az, double &el)
+{
+    az = fmod(350 + 0.004 * t + 2e-7 * t * t + 360, 360);
+    el = 40 + 10 * sin(t / 1200);
+}
+
+static void trackRates(double t, double &azRate, double &elRate)
+{
+    azRate = 0.004 + 4e-7 * t;
+    elRate = 10 * cos(t / 1200) / 1200;
+}
+
+static TrackPoint sampled(double t)
+{
+    double az, el;
+    track(t, az, el);
+    return {t, (float)az, (float)el};
+}
+
+// Fitted on the nodes : the error measured by the fit bounds the true one
+// between the nodes, azimuth wrapped across 0/360
+void test_fit()
+{
+    ChebyshevSegment segment;
+    TEST_ASSERT_TRUE(segment.fit(0, TRAJ_SEGMENT_DURATION, TRAJ_ORDER, track));
+    double maxError = 0;
+    for (double t = 0; t <= TRAJ_SEGMENT_DURATION; t += 0.7)
+    {
+        double az, el, trueAz, trueEl;
+        segment.evaluate(t, az, el);
+        track(t, trueAz, trueEl);
+        TEST_ASSERT_TRUE(az >= 0 && az < 360);
+        maxError = fmax(maxError, fmax(fabs(remainder(az - trueAz, 360.0)), fabs(el - trueEl)));
+    }
+    printf("fit over %.0f s : max error %.2e deg, %.2e deg measured by the fit\n", TRAJ_SEGMENT_DURATION, maxError,
+           segment.getMaxError());
+    TEST_ASSERT_TRUE(maxError < 1e-6);
+    TEST_ASSERT_TRUE(maxError <= 2 * segment.getMaxError() + 1e-12);
+
+    auto invalid = [](double t, double &az, double &el)
+    {
+        az = t < 100 ? 0 : NAN;
+        el = 0;
+    };
+    TEST_ASSERT_FALSE(segment.fit(0, 300, TRAJ_ORDER, invalid));
+    TEST_ASSERT_FALSE(segment.isValid());
+    TEST_ASSERT_FALSE(segment.fit(0, 300, TRAJ_MAX_ORDER + 1, track));
+}
+
+// Near-zenith pass : azimuth swinging 180 deg in about a minute. The
+// segment is shortened until within the error target.
+void test_fit_within()
+{
+    auto zenith = [](double t, double &az, double &el)
+    {
+        az = fmod(90 + atan((t - 200) / 30) * 180 / M_PI + 360, 360);
+        el = 89 - 0.5 * fabs(atan((t - 200) / 30));
+    };
+    ChebyshevSegment segment;
+    TEST_ASSERT_TRUE(segment.fit(150, TRAJ_SEGMENT_DURATION, TRAJ_ORDER, zenith));
+    double fullError = segment.getMaxError();
+    TEST_ASSERT_TRUE(segment.fitWithin(150, TRAJ_SEGMENT_DURATION, TRAJ_ORDER, TRAJ_MAX_ERROR, TRAJ_MAX_REFITS, zenith));
+    double duration = segment.getEnd() - segment.getStart();
+    printf("zenith pass : %.3f deg over %.0f s, %.4f deg over %.1f s\n", fullError, TRAJ_SEGMENT_DURATION,
+           segment.getMaxError(), duration);
+    TEST_ASSERT_TRUE(fullError > TRAJ_MAX_ERROR);
+    TEST_ASSERT_TRUE(duration < TRAJ_SEGMENT_DURATION);
+    TEST_ASSERT_TRUE(segment.getMaxError() <= TRAJ_MAX_ERROR);
+
+    // Smooth track : no refit
+    TEST_ASSERT_TRUE(segment.fitWithin(0, TRAJ_SEGMENT_DURATION, TRAJ_ORDER, TRAJ_MAX_ERROR, TRAJ_MAX_REFITS, track));
+    TEST_ASSERT_EQUAL_DOUBLE(TRAJ_SEGMENT_DURATION, segment.getEnd() - segment.getStart());
+}
+
+void test_ring()
+{
+    static TrajectoryTable table;
+    TrackPoint points[3] = {sampled(0), sampled(10), sampled(20)};
+    TEST_ASSERT_EQUAL((int)TableStatus::OK, (int)table.addPoints(points, 3));
+    TEST_ASSERT_EQUAL((int)TableStatus::NOT_IN_ORDER, (int)table.addPoints(points, 1));
+    TrackPoint nan = {30, NAN, 0};
+    TEST_ASSERT_EQUAL((int)TableStatus::INVALID, (int)table.addPoints(&nan, 1));
+
+    ChebyshevSegment segment;
+    double coeffs[2] = {1, 0};
+    TEST_ASSERT_TRUE(segment.set(0, 10, 1, coeffs, coeffs));
+    TEST_ASSERT_EQUAL((int)TableStatus::WRONG_KIND, (int)table.addSegment(segment));
+
+    // All or nothing when full
+    static TrackPoint many[TRAJ_TABLE_POINTS];
+    for (int i = 0; i < TRAJ_TABLE_POINTS; i++)
+    {
+        many[i] = sampled(30 + 10 * i);
+    }
+    TEST_ASSERT_EQUAL((int)TableStatus::FULL, (int)table.addPoints(many, TRAJ_TABLE_POINTS));
+    TEST_ASSERT_EQUAL(3, table.getInfo().count);
+    TEST_ASSERT_EQUAL((int)TableStatus::OK, (int)table.addPoints(many, TRAJ_TABLE_POINTS - 3));
+
+    // Sampling drops what is behind, making room ; the ring wraps
+    double az, el, azRate, elRate;
+    TEST_ASSERT_FALSE(table.sample(-1, az, el, azRate, elRate));
+    TEST_ASSERT_TRUE(table.sample(1005, az, el, azRate, elRate));
+    TrajectoryTable::Info info = table.getInfo();
+    TEST_ASSERT_EQUAL(TRAJ_TABLE_POINTS - 99, info.count); // One kept before the interval
+    TEST_ASSERT_EQUAL_DOUBLE(990, info.start);
+    TrackPoint next[99];
+    for (int i = 0; i < 99; i++)
+    {
+        next[i] = sampled(info.end + 10 * (i + 1));
+    }
+    TEST_ASSERT_EQUAL((int)TableStatus::OK, (int)table.addPoints(next, 99));
+    TEST_ASSERT_TRUE(table.sample(info.end + 500, az, el, azRate, elRate));
+    TEST_ASSERT_FALSE(table.sample(info.end + 10000, az, el, azRate, elRate)); // Past the end
+
+    table.clear();
+    TEST_ASSERT_EQUAL((int)TableStatus::OK, (int)table.addSegment(segment));
+    TEST_ASSERT_EQUAL((int)TrajectoryTable::SEGMENTS, (int)table.getInfo().kind);
+}
+
+// Position and rate errors of the interpolated points, every 60 s
+void test_points_interpolation()
+{
+    static TrajectoryTable table;
+    const double step = 60;
+    TrackPoint points[64];
+    for (int i = 0; i < 64; i++)
+    {
+        points[i] = sampled(i * step);
+    }
+    TEST_ASSERT_EQUAL((int)TableStatus::OK, (int)table.addPoints(points, 64));
+
+    double maxError = 0, maxRateError = 0;
+    for (double t = 0; t <= 63 * step; t += 0.7)
+    {
+        double az, el, azRate, elRate, trueAz, trueEl, trueAzRate, trueElRate;
+        TEST_ASSERT_TRUE(table.sample(t, az, el, azRate, elRate));
+        track(t, trueAz, trueEl);
+        trackRates(t, trueAzRate, trueElRate);
+        TEST_ASSERT_TRUE(az >= 0 && az < 360);
+        maxError = fmax(maxError, fmax(fabs(remainder(az - trueAz, 360.0)), fabs(el - trueEl)));
+        maxRateError = fmax(maxRateError, fmax(fabs(azRate - trueAzRate), fabs(elRate - trueElRate)));
+    }
+    printf("points every %.0f s : max error %.2e deg, max rate error %.2e deg/s\n", step, maxError, maxRateError);
+    TEST_ASSERT_TRUE(maxError < 5e-4);
+    TEST_ASSERT_TRUE(maxRateError < 5e-5);
+}
+
+// Segments computed by the host, uploaded by their coefficients
+void test_segments()
+{
+    static TrajectoryTable table;
+    for (int i = 0; i < 4; i++)
+    {
+        // Host side : the track on the Chebyshev nodes, azimuth unwrapped,
+        // then the discrete cosine transform
+        const int order = 9;
+        double az[order + 1], el[order + 1], azCoeffs[order + 1], elCoeffs[order + 1];
+        for (int k = 0; k <= order; k++)
+        {
+            track(i * 600 + 300 + 300 * cos(M_PI * (k + 0.5) / (order + 1)), az[k], el[k]);
+            az[k] = k > 0 ? az[k - 1] + remainder(az[k] - az[k - 1], 360.0) : az[k];
+        }
+        for (int j = 0; j <= order; j++)
+        {
+            double sumAz = 0, sumEl = 0;
+            for (int k = 0; k <= order; k++)
+            {
+                double c = cos(M_PI * j * (k + 0.5) / (order + 1));
+                sumAz += az[k] * c;
+                sumEl += el[k] * c;
+            }
+            azCoeffs[j] = 2 * sumAz / (order + 1);
+            elCoeffs[j] = 2 * sumEl / (order + 1);
+        }
+        ChebyshevSegment segment;
+        TEST_ASSERT_TRUE(segment.set(i * 600, (i + 1) * 600, order, azCoeffs, elCoeffs));
+        TEST_ASSERT_EQUAL((int)TableStatus::OK, (int)table.addSegment(segment));
+    }
+    ChebyshevSegment early;
+    double zero[2] = {0, 0};
+    early.set(0, 10, 1, zero, zero);
+    TEST_ASSERT_EQUAL((int)TableStatus::NOT_IN_ORDER, (int)table.addSegment(early));
+
+    double maxError = 0, maxRateError = 0;
+    for (double t = 0; t <= 2400; t += 0.9)
+    {
+        double az, el, azRate, elRate, trueAz, trueEl, trueAzRate, trueElRate;
+        TEST_ASSERT_TRUE(table.sample(t, az, el, azRate, elRate));
+        track(t, trueAz, trueEl);
+        trackRates(t, trueAzRate, trueElRate);
+        maxError = fmax(maxError, fmax(fabs(remainder(az - trueAz, 360.0)), fabs(el - trueEl)));
+        maxRateError = fmax(maxRateError, fmax(fabs(azRate - trueAzRate), fabs(elRate - trueElRate)));
+    }
+    printf("segments of 600 s : max error %.2e deg, max rate error %.2e deg/s\n", maxError, maxRateError);
+    TEST_ASSERT_TRUE(maxError < 1e-6);
+    TEST_ASSERT_TRUE(maxRateError < 1e-7);
+}
+
+void test_sample_cost()
+{
+    static TrajectoryTable table;
+    TrackPoint points[TRAJ_TABLE_POINTS];
+    for (int i = 0; i < TRAJ_TABLE_POINTS; i++)
+    {
+        points[i] = sampled(i * 10);
+    }
+    table.addPoints(points, TRAJ_TABLE_POINTS);
+
+    const int n = 1000000;
+    double sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < n; i++)
+    {
+        double az, el, azRate, elRate;
+        table.sample(i * (TRAJ_TABLE_POINTS - 1) * 10.0 / n, az, el, azRate, elRate);
+        sink += az;
+    }
+    double cost = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / n;
+    printf("sample : %.0f ns (%d)\n", cost, sink > 0);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_fit);
+    RUN_TEST(test_fit_within);
+    RUN_TEST(test_ring);
+    RUN_TEST(test_points_interpolation);
+    RUN_TEST(test_segments);
+    RUN_TEST(test_sample_cost);
+    return UNITY_END();
+}
@@ -0,0 +1,211 @@
+#include <unity.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+#include "Command.cpp"
+#include "Transport.cpp"
+
+// Line assembly, and command-to-ack latency of the event-driven receive loop
+// over a host pty, against the former 10 ms polling loop
+
+// Transport on a file descriptor (pty side), woken by poll()
+class FdTransport : public SerialTransport
+{
+public:
+    explicit FdTransport(int fd) : fd(fd) {}
+
+    size_t read(uint8_t *buffer, size_t size) override
+    {
+        ssize_t n = ::read(fd, buffer, size);
+        return n > 0 ? n : 0;
+    }
+
+    size_t write(const uint8_t *data, size_t size) override
+    {
+        ssize_t n = ::write(fd, data, size);
+        return n > 0 ? n : 0;
+    }
+
+    bool waitReadable(uint32_t timeoutMs) override
+    {
+        pollfd p = {fd, POLLIN, 0};
+        return poll(&p, 1, timeoutMs == TRANSPORT_WAIT_FOREVER ? -1 : (int)timeoutMs) > 0;
+    }
+
+private:
+    int fd;
+};
+
+// Replays fixed chunks, one per read
+class ScriptedTransport : public SerialTransport
+{
+public:
+    ScriptedTransport(const char *const *chunks, size_t count) : chunks(chunks), count(count), index(0) {}
+
+    size_t read(uint8_t *buffer, size_t size) override
+    {
+        if (index == count)
+        {
+            return 0;
+        }
+        size_t n = strlen(chunks[index]);
+        n = n < size ? n : size;
+        memcpy(buffer, chunks[index++], n);
+        return n;
+    }
+
+    size_t write(const uint8_t *, size_t size) override { return size; }
+    bool waitReadable(uint32_t) override { return index < count; }
+
+private:
+    const char *const *chunks;
+    size_t count, index;
+};
+
+static SerialTransport *replyTransport = nullptr;
+
+static void cmdPing(const CommandArgs &)
+{
+    replyTransport->write((const uint8_t *)"pong\n", 5);
+}
+
+static constexpr CommandSpec COMMANDS[] = {
+    {"ping", "", cmdPing, ""},
+};
+static const CommandDispatcher dispatcher(COMMANDS);
+
+static std::atomic<bool> running(false);
+
+// receiveTask loop, as on the device
+static void receiveLoop(SerialTransport *transport, bool polling)
+{
+    static char commandLine[256];
+    LineReader reader(commandLine, sizeof(commandLine));
+    while (running)
+    {
+        char *line;
+        LineReader::Status status;
+        while ((status = reader.next(*transport, line)) != LineReader::NONE)
+        {
+            const CommandSpec *spec;
+            if (status == LineReader::LINE)
+            {
+                dispatcher.dispatch(line, spec);
+            }
+        }
+        if (polling)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10)); // Former loop
+        }
+        else
+        {
+            transport->waitReadable(20); // Timeout only to notice the end of the test
+        }
+    }
+}
+
+static int openPty(int &slave)
+{
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    grantpt(master);
+    unlockpt(master);
+    slave = open(ptsname(master), O_RDWR | O_NOCTTY | O_NONBLOCK);
+
+    termios raw;
+    tcgetattr(slave, &raw);
+    cfmakeraw(&raw);
+    tcsetattr(slave, TCSANOW, &raw);
+    return master;
+}
+
+// Mean and max command-to-ack latency, in ms
+static void measureLatency(bool polling, int n, double &mean, double &max)
+{
+    int slave;
+    int master = openPty(slave);
+    FdTransport device(slave);
+    replyTransport = &device;
+    running = true;
+    std::thread receiver(receiveLoop, &device, polling);
+
+    mean = max = 0;
+    for (int i = 0; i < n; i++)
+    {
+        char reply[8];
+        auto start = std::chrono::steady_clock::now();
+        TEST_ASSERT_EQUAL(5, write(master, "ping\n", 5));
+        size_t got = 0;
+        while (got < 5)
+        {
+            ssize_t r = read(master, reply + got, sizeof(reply) - got);
+            TEST_ASSERT_TRUE(r > 0);
+            got += r;
+        }
+        double latency = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        TEST_ASSERT_EQUAL(0, memcmp(reply, "pong\n", 5));
+        mean += latency / n;
+        max = latency > max ? latency : max;
+
+        // Commands arrive at random times, not in step with the loop
+        std::this_thread::sleep_for(std::chrono::microseconds(rand() % 3000));
+    }
+
+    running = false;
+    receiver.join();
+    close(slave);
+    close(master);
+}
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+void test_line_reader()
+{
+    const char *chunks[] = {"pi", "ng\r\ntrack radec", " 1 2\nsto", "p\n", "0123456789", "0123456789\n", "ok\n"};
+    ScriptedTransport transport(chunks, sizeof(chunks) / sizeof(chunks[0]));
+    char buffer[16];
+    LineReader reader(buffer, sizeof(buffer));
+    char *line;
+
+    TEST_ASSERT_EQUAL(LineReader::LINE, reader.next(transport, line));
+    TEST_ASSERT_EQUAL_STRING("ping", line);
+    TEST_ASSERT_EQUAL(LineReader::LINE, reader.next(transport, line));
+    TEST_ASSERT_EQUAL_STRING("track radec 1 2", line);
+    TEST_ASSERT_EQUAL(LineReader::LINE, reader.next(transport, line));
+    TEST_ASSERT_EQUAL_STRING("stop", line);
+    TEST_ASSERT_EQUAL(LineReader::TOO_LONG, reader.next(transport, line));
+    TEST_ASSERT_EQUAL(LineReader::LINE, reader.next(transport, line));
+    TEST_ASSERT_EQUAL_STRING("ok", line);
+    TEST_ASSERT_EQUAL(LineReader::NONE, reader.next(transport, line));
+}
+
+void test_ack_latency()
+{
+    double mean, max, pollingMean, pollingMax;
+    measureLatency(false, 1000, mean, max);
+    measureLatency(true, 100, pollingMean, pollingMax);
+    printf("event-driven : mean %.3f ms, max %.3f ms\n", mean, max);
+    printf("10 ms polling : mean %.3f ms, max %.3f ms\n", pollingMean, pollingMax);
+    TEST_ASSERT_TRUE(mean < 1.0);
+    TEST_ASSERT_TRUE(mean < pollingMean);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_line_reader);
+    RUN_TEST(test_ack_latency);
+    return UNITY_END();
+}